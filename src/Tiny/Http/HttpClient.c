@@ -112,10 +112,25 @@ TinyRet HttpClient_Execute(HttpClient *thiz, HttpMessage *request, HttpMessage *
             break;
         }
 
-        ret = TcpClient_Connect(&thiz->client, HttpMessage_GetIp(request), HttpMessage_GetPort(request), timeout);
-        if (RET_FAILED(ret))
+        /**
+         * a connection still open to the same server is reused
+         */
+        if (TcpClient_GetStatus(&thiz->client) == TCP_CLIENT_CONNECTED)
         {
-            break;
+            if (TcpClient_GetServerPort(&thiz->client) != HttpMessage_GetPort(request)
+                || !STR_EQUAL(TcpClient_GetServerIp(&thiz->client), HttpMessage_GetIp(request)))
+            {
+                TcpClient_Disconnect(&thiz->client);
+            }
+        }
+
+        if (TcpClient_GetStatus(&thiz->client) != TCP_CLIENT_CONNECTED)
+        {
+            ret = TcpClient_Connect(&thiz->client, HttpMessage_GetIp(request), HttpMessage_GetPort(request), timeout);
+            if (RET_FAILED(ret))
+            {
+                break;
+            }
         }
 
         ret = HttpMessage_ToBytes(request, &bytes, &size);
@@ -830,6 +830,49 @@ TinyRet tiny_udp_multicast_open(int *fd, const char *group, uint16_t port, bool
 }
 #endif
 
+TinyRet tiny_udp_unicast_open_on(int *fd, const char *ip, uint16_t port, bool block)
+{
+    int ret = 0;
+    struct sockaddr_in addr;
+    struct in_addr ifaddr;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(ip);
+    addr.sin_port = htons(port);
+    ifaddr.s_addr = addr.sin_addr.s_addr;
+
+    *fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (*fd < 0)
+    {
+        LOG_E(TAG, "socket failed");
+        return TINY_RET_E_SOCKET_FD;
+    }
+
+    ret = bind(*fd, (struct sockaddr *)&addr, sizeof(addr));
+    if (ret < 0)
+    {
+        LOG_E(TAG, "bind %s failed", ip);
+        tiny_udp_unicast_close(*fd);
+        return TINY_RET_E_SOCKET_BIND;
+    }
+
+    ret = setsockopt(*fd, IPPROTO_IP, IP_MULTICAST_IF, (char *)&ifaddr, sizeof(ifaddr));
+    if (ret < 0)
+    {
+        LOG_E(TAG, "setsockopt IP_MULTICAST_IF %s failed", ip);
+        tiny_udp_unicast_close(*fd);
+        return TINY_RET_E_SOCKET_SETSOCKOPT;
+    }
+
+    if (!block)
+    {
+        return tiny_socket_set_nonblock(*fd);
+    }
+
+    return TINY_RET_OK;
+}
+
 TinyRet tiny_udp_unicast_close(int fd)
 {
 #ifdef _WIN32
@@ -62,6 +62,11 @@ int tiny_tcp_write(int fd, const char *buf, uint32_t len);
 TinyRet tiny_udp_unicast_open(int *fd, uint16_t port, bool block);
 TinyRet tiny_udp_unicast_close(int fd);
 
+/**
+ * bound to the address of one interface, multicast leaves through it too
+ */
+TinyRet tiny_udp_unicast_open_on(int *fd, const char *ip, uint16_t port, bool block);
+
 //TinyRet tiny_udp_multicast_open(int *fd, const char *group, uint16_t port, bool block);
 //TinyRet tiny_udp_multicast_close(int fd);
 
@@ -0,0 +1,49 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   tiny_str_hash.c
+*
+* @remark
+*		set tabstop=4
+*		set shiftwidth=4
+*		set expandtab
+*/
+
+#include "tiny_str_hash.h"
+
+#define FNV_OFFSET_BASIS    2166136261U
+#define FNV_PRIME           16777619U
+
+uint32_t str_hash(const char *s)
+{
+    uint32_t hash = FNV_OFFSET_BASIS;
+
+    RETURN_VAL_IF_FAIL(s, 0);
+
+    while (*s)
+    {
+        hash ^= (uint8_t)(*s++);
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+uint32_t str_hash_n(const char *s, uint32_t len)
+{
+    uint32_t hash = FNV_OFFSET_BASIS;
+    uint32_t i = 0;
+
+    RETURN_VAL_IF_FAIL(s, 0);
+
+    for (i = 0; i < len; ++i)
+    {
+        hash ^= (uint8_t)s[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
@@ -0,0 +1,32 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   tiny_str_hash.h
+*
+* @remark
+*		set tabstop=4
+*		set shiftwidth=4
+*		set expandtab
+*/
+
+#ifndef __STR_HASH_H__
+#define __STR_HASH_H__
+
+#include "tiny_base.h"
+
+TINY_BEGIN_DECLS
+
+
+/**
+ * FNV-1a, 32 bits
+ */
+uint32_t str_hash(const char *s);
+uint32_t str_hash_n(const char *s, uint32_t len);
+
+
+TINY_END_DECLS
+
+#endif /* __STR_HASH_H__ */
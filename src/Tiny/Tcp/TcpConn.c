@@ -160,19 +160,50 @@ TinyRet TcpConn_Disconnect(TcpConn *thiz)
 
     do
     {
-        if (thiz->status == TCP_CONN_DISCONNECT)
+        if (thiz->status == TCP_CONN_DISCONNECT || thiz->socket_fd < 0)
         {
             ret = TINY_RET_E_SOCKET_DISCONNECTED;
             break;
         }
 
         tiny_tcp_close(thiz->socket_fd);
+        thiz->socket_fd = -1;
     }
     while (0);
 
     return ret;
 }
 
+TcpConn * TcpConn_Detach(TcpConn *thiz)
+{
+    TcpConn *conn = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+
+    do
+    {
+        if (thiz->socket_fd < 0)
+        {
+            break;
+        }
+
+        conn = TcpConn_New();
+        if (conn == NULL)
+        {
+            break;
+        }
+
+        TcpConn_Initialize(conn, thiz->id, thiz->socket_fd, thiz->client_ip, thiz->client_port);
+        strncpy(conn->self_ip, thiz->self_ip, TINY_IP_LEN);
+        conn->recv_buf_size = thiz->recv_buf_size;
+
+        thiz->socket_fd = -1;
+    }
+    while (0);
+
+    return conn;
+}
+
 TcpConnStatus TcpConn_GetStatus(TcpConn *thiz)
 {
     RETURN_VAL_IF_FAIL(thiz, TCP_CONN_DISCONNECT);
@@ -226,7 +257,7 @@ TinyRet TcpConn_Send(TcpConn *thiz, const char *bytes, uint32_t size, uint32_t t
     {
         int sent = 0;
 
-        if (thiz->status != TCP_CONN_CONNECTED)
+        if (thiz->status != TCP_CONN_CONNECTED || thiz->socket_fd < 0)
         {
             ret = TINY_RET_E_SOCKET_DISCONNECTED;
             break;
@@ -247,7 +278,7 @@ TinyRet TcpConn_Recv(TcpConn *thiz, char **bytes, uint32_t *size, uint32_t timeo
 
     do
     {
-        if (thiz->status != TCP_CONN_CONNECTED)
+        if (thiz->status != TCP_CONN_CONNECTED || thiz->socket_fd < 0)
         {
             ret = TINY_RET_E_SOCKET_DISCONNECTED;
             break;
@@ -294,7 +325,7 @@ TinyRet TcpConn_StartRecv(TcpConn *thiz, TcpConnReceiveListener listener, void *
         char * buf = NULL;
         int size = 0;
 
-        if (thiz->status != TCP_CONN_CONNECTED)
+        if (thiz->status != TCP_CONN_CONNECTED || thiz->socket_fd < 0)
         {
             ret = TINY_RET_E_SOCKET_DISCONNECTED;
             break;
@@ -341,5 +372,5 @@ static void conn_loop(void *param)
     LOG_V(TAG, "conn_loop");
 
     thiz->listener(thiz, thiz->ctx);
-    tiny_tcp_close(thiz->socket_fd);
+    TcpConn_Disconnect(thiz);
 }
\ No newline at end of file
@@ -59,6 +59,13 @@ void TcpConn_SetBufferSize(TcpConn *thiz, uint32_t size);
 uint32_t TcpConn_GetBufferSize(TcpConn *thiz);
 
 TinyRet TcpConn_Disconnect(TcpConn *thiz);
+
+/**
+ * moves the socket into a new TcpConn, without a thread of its own, that
+ * the caller may answer on after the listener returned; thiz is left
+ * without a socket
+ */
+TcpConn * TcpConn_Detach(TcpConn *thiz);
 TcpConnStatus TcpConn_GetStatus(TcpConn *thiz);
 uint32_t TcpConn_GetConnectionId(TcpConn * thiz);
 
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2013-2015
+ *
+ * @author jxfengzi@gmail.com
+ * @date   2013-11-19
+ *
+ * @file   TinyRwLock.c
+ *
+ * @remark
+ *
+ */
+
+#include "TinyRwLock.h"
+#include "tiny_memory.h"
+#include "tiny_log.h"
+
+#define TAG     "TinyRwLock"
+
+TinyRwLock * TinyRwLock_New(void)
+{
+    TinyRwLock *thiz = NULL;
+
+    do
+    {
+        TinyRet ret = TINY_RET_OK;
+
+        thiz = (TinyRwLock *)tiny_malloc(sizeof(TinyRwLock));
+        if (thiz == NULL)
+        {
+            break;
+        }
+
+        ret = TinyRwLock_Construct(thiz);
+        if (RET_FAILED(ret))
+        {
+            TinyRwLock_Delete(thiz);
+            thiz = NULL;
+            break;
+        }
+    }
+    while (0);
+
+    return thiz;
+}
+
+TinyRet TinyRwLock_Construct(TinyRwLock *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    memset(thiz, 0, sizeof(TinyRwLock));
+
+#ifdef _WIN32
+    InitializeSRWLock(&thiz->lock);
+#else
+    if (pthread_rwlock_init(&thiz->lock, NULL) != 0)
+    {
+        LOG_E(TAG, "TinyRwLock_Construct: pthread_rwlock_init failed");
+        return TINY_RET_E_INTERNAL;
+    }
+#endif
+
+    return TINY_RET_OK;
+}
+
+TinyRet TinyRwLock_Dispose(TinyRwLock *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+#ifdef _WIN32
+    /* SRWLOCK has nothing to release */
+#else
+    pthread_rwlock_destroy(&thiz->lock);
+#endif
+
+    return TINY_RET_OK;
+}
+
+void TinyRwLock_Delete(TinyRwLock *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyRwLock_Dispose(thiz);
+    tiny_free(thiz);
+}
+
+bool TinyRwLock_ReadLock(TinyRwLock *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, false);
+
+#ifdef _WIN32
+    AcquireSRWLockShared(&thiz->lock);
+#else
+    if (pthread_rwlock_rdlock(&thiz->lock) != 0)
+    {
+        LOG_W(TAG, "TinyRwLock_ReadLock: pthread_rwlock_rdlock failed");
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+bool TinyRwLock_ReadUnlock(TinyRwLock *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, false);
+
+#ifdef _WIN32
+    ReleaseSRWLockShared(&thiz->lock);
+#else
+    if (pthread_rwlock_unlock(&thiz->lock) != 0)
+    {
+        LOG_W(TAG, "TinyRwLock_ReadUnlock: pthread_rwlock_unlock failed");
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+bool TinyRwLock_WriteLock(TinyRwLock *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, false);
+
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&thiz->lock);
+#else
+    if (pthread_rwlock_wrlock(&thiz->lock) != 0)
+    {
+        LOG_W(TAG, "TinyRwLock_WriteLock: pthread_rwlock_wrlock failed");
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+bool TinyRwLock_WriteUnlock(TinyRwLock *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, false);
+
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&thiz->lock);
+#else
+    if (pthread_rwlock_unlock(&thiz->lock) != 0)
+    {
+        LOG_W(TAG, "TinyRwLock_WriteUnlock: pthread_rwlock_unlock failed");
+        return false;
+    }
+#endif
+
+    return true;
+}
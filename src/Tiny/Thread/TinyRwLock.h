@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2013-2015
+ *
+ * @author jxfengzi@gmail.com
+ * @date   2013-11-19
+ *
+ * @file   TinyRwLock.h
+ *
+ * @remark
+ *    set tabstop=4
+ *    set shiftwidth=4
+ *    set expandtab
+ */
+
+#ifndef __TINY_RWLOCK_H__
+#define __TINY_RWLOCK_H__
+
+#ifdef _WIN32
+#else
+#include <pthread.h>
+#endif
+
+#include "tiny_base.h"
+
+TINY_BEGIN_DECLS
+
+#ifdef _WIN32
+    typedef SRWLOCK             ct_rwlock_t;
+#else /* Linux */
+    typedef pthread_rwlock_t    ct_rwlock_t;
+#endif /* _WIN32 */
+
+typedef struct _TinyRwLock
+{
+    ct_rwlock_t   lock;
+} TinyRwLock;
+
+TinyRwLock * TinyRwLock_New(void);
+TinyRet TinyRwLock_Construct(TinyRwLock *thiz);
+TinyRet TinyRwLock_Dispose(TinyRwLock *thiz);
+void TinyRwLock_Delete(TinyRwLock *thiz);
+
+bool TinyRwLock_ReadLock(TinyRwLock *thiz);
+bool TinyRwLock_ReadUnlock(TinyRwLock *thiz);
+bool TinyRwLock_WriteLock(TinyRwLock *thiz);
+bool TinyRwLock_WriteUnlock(TinyRwLock *thiz);
+
+
+TINY_END_DECLS
+
+#endif /* __TINY_RWLOCK_H__ */
@@ -0,0 +1,297 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   tiny_gzip.c
+*
+* @remark
+*		set tabstop=4
+*		set shiftwidth=4
+*		set expandtab
+*/
+
+#include "tiny_gzip.h"
+#include "tiny_memory.h"
+
+#define GZIP_HEADER_LEN     10
+#define GZIP_TRAILER_LEN    8
+
+#define WINDOW_SIZE         32768
+#define HASH_BITS           12
+#define HASH_SIZE           (1 << HASH_BITS)
+#define MIN_MATCH           3
+#define MAX_MATCH           258
+#define MAX_CHAIN           32
+
+typedef struct _BitWriter
+{
+    uint8_t   * out;
+    uint32_t    size;
+    uint32_t    pos;
+    uint32_t    bits;
+    uint32_t    count;
+    bool        overflow;
+} BitWriter;
+
+static const uint16_t length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+
+static const uint8_t length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+static const uint16_t dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+
+static const uint8_t dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+static void put_byte(BitWriter *w, uint8_t b)
+{
+    if (w->pos < w->size)
+    {
+        w->out[w->pos++] = b;
+    }
+    else
+    {
+        w->overflow = true;
+    }
+}
+
+static void put_bits(BitWriter *w, uint32_t value, uint32_t n)
+{
+    w->bits |= (value << w->count);
+    w->count += n;
+
+    while (w->count >= 8)
+    {
+        put_byte(w, (uint8_t)(w->bits & 0xFF));
+        w->bits >>= 8;
+        w->count -= 8;
+    }
+}
+
+static void flush_bits(BitWriter *w)
+{
+    if (w->count > 0)
+    {
+        put_byte(w, (uint8_t)(w->bits & 0xFF));
+    }
+
+    w->bits = 0;
+    w->count = 0;
+}
+
+/**
+ * Huffman codes are defined MSB first, the stream is LSB first.
+ */
+static void put_code(BitWriter *w, uint32_t code, uint32_t n)
+{
+    uint32_t reversed = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+
+    put_bits(w, reversed, n);
+}
+
+static void put_symbol(BitWriter *w, uint32_t symbol)
+{
+    if (symbol < 144)
+    {
+        put_code(w, 0x30 + symbol, 8);
+    }
+    else if (symbol < 256)
+    {
+        put_code(w, 0x190 + symbol - 144, 9);
+    }
+    else if (symbol < 280)
+    {
+        put_code(w, symbol - 256, 7);
+    }
+    else
+    {
+        put_code(w, 0xC0 + symbol - 280, 8);
+    }
+}
+
+static void put_match(BitWriter *w, uint32_t length, uint32_t distance)
+{
+    int i = 28;
+    int j = 29;
+
+    while (length_base[i] > length)
+    {
+        i--;
+    }
+
+    put_symbol(w, 257 + i);
+    put_bits(w, length - length_base[i], length_extra[i]);
+
+    while (dist_base[j] > distance)
+    {
+        j--;
+    }
+
+    put_code(w, j, 5);
+    put_bits(w, distance - dist_base[j], dist_extra[j]);
+}
+
+static uint32_t hash3(const uint8_t *p)
+{
+    return ((p[0] << 8) ^ (p[1] << 4) ^ p[2]) & (HASH_SIZE - 1);
+}
+
+static uint32_t crc32(const uint8_t *p, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    uint32_t i = 0;
+    int k = 0;
+
+    for (i = 0; i < len; i++)
+    {
+        crc ^= p[i];
+        for (k = 0; k < 8; k++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+
+    return ~crc;
+}
+
+static void put_le32(BitWriter *w, uint32_t value)
+{
+    put_byte(w, (uint8_t)(value & 0xFF));
+    put_byte(w, (uint8_t)((value >> 8) & 0xFF));
+    put_byte(w, (uint8_t)((value >> 16) & 0xFF));
+    put_byte(w, (uint8_t)((value >> 24) & 0xFF));
+}
+
+uint32_t tiny_gzip_bound(uint32_t len)
+{
+    /**
+     * worst case: every byte a 9-bit literal
+     */
+    return GZIP_HEADER_LEN + (len * 9 + 7) / 8 + 8 + GZIP_TRAILER_LEN;
+}
+
+uint32_t tiny_gzip_compress(const char *src, uint32_t len, char *dst, uint32_t size)
+{
+    const uint8_t *in = (const uint8_t *)src;
+    int32_t *head = NULL;
+    int32_t *prev = NULL;
+    BitWriter w;
+    uint32_t pos = 0;
+    uint32_t i = 0;
+
+    RETURN_VAL_IF_FAIL(src, 0);
+    RETURN_VAL_IF_FAIL(dst, 0);
+
+    head = (int32_t *)tiny_malloc(sizeof(int32_t) * (HASH_SIZE + WINDOW_SIZE));
+    if (head == NULL)
+    {
+        return 0;
+    }
+
+    prev = head + HASH_SIZE;
+
+    for (i = 0; i < HASH_SIZE; i++)
+    {
+        head[i] = -1;
+    }
+
+    memset(&w, 0, sizeof(BitWriter));
+    w.out = (uint8_t *)dst;
+    w.size = size;
+
+    /**
+     * header: magic, deflate, no flags, no mtime, unknown OS
+     */
+    put_byte(&w, 0x1F);
+    put_byte(&w, 0x8B);
+    put_byte(&w, 0x08);
+    put_byte(&w, 0x00);
+    put_le32(&w, 0);
+    put_byte(&w, 0x00);
+    put_byte(&w, 0xFF);
+
+    /**
+     * one final block, fixed Huffman
+     */
+    put_bits(&w, 1, 1);
+    put_bits(&w, 1, 2);
+
+    while (pos < len && !w.overflow)
+    {
+        uint32_t best_length = 0;
+        uint32_t best_distance = 0;
+
+        if (pos + MIN_MATCH <= len)
+        {
+            uint32_t h = hash3(in + pos);
+            int32_t candidate = head[h];
+            uint32_t chain = MAX_CHAIN;
+            uint32_t max = (len - pos < MAX_MATCH) ? (len - pos) : MAX_MATCH;
+
+            while (candidate >= 0 && pos - candidate <= WINDOW_SIZE && chain-- > 0)
+            {
+                uint32_t n = 0;
+                while (n < max && in[candidate + n] == in[pos + n])
+                {
+                    n++;
+                }
+
+                if (n > best_length)
+                {
+                    best_length = n;
+                    best_distance = pos - candidate;
+                    if (n == max)
+                    {
+                        break;
+                    }
+                }
+
+                candidate = prev[candidate & (WINDOW_SIZE - 1)];
+            }
+        }
+
+        if (best_length < MIN_MATCH)
+        {
+            best_length = 1;
+            put_symbol(&w, in[pos]);
+        }
+        else
+        {
+            put_match(&w, best_length, best_distance);
+        }
+
+        for (i = 0; i < best_length; i++, pos++)
+        {
+            if (pos + MIN_MATCH <= len)
+            {
+                uint32_t h = hash3(in + pos);
+                prev[pos & (WINDOW_SIZE - 1)] = head[h];
+                head[h] = (int32_t)pos;
+            }
+        }
+    }
+
+    put_symbol(&w, 256);
+    flush_bits(&w);
+
+    put_le32(&w, crc32(in, len));
+    put_le32(&w, len);
+
+    tiny_free(head);
+
+    return w.overflow ? 0 : w.pos;
+}
@@ -0,0 +1,33 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   tiny_gzip.h
+*
+* @remark
+*		set tabstop=4
+*		set shiftwidth=4
+*		set expandtab
+*/
+
+#ifndef __TINY_GZIP_H__
+#define __TINY_GZIP_H__
+
+#include "tiny_base.h"
+
+TINY_BEGIN_DECLS
+
+
+/**
+ * gzip (RFC 1952) writer: LZ77 + fixed Huffman deflate (RFC 1951).
+ * Good enough for repetitive text like XML, no external dependency.
+ */
+uint32_t tiny_gzip_bound(uint32_t len);
+uint32_t tiny_gzip_compress(const char *src, uint32_t len, char *dst, uint32_t size);
+
+
+TINY_END_DECLS
+
+#endif /* __TINY_GZIP_H__ */
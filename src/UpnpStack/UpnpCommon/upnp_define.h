@@ -28,6 +28,19 @@ TINY_BEGIN_DECLS
 #define UPNP_TIMEOUT                            (1000 * 20)
 #define UPNP_SOAP_LEN                           (1024 * 20)
 #define UPNP_STACK_INFO                         "UPnP/1.0 UpnpLan/1.0"
+#define UPNP_ACTION_WORKERS                     4
+#define UPNP_ACTION_SERVICE_LIMIT               1
+#define UPNP_ACTION_TIMEOUT                     UPNP_TIMEOUT
+#define UPNP_EVENT_WORKERS                      16
+#define UPNP_EVENT_QUEUE_DEPTH                  4
+#define UPNP_EVENT_BACKOFF                      (1000 * 5)
+#define UPNP_EVENT_BACKOFF_MAX                  (1000 * 60)
+#define UPNP_EVENT_TIMEOUT                      (1000 * 3)
+#define UPNP_EVENT_RETRY_WORKERS                2
+#define UPNP_EVENT_FAILURES_MAX                 5
+#define UPNP_EVENT_KEEPALIVE                    (1000 * 30)
+#define UPNP_EVENT_IDLE_MAX                     32
+#define UPNP_SUBSCRIPTION_TIMEOUT               1800
 #define UPNP_STACK_INFO_LEN                     128
 #define UPNP_URI_LEN                            128
 #define UPNP_USN_LEN                            128
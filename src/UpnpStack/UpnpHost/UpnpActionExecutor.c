@@ -17,26 +17,283 @@
 #include "tiny_memory.h"
 #include "tiny_log.h"
 #include "tiny_str_split.h"
+#include "tiny_time.h"
 #include "message/soap/SoapMessage.h"
 #include "message/ActionRequest.h"
+#include "message/ActionResponse.h"
 
 #define TAG     "UpnpActionExecutor"
 
+#define ACTION_TIMER_INTERVAL   (1000 * 1000)
+#define ACTION_EXPIRE_MAX       16
+
+typedef struct _UpnpActionRequest
+{
+    UpnpActionJob               job;
+    UpnpAction                * action;
+    UpnpActionHandlerContext  * context;
+    const char                * content;
+    uint32_t                    contentLength;
+    int                         errorCode;
+    const char                * errorStatus;
+    PropertyList              * arguments;
+    UpnpActionToken           * token;
+    HttpMessage                 response;
+} UpnpActionRequest;
+
+/**
+ * the arguments live in the token: no state variable is touched, so
+ * nothing here needs the service lock
+ */
+static void DoDeferredAction(UpnpActionRequest *request)
+{
+    if (RET_FAILED(ActionArgumentsFromRequest(request->action, UpnpActionToken_GetArguments(request->token), request->content, request->contentLength)))
+    {
+        request->errorCode = 404;
+        request->errorStatus = "NOT FOUND";
+        return;
+    }
+
+    UpnpActionToken_Retain(request->token);
+    request->context->asyncHandler(request->action, request->token, request->context->ctx);
+}
+
+/**
+ * runs on the pool. The request is decoded into the job's own list first;
+ * only storing it, the handler and the encode touch the service's state
+ * variables, and only they hold the service lock.
+ */
+static void DoAction(UpnpActionJob *job, void *ctx)
+{
+    UpnpActionRequest *request = (UpnpActionRequest *)ctx;
+
+    if (request->token != NULL)
+    {
+        DoDeferredAction(request);
+        return;
+    }
+
+    if (RET_FAILED(ActionArgumentsFromRequest(request->action, request->arguments, request->content, request->contentLength)))
+    {
+        request->errorCode = 404;
+        request->errorStatus = "NOT FOUND";
+        return;
+    }
+
+    UpnpService_Lock(job->service);
+
+    do
+    {
+        UpnpCode code = UPNP_SUCCESS;
+
+        if (RET_FAILED(ActionFromArguments(request->action, request->arguments)))
+        {
+            request->errorCode = 404;
+            request->errorStatus = "NOT FOUND";
+            break;
+        }
+
+        code = request->context->handler(request->action, request->context->ctx);
+        if (code != UPNP_SUCCESS)
+        {
+            request->errorCode = code;
+            request->errorStatus = "ACTION Execute failed";
+            break;
+        }
+
+        if (RET_FAILED(ActionToResponse(request->action, &request->response)))
+        {
+            request->errorCode = 404;
+            request->errorStatus = "ACTION Execute failed";
+            break;
+        }
+    } while (0);
+
+    UpnpService_Unlock(job->service);
+}
+
+static void OnActionFinished(UpnpActionToken *token, void *ctx)
+{
+    UpnpPendingAction *pending = (UpnpPendingAction *)ctx;
+    UpnpActionExecutor *thiz = pending->executor;
+    UpnpPendingAction **link = NULL;
+    HttpMessage response;
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    for (link = &thiz->pending; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == pending)
+        {
+            *link = pending->next;
+            break;
+        }
+    }
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    if (UpnpActionToken_GetCode(token) != UPNP_SUCCESS)
+    {
+        UpnpHttpConnection_SendError(pending->conn, UpnpActionToken_GetCode(token), UpnpActionToken_GetDescription(token));
+    }
+    else if (RET_FAILED(HttpMessage_Construct(&response)))
+    {
+        UpnpHttpConnection_SendError(pending->conn, 500, "Internal Server Error");
+    }
+    else
+    {
+        if (RET_FAILED(ActionResultsToResponse(pending->action, UpnpActionToken_GetResults(token), &response)))
+        {
+            UpnpHttpConnection_SendError(pending->conn, 404, "ACTION Execute failed");
+        }
+        else
+        {
+            UpnpHttpConnection_SendResponse(pending->conn, &response);
+        }
+
+        HttpMessage_Dispose(&response);
+    }
+
+    UpnpHttpConnection_Close(pending->conn);
+    UpnpProvider_ReleaseAction(thiz->provider, pending->context);
+    UpnpActionToken_Release(token);
+    tiny_free(pending);
+}
+
+/**
+ * fails the pending actions due by now (all of them with now 0), outside
+ * the lock: their listeners take it
+ */
+static void UpnpActionExecutor_Expire(UpnpActionExecutor *thiz, uint64_t now, UpnpCode code, const char *description)
+{
+    while (true)
+    {
+        UpnpActionToken *expired[ACTION_EXPIRE_MAX];
+        UpnpPendingAction *pending = NULL;
+        uint32_t count = 0;
+        uint32_t i = 0;
+
+        TinyMutex_Lock(&thiz->mutex);
+
+        for (pending = thiz->pending; pending != NULL && count < ACTION_EXPIRE_MAX; pending = pending->next)
+        {
+            if (!pending->expired && (now == 0 || pending->deadline <= now))
+            {
+                pending->expired = true;
+                UpnpActionToken_Retain(pending->token);
+                expired[count++] = pending->token;
+            }
+        }
+
+        TinyMutex_Unlock(&thiz->mutex);
+
+        for (i = 0; i < count; i++)
+        {
+            UpnpActionToken_Cancel(expired[i], code, description);
+            UpnpActionToken_Release(expired[i]);
+        }
+
+        if (count < ACTION_EXPIRE_MAX)
+        {
+            break;
+        }
+    }
+}
+
+static bool OnTimer(TinyTimer *timer, void *ctx)
+{
+    UpnpActionExecutor *thiz = (UpnpActionExecutor *)ctx;
+
+    UpnpActionExecutor_Expire(thiz, tiny_getusec(), UPNP_ERR_ACTION_FAILED, "Action timed out");
+
+    return true;
+}
+
+/**
+ * The connection is detached and parked with the token before the handler
+ * sees it, so whichever comes first (Complete/Fail, the deadline, a stop)
+ * answers it, from its own thread, and this one goes back at once.
+ */
+static void UpnpActionExecutor_Defer(UpnpActionExecutor *thiz, UpnpHttpConnection *conn, UpnpActionRequest *request)
+{
+    UpnpPendingAction *pending = NULL;
+
+    do
+    {
+        pending = (UpnpPendingAction *)tiny_malloc(sizeof(UpnpPendingAction));
+        if (pending == NULL)
+        {
+            break;
+        }
+
+        memset(pending, 0, sizeof(UpnpPendingAction));
+        pending->executor = thiz;
+        pending->action = request->action;
+        pending->context = request->context;
+        pending->deadline = tiny_getusec() + (uint64_t)UPNP_ACTION_TIMEOUT * 1000;
+
+        pending->token = UpnpActionToken_New();
+        if (pending->token == NULL)
+        {
+            tiny_free(pending);
+            pending = NULL;
+            break;
+        }
+
+        pending->conn = UpnpHttpConnection_Detach(conn);
+        if (pending->conn == NULL)
+        {
+            UpnpActionToken_Release(pending->token);
+            tiny_free(pending);
+            pending = NULL;
+            break;
+        }
+    } while (0);
+
+    if (pending == NULL)
+    {
+        UpnpHttpConnection_SendError(conn, 500, "Internal Server Error");
+        UpnpProvider_ReleaseAction(thiz->provider, request->context);
+        return;
+    }
+
+    UpnpActionToken_SetListener(pending->token, OnActionFinished, pending);
+
+    TinyMutex_Lock(&thiz->mutex);
+    pending->next = thiz->pending;
+    thiz->pending = pending;
+    TinyMutex_Unlock(&thiz->mutex);
+
+    /**
+     * ours, until the job is done with it
+     */
+    request->token = pending->token;
+    UpnpActionToken_Retain(request->token);
+
+    if (RET_FAILED(UpnpActionPool_Execute(&thiz->pool, &request->job)))
+    {
+        UpnpActionToken_Cancel(request->token, 503, "Service Unavailable");
+    }
+    else if (request->errorCode != 0)
+    {
+        UpnpActionToken_Cancel(request->token, request->errorCode, request->errorStatus);
+    }
+
+    UpnpActionToken_Release(request->token);
+}
+
 static void OnPost(UpnpHttpConnection *conn, const char *uri, const char *soapAction, const char *content, uint32_t contentLength, void *ctx)
 {
     UpnpActionExecutor *thiz = (UpnpActionExecutor *)ctx;
 
     LOG_D(TAG, "OnPost: %s", uri);
 
-    UpnpProvider_Lock(thiz->provider);
-
     do
     {
         char buffer[1024];
         uint32_t count = 0;
         char group[4][128];
-        const char *serviceType = NULL;
-        const char *actionName = NULL;
+        UpnpActionRequest request;
 
         memset(buffer, 0, 1024);
         strncpy(buffer, soapAction + 1, strlen(soapAction) - 2);
@@ -50,40 +307,71 @@ static void OnPost(UpnpHttpConnection *conn, const char *uri, const char *soapAc
             break;
         }
 
-        serviceType = group[0];
-        actionName = group[1];
+        memset(&request, 0, sizeof(UpnpActionRequest));
 
-        UpnpAction *action = UpnpProvider_GetAction(thiz->provider, uri, serviceType, actionName);
-        if (action == NULL)
-        {
-            UpnpHttpConnection_SendError(conn, 404, "NOT FOUND");
-            break;
-        }
+        /**
+         * shared only for the lookup: the context keeps the device
+         * registered until the response is out
+         */
+        UpnpProvider_ReadLock(thiz->provider);
+        request.context = UpnpProvider_AcquireAction(thiz->provider, uri, group[0], group[1], &request.action);
+        UpnpProvider_ReadUnlock(thiz->provider);
 
-        if (RET_FAILED(ActionFromRequest(action, content, contentLength)))
+        if (request.context == NULL)
         {
             UpnpHttpConnection_SendError(conn, 404, "NOT FOUND");
             break;
         }
 
-        UpnpActionHandlerContext * context = UpnpProvider_GetActionHandlerContext(thiz->provider, action);
-        if (context == NULL)
+        request.content = content;
+        request.contentLength = contentLength;
+        request.job.service = (UpnpService *)UpnpAction_GetParentService(request.action);
+        request.job.run = DoAction;
+        request.job.ctx = &request;
+
+        if (request.context->asyncHandler != NULL)
         {
-            UpnpHttpConnection_SendError(conn, 404, "NOT FOUND");
+            UpnpActionExecutor_Defer(thiz, conn, &request);
             break;
         }
 
-        UpnpCode code = context->handler(action, context->ctx);
-        if (code != UPNP_SUCCESS)
+        request.job.exclusive = true;
+
+        do
         {
-            UpnpHttpConnection_SendError(conn, code, "ACTION Execute failed");
-            break;
-        }
+            if (RET_FAILED(HttpMessage_Construct(&request.response)))
+            {
+                UpnpHttpConnection_SendError(conn, 500, "Internal Server Error");
+                break;
+            }
 
-        UpnpHttpConnection_SendActionResponse(conn, action);
-    } while (0);
+            request.arguments = PropertyList_New();
+            if (request.arguments == NULL)
+            {
+                HttpMessage_Dispose(&request.response);
+                UpnpHttpConnection_SendError(conn, 500, "Internal Server Error");
+                break;
+            }
 
-    UpnpProvider_Unlock(thiz->provider);
+            if (RET_FAILED(UpnpActionPool_Execute(&thiz->pool, &request.job)))
+            {
+                UpnpHttpConnection_SendError(conn, 503, "Service Unavailable");
+            }
+            else if (request.errorCode != 0)
+            {
+                UpnpHttpConnection_SendError(conn, request.errorCode, request.errorStatus);
+            }
+            else
+            {
+                UpnpHttpConnection_SendResponse(conn, &request.response);
+            }
+
+            PropertyList_Delete(request.arguments);
+            HttpMessage_Dispose(&request.response);
+        } while (0);
+
+        UpnpProvider_ReleaseAction(thiz->provider, request.context);
+    } while (0);
 }
 
 UpnpActionExecutor * UpnpActionExecutor_New(UpnpHttpManager *http, UpnpProvider *provider)
@@ -124,6 +412,34 @@ TinyRet UpnpActionExecutor_Construct(UpnpActionExecutor *thiz, UpnpHttpManager *
         thiz->http = http;
         thiz->provider = provider;
 
+        ret = TinyMutex_Construct(&thiz->mutex);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyMutex_Construct: failed");
+            break;
+        }
+
+        ret = TinyTimer_Construct(&thiz->timer);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyTimer_Construct: failed");
+            break;
+        }
+
+        ret = TinyTimer_Initialize(&thiz->timer, ACTION_TIMER_INTERVAL, 0);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyTimer_Initialize: failed");
+            break;
+        }
+
+        ret = UpnpActionPool_Construct(&thiz->pool, UPNP_ACTION_WORKERS, UPNP_ACTION_SERVICE_LIMIT);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "UpnpActionPool_Construct: failed");
+            break;
+        }
+
         ret = UpnpHttpServer_RegisterPostHandler(&http->server, OnPost, thiz);
         if (RET_FAILED(ret))
         {
@@ -144,6 +460,16 @@ void UpnpActionExecutor_Dispose(UpnpActionExecutor *thiz)
         LOG_E(TAG, "UpnpHttpServer_UnregisterPostHandler: failed");
     }
 
+    UpnpActionPool_Dispose(&thiz->pool);
+
+    /**
+     * handlers may still hold tokens: answer their requests now
+     */
+    TinyTimer_Stop(&thiz->timer);
+    UpnpActionExecutor_Expire(thiz, 0, 503, "Service Unavailable");
+    TinyTimer_Dispose(&thiz->timer);
+    TinyMutex_Dispose(&thiz->mutex);
+
     thiz->http = NULL;
     thiz->provider = NULL;
 }
@@ -154,4 +480,44 @@ void UpnpActionExecutor_Delete(UpnpActionExecutor *thiz)
 
     UpnpActionExecutor_Dispose(thiz);
     tiny_free(thiz);
-}
\ No newline at end of file
+}
+
+TinyRet UpnpActionExecutor_Start(UpnpActionExecutor *thiz)
+{
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    ret = TinyTimer_Start(&thiz->timer, OnTimer, thiz);
+    if (RET_FAILED(ret))
+    {
+        LOG_E(TAG, "TinyTimer_Start: failed");
+    }
+
+    return ret;
+}
+
+TinyRet UpnpActionExecutor_Stop(UpnpActionExecutor *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    TinyTimer_Stop(&thiz->timer);
+    UpnpActionExecutor_Expire(thiz, 0, 503, "Service Unavailable");
+
+    return TINY_RET_OK;
+}
+
+void UpnpActionExecutor_SetServiceLimit(UpnpActionExecutor *thiz, uint32_t limit)
+{
+    RETURN_IF_FAIL(thiz);
+
+    UpnpActionPool_SetServiceLimit(&thiz->pool, limit);
+}
+
+void UpnpActionExecutor_GetStats(UpnpActionExecutor *thiz, UpnpActionPoolStats *stats)
+{
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(stats);
+
+    UpnpActionPool_GetStats(&thiz->pool, stats);
+}
@@ -18,14 +18,37 @@
 #include "tiny_base.h"
 #include "UpnpHttpManager.h"
 #include "UpnpProvider.h"
+#include "UpnpActionPool.h"
+#include "TinyMutex.h"
+#include "TinyTimer.h"
 
 TINY_BEGIN_DECLS
 
 
+/**
+ * A deferred action between its handler's return and its result: it
+ * holds the detached connection, so no thread waits for it.
+ */
+typedef struct _UpnpPendingAction
+{
+    struct _UpnpPendingAction *next;
+    struct _UpnpActionExecutor *executor;
+    UpnpHttpConnection *conn;
+    UpnpAction *action;
+    UpnpActionHandlerContext *context;
+    UpnpActionToken *token;
+    uint64_t deadline;
+    bool expired;
+} UpnpPendingAction;
+
 typedef struct _UpnpActionExecutor
 {
     UpnpHttpManager *http;
     UpnpProvider *provider;
+    UpnpActionPool pool;
+    TinyMutex mutex;
+    UpnpPendingAction *pending;
+    TinyTimer timer;
 } UpnpActionExecutor;
 
 UpnpActionExecutor * UpnpActionExecutor_New(UpnpHttpManager *http, UpnpProvider *provider);
@@ -33,6 +56,12 @@ TinyRet UpnpActionExecutor_Construct(UpnpActionExecutor *thiz, UpnpHttpManager *
 void UpnpActionExecutor_Dispose(UpnpActionExecutor *thiz);
 void UpnpActionExecutor_Delete(UpnpActionExecutor *thiz);
 
+TinyRet UpnpActionExecutor_Start(UpnpActionExecutor *thiz);
+TinyRet UpnpActionExecutor_Stop(UpnpActionExecutor *thiz);
+
+void UpnpActionExecutor_SetServiceLimit(UpnpActionExecutor *thiz, uint32_t limit);
+void UpnpActionExecutor_GetStats(UpnpActionExecutor *thiz, UpnpActionPoolStats *stats);
+
 
 TINY_END_DECLS
 
@@ -0,0 +1,429 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpActionPool.c
+*
+* @remark
+*
+*/
+
+#include "UpnpActionPool.h"
+#include "tiny_memory.h"
+#include "tiny_log.h"
+#include "tiny_time.h"
+
+#define TAG     "UpnpActionPool"
+
+static void worker_loop(void *param);
+
+static void UpnpActionPool_PushRunnable(UpnpActionPool *thiz, UpnpActionJob *job)
+{
+    job->next = NULL;
+
+    if (thiz->tail == NULL)
+    {
+        thiz->head = job;
+    }
+    else
+    {
+        thiz->tail->next = job;
+    }
+
+    thiz->tail = job;
+
+    TinySemaphore_Post(&thiz->ready);
+}
+
+static UpnpActionJob * UpnpActionPool_PopRunnable(UpnpActionPool *thiz)
+{
+    UpnpActionJob *job = thiz->head;
+
+    if (job != NULL)
+    {
+        thiz->head = job->next;
+        if (thiz->head == NULL)
+        {
+            thiz->tail = NULL;
+        }
+
+        job->next = NULL;
+    }
+
+    return job;
+}
+
+static bool UpnpActionPool_CanStart(UpnpActionPool *thiz, UpnpActionLane *lane, UpnpActionJob *job)
+{
+    if (lane->exclusive)
+    {
+        return false;
+    }
+
+    return job->exclusive ? (lane->running == 0) : (lane->running < thiz->serviceLimit);
+}
+
+static void UpnpActionPool_Start(UpnpActionPool *thiz, UpnpActionLane *lane, UpnpActionJob *job)
+{
+    lane->running++;
+    lane->exclusive = job->exclusive;
+    UpnpActionPool_PushRunnable(thiz, job);
+}
+
+static UpnpActionLane * UpnpActionPool_GetLane(UpnpActionPool *thiz, UpnpService *service)
+{
+    UpnpActionLane *lane = NULL;
+
+    for (lane = thiz->lanes; lane != NULL; lane = lane->next)
+    {
+        if (lane->service == service)
+        {
+            return lane;
+        }
+    }
+
+    lane = (UpnpActionLane *)tiny_malloc(sizeof(UpnpActionLane));
+    if (lane != NULL)
+    {
+        memset(lane, 0, sizeof(UpnpActionLane));
+        lane->service = service;
+        lane->next = thiz->lanes;
+        thiz->lanes = lane;
+    }
+
+    return lane;
+}
+
+static void UpnpActionPool_RemoveLane(UpnpActionPool *thiz, UpnpActionLane *lane)
+{
+    UpnpActionLane **link = &thiz->lanes;
+
+    while (*link != NULL)
+    {
+        if (*link == lane)
+        {
+            *link = lane->next;
+            tiny_free(lane);
+            break;
+        }
+
+        link = &(*link)->next;
+    }
+}
+
+/**
+ * a job of this service finished: admit the waiting ones now allowed, in
+ * order, or drop the idle lane
+ */
+static void UpnpActionPool_ReleaseLane(UpnpActionPool *thiz, UpnpActionJob *finished)
+{
+    UpnpActionLane *lane = NULL;
+
+    for (lane = thiz->lanes; lane != NULL; lane = lane->next)
+    {
+        if (lane->service == finished->service)
+        {
+            break;
+        }
+    }
+
+    if (lane == NULL)
+    {
+        return;
+    }
+
+    lane->running--;
+    if (finished->exclusive)
+    {
+        lane->exclusive = false;
+    }
+
+    while (lane->head != NULL && UpnpActionPool_CanStart(thiz, lane, lane->head))
+    {
+        UpnpActionJob *job = lane->head;
+        lane->head = job->next;
+        if (lane->head == NULL)
+        {
+            lane->tail = NULL;
+        }
+
+        UpnpActionPool_Start(thiz, lane, job);
+    }
+
+    if (lane->running == 0 && lane->head == NULL)
+    {
+        UpnpActionPool_RemoveLane(thiz, lane);
+    }
+}
+
+TinyRet UpnpActionPool_Construct(UpnpActionPool *thiz, uint32_t workers, uint32_t serviceLimit)
+{
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    do
+    {
+        uint32_t i = 0;
+
+        memset(thiz, 0, sizeof(UpnpActionPool));
+
+        thiz->serviceLimit = (serviceLimit > 0) ? serviceLimit : 1;
+        thiz->workerCount = (workers == 0) ? 1 : ((workers > UPNP_ACTION_POOL_MAX_WORKERS) ? UPNP_ACTION_POOL_MAX_WORKERS : workers);
+
+        ret = TinyMutex_Construct(&thiz->mutex);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyMutex_Construct failed");
+            break;
+        }
+
+        ret = TinySemaphore_Construct(&thiz->ready);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinySemaphore_Construct failed");
+            break;
+        }
+
+        thiz->running = true;
+
+        for (i = 0; i < thiz->workerCount; i++)
+        {
+            ret = TinyThread_Construct(&thiz->workers[i]);
+            if (RET_FAILED(ret))
+            {
+                LOG_E(TAG, "TinyThread_Construct failed");
+                break;
+            }
+
+            ret = TinyThread_Initialize(&thiz->workers[i], worker_loop, thiz, "UpnpActionPool");
+            if (RET_FAILED(ret))
+            {
+                LOG_E(TAG, "TinyThread_Initialize failed");
+                break;
+            }
+
+            TinyThread_Start(&thiz->workers[i]);
+        }
+
+        if (RET_FAILED(ret))
+        {
+            thiz->workerCount = i;
+            break;
+        }
+    } while (0);
+
+    return ret;
+}
+
+void UpnpActionPool_Dispose(UpnpActionPool *thiz)
+{
+    uint32_t i = 0;
+
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Lock(&thiz->mutex);
+    thiz->running = false;
+    TinyMutex_Unlock(&thiz->mutex);
+
+    /**
+     * workers drain what was admitted, then leave on an empty queue
+     */
+    for (i = 0; i < thiz->workerCount; i++)
+    {
+        TinySemaphore_Post(&thiz->ready);
+    }
+
+    for (i = 0; i < thiz->workerCount; i++)
+    {
+        TinyThread_Join(&thiz->workers[i]);
+        TinyThread_Dispose(&thiz->workers[i]);
+    }
+
+    /**
+     * nothing left to run them: cancel
+     */
+    while (thiz->lanes != NULL)
+    {
+        UpnpActionLane *lane = thiz->lanes;
+        thiz->lanes = lane->next;
+
+        while (lane->head != NULL)
+        {
+            UpnpActionJob *job = lane->head;
+            lane->head = job->next;
+            job->cancelled = true;
+            TinySemaphore_Post(&job->done);
+        }
+
+        tiny_free(lane);
+    }
+
+    while (thiz->head != NULL)
+    {
+        UpnpActionJob *job = UpnpActionPool_PopRunnable(thiz);
+        job->cancelled = true;
+        TinySemaphore_Post(&job->done);
+    }
+
+    TinySemaphore_Dispose(&thiz->ready);
+    TinyMutex_Dispose(&thiz->mutex);
+}
+
+void UpnpActionPool_SetServiceLimit(UpnpActionPool *thiz, uint32_t serviceLimit)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Lock(&thiz->mutex);
+    thiz->serviceLimit = (serviceLimit > 0) ? serviceLimit : 1;
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+TinyRet UpnpActionPool_Execute(UpnpActionPool *thiz, UpnpActionJob *job)
+{
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(job, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(job->run, TINY_RET_E_ARG_NULL);
+
+    ret = TinySemaphore_Construct(&job->done);
+    if (RET_FAILED(ret))
+    {
+        return ret;
+    }
+
+    job->next = NULL;
+    job->cancelled = false;
+    job->queued = tiny_getusec();
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    do
+    {
+        UpnpActionLane *lane = NULL;
+
+        if (!thiz->running)
+        {
+            ret = TINY_RET_E_STOPPED;
+            break;
+        }
+
+        lane = UpnpActionPool_GetLane(thiz, job->service);
+        if (lane == NULL)
+        {
+            ret = TINY_RET_E_OUT_OF_MEMORY;
+            break;
+        }
+
+        thiz->stats.queued++;
+        if (thiz->stats.queued > thiz->stats.maxQueued)
+        {
+            thiz->stats.maxQueued = thiz->stats.queued;
+        }
+
+        /**
+         * never ahead of a job already waiting: an exclusive one would starve
+         */
+        if (lane->head == NULL && UpnpActionPool_CanStart(thiz, lane, job))
+        {
+            UpnpActionPool_Start(thiz, lane, job);
+            break;
+        }
+
+        if (lane->tail == NULL)
+        {
+            lane->head = job;
+        }
+        else
+        {
+            lane->tail->next = job;
+        }
+
+        lane->tail = job;
+    } while (0);
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    if (RET_SUCCEEDED(ret))
+    {
+        TinySemaphore_Wait(&job->done);
+
+        if (job->cancelled)
+        {
+            ret = TINY_RET_E_STOPPED;
+        }
+    }
+
+    TinySemaphore_Dispose(&job->done);
+
+    return ret;
+}
+
+void UpnpActionPool_GetStats(UpnpActionPool *thiz, UpnpActionPoolStats *stats)
+{
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(stats);
+
+    TinyMutex_Lock(&thiz->mutex);
+    memcpy(stats, &thiz->stats, sizeof(UpnpActionPoolStats));
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+static void worker_loop(void *param)
+{
+    UpnpActionPool *thiz = (UpnpActionPool *)param;
+
+    while (true)
+    {
+        UpnpActionJob *job = NULL;
+        uint64_t start = 0;
+        uint64_t elapsed = 0;
+
+        TinySemaphore_Wait(&thiz->ready);
+
+        TinyMutex_Lock(&thiz->mutex);
+
+        job = UpnpActionPool_PopRunnable(thiz);
+        if (job == NULL)
+        {
+            bool running = thiz->running;
+            TinyMutex_Unlock(&thiz->mutex);
+
+            if (!running)
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        start = tiny_getusec();
+        thiz->stats.queued--;
+        thiz->stats.running++;
+        thiz->stats.totalWaitUsec += start - job->queued;
+
+        TinyMutex_Unlock(&thiz->mutex);
+
+        job->run(job, job->ctx);
+        elapsed = tiny_getusec() - start;
+
+        TinyMutex_Lock(&thiz->mutex);
+
+        thiz->stats.running--;
+        thiz->stats.executed++;
+        thiz->stats.totalRunUsec += elapsed;
+        if (elapsed > thiz->stats.maxRunUsec)
+        {
+            thiz->stats.maxRunUsec = elapsed;
+        }
+
+        UpnpActionPool_ReleaseLane(thiz, job);
+
+        TinyMutex_Unlock(&thiz->mutex);
+
+        TinySemaphore_Post(&job->done);
+    }
+}
@@ -0,0 +1,99 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpActionPool.h
+*
+* @remark
+*
+*/
+
+#ifndef __UPNP_ACTION_POOL_H__
+#define __UPNP_ACTION_POOL_H__
+
+#include "tiny_base.h"
+#include "TinyMutex.h"
+#include "TinySemaphore.h"
+#include "TinyThread.h"
+#include "UpnpService.h"
+
+TINY_BEGIN_DECLS
+
+
+#define UPNP_ACTION_POOL_MAX_WORKERS    16
+
+struct _UpnpActionJob;
+typedef struct _UpnpActionJob UpnpActionJob;
+
+typedef void(*UpnpActionJobRunner)(UpnpActionJob *job, void *ctx);
+
+/**
+ * Owned by the caller, usually on its stack: UpnpActionPool_Execute
+ * returns only after the job ran (or was cancelled by a stop).
+ * An exclusive job runs alone among the jobs of its service, whatever
+ * the service limit.
+ */
+struct _UpnpActionJob
+{
+    UpnpActionJob             * next;
+    UpnpService               * service;
+    bool                        exclusive;
+    UpnpActionJobRunner         run;
+    void                      * ctx;
+    bool                        cancelled;
+    uint64_t                    queued;
+    TinySemaphore               done;
+};
+
+/**
+ * Jobs of one service beyond the limit wait here, off the workers, and
+ * start in the order they came; exclusive: one such job is running.
+ */
+typedef struct _UpnpActionLane
+{
+    struct _UpnpActionLane    * next;
+    UpnpService               * service;
+    uint32_t                    running;
+    bool                        exclusive;
+    UpnpActionJob             * head;
+    UpnpActionJob             * tail;
+} UpnpActionLane;
+
+typedef struct _UpnpActionPoolStats
+{
+    uint32_t                    queued;
+    uint32_t                    maxQueued;
+    uint32_t                    running;
+    uint32_t                    executed;
+    uint64_t                    totalWaitUsec;
+    uint64_t                    totalRunUsec;
+    uint64_t                    maxRunUsec;
+} UpnpActionPoolStats;
+
+typedef struct _UpnpActionPool
+{
+    bool                        running;
+    TinyMutex                   mutex;
+    TinySemaphore               ready;
+    UpnpActionJob             * head;
+    UpnpActionJob             * tail;
+    UpnpActionLane            * lanes;
+    uint32_t                    serviceLimit;
+    uint32_t                    workerCount;
+    TinyThread                  workers[UPNP_ACTION_POOL_MAX_WORKERS];
+    UpnpActionPoolStats         stats;
+} UpnpActionPool;
+
+TinyRet UpnpActionPool_Construct(UpnpActionPool *thiz, uint32_t workers, uint32_t serviceLimit);
+void UpnpActionPool_Dispose(UpnpActionPool *thiz);
+
+void UpnpActionPool_SetServiceLimit(UpnpActionPool *thiz, uint32_t serviceLimit);
+TinyRet UpnpActionPool_Execute(UpnpActionPool *thiz, UpnpActionJob *job);
+void UpnpActionPool_GetStats(UpnpActionPool *thiz, UpnpActionPoolStats *stats);
+
+
+TINY_END_DECLS
+
+#endif /* __UPNP_ACTION_POOL_H__ */
@@ -0,0 +1,357 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpDocumentCache.c
+*
+* @remark
+*
+*/
+
+#include "UpnpDocumentCache.h"
+#include "tiny_memory.h"
+#include "tiny_log.h"
+#include "tiny_str_hash.h"
+#include "tiny_gzip.h"
+
+#define TAG     "UpnpDocumentCache"
+
+static void UpnpDocument_Compress(UpnpDocument *thiz)
+{
+    uint32_t bound = tiny_gzip_bound(thiz->length);
+    uint32_t size = 0;
+
+    thiz->gzip = (char *)tiny_malloc(bound);
+    if (thiz->gzip == NULL)
+    {
+        return;
+    }
+
+    size = tiny_gzip_compress(thiz->content, thiz->length, thiz->gzip, bound);
+    if (size == 0 || size >= thiz->length)
+    {
+        tiny_free(thiz->gzip);
+        thiz->gzip = NULL;
+        return;
+    }
+
+    /**
+     * shrink to fit, keep the bound-sized buffer if that fails
+     */
+    {
+        char *gzip = (char *)tiny_realloc(thiz->gzip, size);
+        if (gzip != NULL)
+        {
+            thiz->gzip = gzip;
+        }
+    }
+
+    thiz->gzipLength = size;
+
+    /**
+     * each representation gets its own strong validator
+     */
+    tiny_snprintf(thiz->gzipEtag, UPNP_ETAG_LEN, "\"%08x-%x-gz\"", str_hash_n(thiz->content, thiz->length), thiz->length);
+}
+
+static UpnpDocument * UpnpDocument_New(const char *content, uint32_t length)
+{
+    UpnpDocument *thiz = NULL;
+
+    do
+    {
+        thiz = (UpnpDocument *)tiny_malloc(sizeof(UpnpDocument));
+        if (thiz == NULL)
+        {
+            break;
+        }
+
+        memset(thiz, 0, sizeof(UpnpDocument));
+
+        thiz->content = (char *)tiny_malloc(length + 1);
+        if (thiz->content == NULL)
+        {
+            tiny_free(thiz);
+            thiz = NULL;
+            break;
+        }
+
+        memcpy(thiz->content, content, length);
+        thiz->content[length] = 0;
+        thiz->length = length;
+        thiz->ref = 1;
+
+        /**
+         * strong validator: same bytes, same tag
+         */
+        tiny_snprintf(thiz->etag, UPNP_ETAG_LEN, "\"%08x-%x\"", str_hash_n(content, length), length);
+
+        UpnpDocument_Compress(thiz);
+    } while (0);
+
+    return thiz;
+}
+
+static void UpnpDocument_Unref(UpnpDocument *thiz)
+{
+    thiz->ref--;
+    if (thiz->ref == 0)
+    {
+        if (thiz->gzip != NULL)
+        {
+            tiny_free(thiz->gzip);
+        }
+
+        tiny_free(thiz->content);
+        tiny_free(thiz);
+    }
+}
+
+static void document_delete_listener(void *data, void *ctx)
+{
+    UpnpDocument_Unref((UpnpDocument *)data);
+}
+
+TinyRet UpnpDocumentCache_Construct(UpnpDocumentCache *thiz)
+{
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    do
+    {
+        memset(thiz, 0, sizeof(UpnpDocumentCache));
+
+        ret = TinyMutex_Construct(&thiz->mutex);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyMutex_Construct failed");
+            break;
+        }
+
+        ret = TinyMap_Construct(&thiz->documents);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyMap_Construct failed");
+            break;
+        }
+
+        TinyMap_SetDeleteListener(&thiz->documents, document_delete_listener, NULL);
+    } while (0);
+
+    return ret;
+}
+
+void UpnpDocumentCache_Dispose(UpnpDocumentCache *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMap_Dispose(&thiz->documents);
+    TinyMutex_Dispose(&thiz->mutex);
+}
+
+uint32_t UpnpDocumentCache_GetGeneration(UpnpDocumentCache *thiz)
+{
+    uint32_t generation = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, 0);
+
+    TinyMutex_Lock(&thiz->mutex);
+    generation = thiz->generation;
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return generation;
+}
+
+UpnpDocument * UpnpDocumentCache_Get(UpnpDocumentCache *thiz, const char *uri)
+{
+    UpnpDocument *document = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+    RETURN_VAL_IF_FAIL(uri, NULL);
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    document = (UpnpDocument *)TinyMap_GetValue(&thiz->documents, uri);
+    if (document != NULL)
+    {
+        document->ref++;
+        thiz->hits++;
+    }
+    else
+    {
+        thiz->misses++;
+    }
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return document;
+}
+
+UpnpDocument * UpnpDocumentCache_Put(UpnpDocumentCache *thiz, uint32_t generation, const char *uri, const char *content, uint32_t length)
+{
+    UpnpDocument *document = NULL;
+    UpnpDocument *cached = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+    RETURN_VAL_IF_FAIL(uri, NULL);
+    RETURN_VAL_IF_FAIL(content, NULL);
+
+    document = UpnpDocument_New(content, length);
+    if (document == NULL)
+    {
+        LOG_E(TAG, "UpnpDocument_New failed");
+        return NULL;
+    }
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    do
+    {
+        /**
+         * rendered from a model that has changed since: serve it once, never cache it
+         */
+        if (generation != thiz->generation)
+        {
+            break;
+        }
+
+        /**
+         * another connection rendered it first
+         */
+        cached = (UpnpDocument *)TinyMap_GetValue(&thiz->documents, uri);
+        if (cached != NULL)
+        {
+            cached->ref++;
+            break;
+        }
+
+        if (RET_SUCCEEDED(TinyMap_Insert(&thiz->documents, uri, document)))
+        {
+            document->ref++;
+        }
+    } while (0);
+
+    if (cached != NULL)
+    {
+        UpnpDocument_Unref(document);
+        document = cached;
+    }
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return document;
+}
+
+void UpnpDocumentCache_Release(UpnpDocumentCache *thiz, UpnpDocument *document)
+{
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(document);
+
+    TinyMutex_Lock(&thiz->mutex);
+    UpnpDocument_Unref(document);
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+void UpnpDocumentCache_Clear(UpnpDocumentCache *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Lock(&thiz->mutex);
+    thiz->generation++;
+    TinyMap_Clear(&thiz->documents);
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+void UpnpDocumentCache_CountSent(UpnpDocumentCache *thiz, bool gzip)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    if (gzip)
+    {
+        thiz->gzipSent++;
+    }
+    else
+    {
+        thiz->identitySent++;
+    }
+
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+void UpnpDocumentCache_GetStats(UpnpDocumentCache *thiz, UpnpDocumentCacheStats *stats)
+{
+    uint32_t i = 0;
+
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(stats);
+
+    memset(stats, 0, sizeof(UpnpDocumentCacheStats));
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    stats->documents = TinyMap_GetCount(&thiz->documents);
+    stats->hits = thiz->hits;
+    stats->misses = thiz->misses;
+    stats->gzipSent = thiz->gzipSent;
+    stats->identitySent = thiz->identitySent;
+
+    for (i = 0; i < stats->documents; i++)
+    {
+        UpnpDocument *document = (UpnpDocument *)TinyMap_GetValueAt(&thiz->documents, i);
+        stats->bytes += document->length;
+        stats->gzipBytes += document->gzipLength;
+    }
+
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+bool UpnpDocument_MatchETag(UpnpDocument *thiz, bool gzip, const char *ifNoneMatch)
+{
+    const char *etag = NULL;
+    uint32_t etagLength = 0;
+    const char *p = ifNoneMatch;
+
+    RETURN_VAL_IF_FAIL(thiz, false);
+    RETURN_VAL_IF_FAIL(ifNoneMatch, false);
+
+    etag = gzip ? thiz->gzipEtag : thiz->etag;
+    etagLength = (uint32_t)strlen(etag);
+
+    /**
+     * If-None-Match: *  |  If-None-Match: "a", W/"b", ...
+     */
+    while (*p != 0)
+    {
+        while (*p == ' ' || *p == '\t' || *p == ',')
+        {
+            p++;
+        }
+
+        if (*p == '*')
+        {
+            return true;
+        }
+
+        if (p[0] == 'W' && p[1] == '/')
+        {
+            p += 2;
+        }
+
+        if (strncmp(p, etag, etagLength) == 0)
+        {
+            return true;
+        }
+
+        while (*p != 0 && *p != ',')
+        {
+            p++;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,79 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpDocumentCache.h
+*
+* @remark
+*
+*/
+
+#ifndef __UPNP_DOCUMENT_CACHE_H__
+#define __UPNP_DOCUMENT_CACHE_H__
+
+#include "tiny_base.h"
+#include "TinyMutex.h"
+#include "TinyMap.h"
+
+TINY_BEGIN_DECLS
+
+
+#define UPNP_ETAG_LEN               32
+
+/**
+ * A rendered description document, shared by reference between the cache
+ * and the connections sending it. The gzip variant is compressed once at
+ * render time and only kept when it is smaller.
+ */
+typedef struct _UpnpDocument
+{
+    uint32_t                    ref;
+    char                      * content;
+    uint32_t                    length;
+    char                        etag[UPNP_ETAG_LEN];
+    char                      * gzip;
+    uint32_t                    gzipLength;
+    char                        gzipEtag[UPNP_ETAG_LEN];
+} UpnpDocument;
+
+typedef struct _UpnpDocumentCacheStats
+{
+    uint32_t                    documents;
+    uint32_t                    bytes;
+    uint32_t                    gzipBytes;
+    uint32_t                    hits;
+    uint32_t                    misses;
+    uint32_t                    gzipSent;
+    uint32_t                    identitySent;
+} UpnpDocumentCacheStats;
+
+typedef struct _UpnpDocumentCache
+{
+    TinyMutex                   mutex;
+    TinyMap                     documents;
+    uint32_t                    generation;
+    uint32_t                    hits;
+    uint32_t                    misses;
+    uint32_t                    gzipSent;
+    uint32_t                    identitySent;
+} UpnpDocumentCache;
+
+TinyRet UpnpDocumentCache_Construct(UpnpDocumentCache *thiz);
+void UpnpDocumentCache_Dispose(UpnpDocumentCache *thiz);
+
+uint32_t UpnpDocumentCache_GetGeneration(UpnpDocumentCache *thiz);
+UpnpDocument * UpnpDocumentCache_Get(UpnpDocumentCache *thiz, const char *uri);
+UpnpDocument * UpnpDocumentCache_Put(UpnpDocumentCache *thiz, uint32_t generation, const char *uri, const char *content, uint32_t length);
+void UpnpDocumentCache_Release(UpnpDocumentCache *thiz, UpnpDocument *document);
+void UpnpDocumentCache_Clear(UpnpDocumentCache *thiz);
+void UpnpDocumentCache_CountSent(UpnpDocumentCache *thiz, bool gzip);
+void UpnpDocumentCache_GetStats(UpnpDocumentCache *thiz, UpnpDocumentCacheStats *stats);
+
+bool UpnpDocument_MatchETag(UpnpDocument *thiz, bool gzip, const char *ifNoneMatch);
+
+
+TINY_END_DECLS
+
+#endif /* __UPNP_DOCUMENT_CACHE_H__ */
@@ -15,34 +15,174 @@
 #include "UpnpDocumentGetter.h"
 #include "tiny_memory.h"
 #include "tiny_log.h"
+#include <ctype.h>
+#include <stdlib.h>
 
 #define TAG     "UpnpDocumentGetter"
 
-static void OnGet(UpnpHttpConnection *conn, const char *uri, void *ctx)
+static void OnDeviceChanged(UpnpDevice *device, void *ctx)
 {
     UpnpDocumentGetter *thiz = (UpnpDocumentGetter *)ctx;
 
-    LOG_D(TAG, "OnGet: %s", uri);
+    UpnpDocumentCache_Clear(&thiz->cache);
+}
 
-    UpnpProvider_Lock(thiz->provider);
+static UpnpDocument * UpnpDocumentGetter_Render(UpnpDocumentGetter *thiz, const char *uri)
+{
+    UpnpDocument *document = NULL;
+    char *content = NULL;
+    uint32_t contentLength = 0;
+    uint32_t generation = 0;
+
+    content = (char *)tiny_malloc(UPNP_DOCUMENT_LEN);
+    if (content == NULL)
+    {
+        LOG_E(TAG, "tiny_malloc failed");
+        return NULL;
+    }
+
+    memset(content, 0, UPNP_DOCUMENT_LEN);
+
+    /**
+     * the cache is cleared under the provider lock, so the generation read
+     * here is the one this rendering belongs to.
+     */
+    UpnpProvider_ReadLock(thiz->provider);
+    generation = UpnpDocumentCache_GetGeneration(&thiz->cache);
+    contentLength = UpnpProvider_GetDocument(thiz->provider, uri, content, UPNP_DOCUMENT_LEN);
+    UpnpProvider_ReadUnlock(thiz->provider);
+
+    if (contentLength > 0)
+    {
+        document = UpnpDocumentCache_Put(&thiz->cache, generation, uri, content, contentLength);
+    }
+
+    tiny_free(content);
+
+    return document;
+}
+
+static bool StartsWithNoCase(const char *s, const char *prefix)
+{
+    while (*prefix != 0)
+    {
+        if (tolower((unsigned char)*s) != *prefix)
+        {
+            return false;
+        }
+
+        s++;
+        prefix++;
+    }
+
+    return true;
+}
+
+/**
+ * Accept-Encoding: gzip, deflate  |  gzip;q=0.8  |  *  (q=0 refuses)
+ */
+static bool AcceptGzip(const char *acceptEncoding)
+{
+    const char *p = acceptEncoding;
+
+    if (p == NULL)
+    {
+        return false;
+    }
+
+    while (*p != 0)
+    {
+        bool matched = false;
+
+        while (*p == ' ' || *p == '\t' || *p == ',')
+        {
+            p++;
+        }
+
+        if (StartsWithNoCase(p, "gzip"))
+        {
+            matched = true;
+            p += 4;
+        }
+        else if (StartsWithNoCase(p, "x-gzip"))
+        {
+            matched = true;
+            p += 6;
+        }
+        else if (*p == '*')
+        {
+            matched = true;
+            p += 1;
+        }
+
+        if (matched && (*p == 0 || *p == ',' || *p == ';' || *p == ' '))
+        {
+            const char *q = strstr(p, "q=");
+            const char *next = strchr(p, ',');
+
+            if (q == NULL || (next != NULL && q > next))
+            {
+                return true;
+            }
+
+            return (atof(q + 2) > 0);
+        }
+
+        while (*p != 0 && *p != ',')
+        {
+            p++;
+        }
+    }
+
+    return false;
+}
+
+static void OnGet(UpnpHttpConnection *conn, const char *uri, const char *ifNoneMatch, const char *acceptEncoding, void *ctx)
+{
+    UpnpDocumentGetter *thiz = (UpnpDocumentGetter *)ctx;
+    UpnpDocument *document = NULL;
+    bool gzip = false;
+
+    LOG_D(TAG, "OnGet: %s", uri);
 
     do
     {
-        char content[UPNP_DOCUMENT_LEN];
-        uint32_t contentLength = 0;
+        document = UpnpDocumentCache_Get(&thiz->cache, uri);
+        if (document == NULL)
+        {
+            document = UpnpDocumentGetter_Render(thiz, uri);
+        }
 
-        memset(content, 0, UPNP_DOCUMENT_LEN);
-        contentLength = UpnpProvider_GetDocument(thiz->provider, uri, content, UPNP_DOCUMENT_LEN);
-        if (contentLength == 0)
+        if (document == NULL)
         {
             UpnpHttpConnection_SendError(conn, 404, "NOT FOUND");
             break;
         }
 
-        UpnpHttpConnection_SendFileContent(conn, content, contentLength);
+        gzip = (document->gzip != NULL && AcceptGzip(acceptEncoding));
+
+        if (ifNoneMatch != NULL && UpnpDocument_MatchETag(document, gzip, ifNoneMatch))
+        {
+            UpnpHttpConnection_SendNotModified(conn, gzip ? document->gzipEtag : document->etag);
+            break;
+        }
+
+        if (gzip)
+        {
+            UpnpHttpConnection_SendDocument(conn, document->gzip, document->gzipLength, "gzip", document->gzipEtag);
+        }
+        else
+        {
+            UpnpHttpConnection_SendDocument(conn, document->content, document->length, NULL, document->etag);
+        }
+
+        UpnpDocumentCache_CountSent(&thiz->cache, gzip);
     } while (0);
 
-    UpnpProvider_Unlock(thiz->provider);
+    if (document != NULL)
+    {
+        UpnpDocumentCache_Release(&thiz->cache, document);
+    }
 }
 
 UpnpDocumentGetter * UpnpDocumentGetter_New(UpnpHttpManager *http, UpnpProvider *provider)
@@ -83,6 +223,26 @@ TinyRet UpnpDocumentGetter_Construct(UpnpDocumentGetter *thiz, UpnpHttpManager *
         thiz->http = http;
         thiz->provider = provider;
 
+        ret = UpnpDocumentCache_Construct(&thiz->cache);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "UpnpDocumentCache_Construct: failed");
+            break;
+        }
+
+        /**
+         * documents are rendered from the device model, drop them when it changes
+         */
+        UpnpProvider_Lock(thiz->provider);
+        ret = UpnpProvider_AddObserver(thiz->provider, "UpnpDocumentGetter", OnDeviceChanged, OnDeviceChanged, NULL, thiz);
+        UpnpProvider_Unlock(thiz->provider);
+
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "UpnpProvider_AddObserver failed");
+            break;
+        }
+
         ret = UpnpHttpServer_RegisterGetHandler(&http->server, OnGet, thiz);
         if (RET_FAILED(ret))
         {
@@ -103,6 +263,17 @@ void UpnpDocumentGetter_Dispose(UpnpDocumentGetter *thiz)
         LOG_E(TAG, "UpnpHttpServer_UnregisterGetHandler: failed");
     }
 
+    UpnpProvider_Lock(thiz->provider);
+
+    if (RET_FAILED(UpnpProvider_RemoveObserver(thiz->provider, "UpnpDocumentGetter")))
+    {
+        LOG_E(TAG, "UpnpProvider_RemoveObserver failed");
+    }
+
+    UpnpProvider_Unlock(thiz->provider);
+
+    UpnpDocumentCache_Dispose(&thiz->cache);
+
     thiz->http = NULL;
     thiz->provider = NULL;
 }
@@ -113,4 +284,11 @@ void UpnpDocumentGetter_Delete(UpnpDocumentGetter *thiz)
 
     UpnpDocumentGetter_Dispose(thiz);
     tiny_free(thiz);
-}
\ No newline at end of file
+}
+
+void UpnpDocumentGetter_GetStats(UpnpDocumentGetter *thiz, UpnpDocumentCacheStats *stats)
+{
+    RETURN_IF_FAIL(thiz);
+
+    UpnpDocumentCache_GetStats(&thiz->cache, stats);
+}
@@ -18,6 +18,7 @@
 #include "tiny_base.h"
 #include "UpnpHttpManager.h"
 #include "UpnpProvider.h"
+#include "UpnpDocumentCache.h"
 
 TINY_BEGIN_DECLS
 
@@ -26,6 +27,7 @@ typedef struct _UpnpDocumentGetter
 {
     UpnpHttpManager *http;
     UpnpProvider *provider;
+    UpnpDocumentCache cache;
 } UpnpDocumentGetter;
 
 UpnpDocumentGetter * UpnpDocumentGetter_New(UpnpHttpManager *http, UpnpProvider *provider);
@@ -33,6 +35,8 @@ TinyRet UpnpDocumentGetter_Construct(UpnpDocumentGetter *thiz, UpnpHttpManager *
 void UpnpDocumentGetter_Dispose(UpnpDocumentGetter *thiz);
 void UpnpDocumentGetter_Delete(UpnpDocumentGetter *thiz);
 
+void UpnpDocumentGetter_GetStats(UpnpDocumentGetter *thiz, UpnpDocumentCacheStats *stats);
+
 
 TINY_END_DECLS
 
@@ -0,0 +1,854 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpEventDispatcher.c
+*
+* @remark
+*
+*/
+
+#include "UpnpEventDispatcher.h"
+#include "tiny_memory.h"
+#include "tiny_log.h"
+#include "tiny_time.h"
+
+#define TAG     "UpnpEventDispatcher"
+
+static void worker_loop(void *param);
+
+static void UpnpEventDispatcher_PushReady(UpnpEventDispatcher *thiz, UpnpEventQueue *queue)
+{
+    queue->nextReady = NULL;
+    queue->ready = true;
+
+    if (thiz->tail == NULL)
+    {
+        thiz->head = queue;
+    }
+    else
+    {
+        thiz->tail->nextReady = queue;
+    }
+
+    thiz->tail = queue;
+
+    TinySemaphore_Post(&thiz->ready);
+}
+
+static void UpnpEventDispatcher_RemoveReady(UpnpEventDispatcher *thiz, UpnpEventQueue *queue);
+
+/**
+ * The first ready queue, passing over the ones that failed last time
+ * while retryLimit of those are in flight: a few dead callbacks must not
+ * take every worker from the healthy ones.
+ */
+static UpnpEventQueue * UpnpEventDispatcher_PopReady(UpnpEventDispatcher *thiz)
+{
+    UpnpEventQueue *queue = NULL;
+
+    for (queue = thiz->head; queue != NULL; queue = queue->nextReady)
+    {
+        if (queue->failures == 0 || thiz->retrying < thiz->retryLimit)
+        {
+            UpnpEventDispatcher_RemoveReady(thiz, queue);
+            break;
+        }
+    }
+
+    return queue;
+}
+
+static void UpnpEventDispatcher_RemoveReady(UpnpEventDispatcher *thiz, UpnpEventQueue *queue)
+{
+    UpnpEventQueue *prev = NULL;
+    UpnpEventQueue *q = NULL;
+
+    for (q = thiz->head; q != NULL; prev = q, q = q->nextReady)
+    {
+        if (q == queue)
+        {
+            if (prev == NULL)
+            {
+                thiz->head = q->nextReady;
+            }
+            else
+            {
+                prev->nextReady = q->nextReady;
+            }
+
+            if (thiz->tail == q)
+            {
+                thiz->tail = prev;
+            }
+
+            q->nextReady = NULL;
+            q->ready = false;
+            break;
+        }
+    }
+}
+
+/**
+ * a queue is offered to the workers when it has something to send,
+ * nothing in flight and is not backing off from a failed callback
+ */
+static void UpnpEventDispatcher_Schedule(UpnpEventDispatcher *thiz, UpnpEventQueue *queue, uint64_t now)
+{
+    if (queue->head != NULL && !queue->busy && !queue->ready && !queue->closed && !queue->dead && now >= queue->retryAt)
+    {
+        UpnpEventDispatcher_PushReady(thiz, queue);
+    }
+}
+
+/**
+ * A body that failed goes back in front, under the same SEQ, so the
+ * latest values still reach the subscriber; on a full queue it is folded
+ * into the next body instead. Returns the item if it was not kept.
+ */
+static UpnpEventItem * UpnpEventDispatcher_Requeue(UpnpEventDispatcher *thiz, UpnpEventQueue *queue, UpnpEventItem *item)
+{
+    if (queue->depth < thiz->depth)
+    {
+        item->next = queue->head;
+        queue->head = item;
+        if (queue->tail == NULL)
+        {
+            queue->tail = item;
+        }
+
+        queue->depth++;
+        thiz->stats.pending++;
+        return NULL;
+    }
+
+    do
+    {
+        UpnpEventBody *merged = UpnpEventBody_Merge(item->body, queue->head->body);
+        if (merged == NULL)
+        {
+            thiz->stats.dropped++;
+            break;
+        }
+
+        UpnpEventBody_Release(queue->head->body);
+        queue->head->body = merged;
+        queue->head->queued = item->queued;
+        thiz->stats.coalesced++;
+    } while (0);
+
+    return item;
+}
+
+static void UpnpEventDispatcher_DropItems(UpnpEventDispatcher *thiz, UpnpEventQueue *queue)
+{
+    while (queue->head != NULL)
+    {
+        UpnpEventItem *item = queue->head;
+        queue->head = item->next;
+
+        UpnpEventBody_Release(item->body);
+        tiny_free(item);
+    }
+
+    thiz->stats.pending -= queue->depth;
+    queue->tail = NULL;
+    queue->depth = 0;
+}
+
+static void UpnpEventDispatcher_FreeQueue(UpnpEventDispatcher *thiz, UpnpEventQueue *queue)
+{
+    UpnpEventDispatcher_DropItems(thiz, queue);
+
+    if (queue->prev == NULL)
+    {
+        thiz->queues = queue->next;
+    }
+    else
+    {
+        queue->prev->next = queue->next;
+    }
+
+    if (queue->next != NULL)
+    {
+        queue->next->prev = queue->prev;
+    }
+
+    if (queue->retryAt != 0)
+    {
+        thiz->backoffs--;
+    }
+
+    if (queue->dead)
+    {
+        thiz->deadCount--;
+    }
+
+    thiz->stats.queues--;
+    tiny_free(queue);
+}
+
+/**
+ * "http://192.168.1.2:4004/path" -> "192.168.1.2:4004"
+ */
+static void UpnpEventDispatcher_GetHost(const char *callback, char *host, uint32_t len)
+{
+    const char *p = strstr(callback, "://");
+    uint32_t i = 0;
+
+    p = (p == NULL) ? callback : p + 3;
+
+    for (i = 0; i < len - 1 && p[i] != 0 && p[i] != '/'; i++)
+    {
+        host[i] = p[i];
+    }
+
+    host[i] = 0;
+}
+
+static void UpnpEventConnection_Delete(UpnpEventConnection *thiz)
+{
+    UpnpHttpClient_Dispose(&thiz->client);
+    tiny_free(thiz);
+}
+
+static void UpnpEventConnection_DeleteAll(UpnpEventConnection *list)
+{
+    while (list != NULL)
+    {
+        UpnpEventConnection *next = list->next;
+        UpnpEventConnection_Delete(list);
+        list = next;
+    }
+}
+
+/**
+ * an idle connection to host, or a new one; expired idle ones are closed
+ */
+static UpnpEventConnection * UpnpEventDispatcher_Acquire(UpnpEventDispatcher *thiz, const char *host, uint64_t now)
+{
+    UpnpEventConnection *found = NULL;
+    UpnpEventConnection *expired = NULL;
+    UpnpEventConnection **link = NULL;
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    link = &thiz->idle;
+    while (*link != NULL)
+    {
+        UpnpEventConnection *c = *link;
+
+        if (now - c->idleSince > (uint64_t)UPNP_EVENT_KEEPALIVE * 1000)
+        {
+            *link = c->next;
+            c->next = expired;
+            expired = c;
+            thiz->idleCount--;
+            continue;
+        }
+
+        if (found == NULL && STR_EQUAL(c->host, host))
+        {
+            *link = c->next;
+            c->next = NULL;
+            found = c;
+            thiz->idleCount--;
+            thiz->stats.reused++;
+            continue;
+        }
+
+        link = &c->next;
+    }
+
+    if (found == NULL)
+    {
+        thiz->stats.connections++;
+    }
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    UpnpEventConnection_DeleteAll(expired);
+
+    if (found == NULL)
+    {
+        found = (UpnpEventConnection *)tiny_malloc(sizeof(UpnpEventConnection));
+        if (found == NULL)
+        {
+            return NULL;
+        }
+
+        memset(found, 0, sizeof(UpnpEventConnection));
+        strncpy(found->host, host, UPNP_EVENT_HOST_LEN - 1);
+
+        if (RET_FAILED(UpnpHttpClient_Construct(&found->client)))
+        {
+            tiny_free(found);
+            return NULL;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * parked if the peer kept it open and there is room, closed otherwise
+ */
+static void UpnpEventDispatcher_Park(UpnpEventDispatcher *thiz, UpnpEventConnection *connection, uint64_t now)
+{
+    bool parked = false;
+
+    if (HttpClient_IsConnected(connection->client.client))
+    {
+        TinyMutex_Lock(&thiz->mutex);
+
+        if (thiz->running && thiz->idleCount < UPNP_EVENT_IDLE_MAX)
+        {
+            connection->idleSince = now;
+            connection->next = thiz->idle;
+            thiz->idle = connection;
+            thiz->idleCount++;
+            parked = true;
+        }
+
+        TinyMutex_Unlock(&thiz->mutex);
+    }
+
+    if (!parked)
+    {
+        UpnpEventConnection_Delete(connection);
+    }
+}
+
+static uint64_t UpnpEventDispatcher_Backoff(uint32_t failures)
+{
+    uint64_t delay = UPNP_EVENT_BACKOFF;
+    uint32_t i = 1;
+
+    for (i = 1; i < failures && delay < UPNP_EVENT_BACKOFF_MAX; i++)
+    {
+        delay *= 2;
+    }
+
+    if (delay > UPNP_EVENT_BACKOFF_MAX)
+    {
+        delay = UPNP_EVENT_BACKOFF_MAX;
+    }
+
+    return delay * 1000;
+}
+
+TinyRet UpnpEventDispatcher_Construct(UpnpEventDispatcher *thiz, uint32_t workers, uint32_t depth)
+{
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    do
+    {
+        uint32_t i = 0;
+
+        memset(thiz, 0, sizeof(UpnpEventDispatcher));
+
+        thiz->depth = (depth > 0) ? depth : 1;
+        thiz->workerCount = (workers == 0) ? 1 : ((workers > UPNP_EVENT_DISPATCHER_MAX_WORKERS) ? UPNP_EVENT_DISPATCHER_MAX_WORKERS : workers);
+        thiz->retryLimit = (UPNP_EVENT_RETRY_WORKERS < thiz->workerCount) ? UPNP_EVENT_RETRY_WORKERS : thiz->workerCount;
+
+        ret = TinyMutex_Construct(&thiz->mutex);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyMutex_Construct failed");
+            break;
+        }
+
+        ret = TinySemaphore_Construct(&thiz->ready);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinySemaphore_Construct failed");
+            break;
+        }
+
+        for (i = 0; i < thiz->workerCount; i++)
+        {
+            thiz->workers[i].dispatcher = thiz;
+        }
+    } while (0);
+
+    return ret;
+}
+
+void UpnpEventDispatcher_Dispose(UpnpEventDispatcher *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    UpnpEventDispatcher_Stop(thiz);
+
+    while (thiz->queues != NULL)
+    {
+        UpnpEventDispatcher_FreeQueue(thiz, thiz->queues);
+    }
+
+    thiz->head = NULL;
+    thiz->tail = NULL;
+
+    UpnpEventConnection_DeleteAll(thiz->idle);
+    thiz->idle = NULL;
+    thiz->idleCount = 0;
+
+    TinySemaphore_Dispose(&thiz->ready);
+    TinyMutex_Dispose(&thiz->mutex);
+}
+
+TinyRet UpnpEventDispatcher_Start(UpnpEventDispatcher *thiz)
+{
+    TinyRet ret = TINY_RET_OK;
+    uint32_t i = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    if (thiz->running)
+    {
+        return TINY_RET_OK;
+    }
+
+    thiz->running = true;
+
+    for (i = 0; i < thiz->workerCount; i++)
+    {
+        ret = TinyThread_Construct(&thiz->workers[i].thread);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyThread_Construct failed");
+            break;
+        }
+
+        ret = TinyThread_Initialize(&thiz->workers[i].thread, worker_loop, &thiz->workers[i], "UpnpEventDispatcher");
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyThread_Initialize failed");
+            TinyThread_Dispose(&thiz->workers[i].thread);
+            break;
+        }
+
+        TinyThread_Start(&thiz->workers[i].thread);
+    }
+
+    if (RET_FAILED(ret))
+    {
+        uint32_t started = i;
+
+        TinyMutex_Lock(&thiz->mutex);
+        thiz->running = false;
+        TinyMutex_Unlock(&thiz->mutex);
+
+        for (i = 0; i < started; i++)
+        {
+            TinySemaphore_Post(&thiz->ready);
+        }
+
+        for (i = 0; i < started; i++)
+        {
+            TinyThread_Join(&thiz->workers[i].thread);
+            TinyThread_Dispose(&thiz->workers[i].thread);
+        }
+    }
+
+    return ret;
+}
+
+TinyRet UpnpEventDispatcher_Stop(UpnpEventDispatcher *thiz)
+{
+    uint32_t i = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    if (!thiz->running)
+    {
+        return TINY_RET_OK;
+    }
+
+    TinyMutex_Lock(&thiz->mutex);
+    thiz->running = false;
+    TinyMutex_Unlock(&thiz->mutex);
+
+    /**
+     * workers finish the NOTIFY in flight and leave; the rest stays queued
+     */
+    for (i = 0; i < thiz->workerCount; i++)
+    {
+        TinySemaphore_Post(&thiz->ready);
+    }
+
+    for (i = 0; i < thiz->workerCount; i++)
+    {
+        TinyThread_Join(&thiz->workers[i].thread);
+        TinyThread_Dispose(&thiz->workers[i].thread);
+    }
+
+    return TINY_RET_OK;
+}
+
+UpnpEventQueue * UpnpEventDispatcher_Open(UpnpEventDispatcher *thiz, const char *sid, const char *callback)
+{
+    UpnpEventQueue *queue = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+    RETURN_VAL_IF_FAIL(sid, NULL);
+    RETURN_VAL_IF_FAIL(callback, NULL);
+
+    queue = (UpnpEventQueue *)tiny_malloc(sizeof(UpnpEventQueue));
+    if (queue == NULL)
+    {
+        LOG_E(TAG, "tiny_malloc failed");
+        return NULL;
+    }
+
+    memset(queue, 0, sizeof(UpnpEventQueue));
+    strncpy(queue->sid, sid, UPNP_UUID_LEN - 1);
+    strncpy(queue->callback, callback, TINY_URL_LEN - 1);
+    UpnpEventDispatcher_GetHost(callback, queue->host, UPNP_EVENT_HOST_LEN);
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    queue->next = thiz->queues;
+    if (thiz->queues != NULL)
+    {
+        thiz->queues->prev = queue;
+    }
+
+    thiz->queues = queue;
+    thiz->stats.queues++;
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return queue;
+}
+
+void UpnpEventDispatcher_Close(UpnpEventDispatcher *thiz, UpnpEventQueue *queue)
+{
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(queue);
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    if (queue->ready)
+    {
+        UpnpEventDispatcher_RemoveReady(thiz, queue);
+    }
+
+    thiz->stats.dropped += queue->depth;
+    queue->closed = true;
+
+    if (queue->busy)
+    {
+        UpnpEventDispatcher_DropItems(thiz, queue);
+    }
+    else
+    {
+        UpnpEventDispatcher_FreeQueue(thiz, queue);
+    }
+
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+TinyRet UpnpEventDispatcher_Put(UpnpEventDispatcher *thiz, UpnpEventQueue *queue, UpnpEventBody *body)
+{
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(queue, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(body, TINY_RET_E_ARG_NULL);
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    do
+    {
+        uint64_t now = tiny_getusec();
+
+        if (queue->closed)
+        {
+            ret = TINY_RET_E_STOPPED;
+            break;
+        }
+
+        if (queue->dead)
+        {
+            thiz->stats.dropped++;
+            break;
+        }
+
+        if (queue->depth < thiz->depth)
+        {
+            UpnpEventItem *item = (UpnpEventItem *)tiny_malloc(sizeof(UpnpEventItem));
+            if (item == NULL)
+            {
+                thiz->stats.dropped++;
+                ret = TINY_RET_E_OUT_OF_MEMORY;
+                break;
+            }
+
+            item->next = NULL;
+            item->body = UpnpEventBody_Retain(body);
+            item->queued = now;
+
+            if (queue->tail == NULL)
+            {
+                queue->head = item;
+            }
+            else
+            {
+                queue->tail->next = item;
+            }
+
+            queue->tail = item;
+            queue->depth++;
+            thiz->stats.pending++;
+        }
+        else
+        {
+            /**
+             * full: fold the change into the last pending body, which keeps
+             * its enqueue time so the lag still counts from the oldest change
+             */
+            UpnpEventBody *merged = UpnpEventBody_Merge(queue->tail->body, body);
+            if (merged == NULL)
+            {
+                thiz->stats.dropped++;
+                ret = TINY_RET_E_OUT_OF_MEMORY;
+                break;
+            }
+
+            UpnpEventBody_Release(queue->tail->body);
+            queue->tail->body = merged;
+            thiz->stats.coalesced++;
+        }
+
+        UpnpEventDispatcher_Schedule(thiz, queue, now);
+    } while (0);
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return ret;
+}
+
+uint32_t UpnpEventDispatcher_Retry(UpnpEventDispatcher *thiz, uint64_t now)
+{
+    UpnpEventQueue *queue = NULL;
+    uint32_t dead = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, 0);
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    if (thiz->backoffs > 0)
+    {
+        for (queue = thiz->queues; queue != NULL; queue = queue->next)
+        {
+            if (queue->retryAt != 0)
+            {
+                UpnpEventDispatcher_Schedule(thiz, queue, now);
+            }
+        }
+    }
+
+    dead = thiz->deadCount;
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return dead;
+}
+
+bool UpnpEventDispatcher_IsDead(UpnpEventDispatcher *thiz, UpnpEventQueue *queue)
+{
+    bool dead = false;
+
+    RETURN_VAL_IF_FAIL(thiz, false);
+    RETURN_VAL_IF_FAIL(queue, false);
+
+    TinyMutex_Lock(&thiz->mutex);
+    dead = queue->dead;
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return dead;
+}
+
+void UpnpEventDispatcher_GetStats(UpnpEventDispatcher *thiz, UpnpEventDispatcherStats *stats)
+{
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(stats);
+
+    TinyMutex_Lock(&thiz->mutex);
+    memcpy(stats, &thiz->stats, sizeof(UpnpEventDispatcherStats));
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+static void worker_loop(void *param)
+{
+    UpnpEventWorker *worker = (UpnpEventWorker *)param;
+    UpnpEventDispatcher *thiz = worker->dispatcher;
+
+    while (true)
+    {
+        UpnpEventQueue *queue = NULL;
+        UpnpEventItem *item = NULL;
+        UpnpEventConnection *connection = NULL;
+        uint32_t seq = 0;
+        uint64_t now = 0;
+        bool retry = false;
+        TinyRet ret = TINY_RET_OK;
+
+        TinySemaphore_Wait(&thiz->ready);
+
+        TinyMutex_Lock(&thiz->mutex);
+
+        if (!thiz->running)
+        {
+            TinyMutex_Unlock(&thiz->mutex);
+            break;
+        }
+
+        queue = UpnpEventDispatcher_PopReady(thiz);
+        if (queue == NULL)
+        {
+            TinyMutex_Unlock(&thiz->mutex);
+            continue;
+        }
+
+        item = queue->head;
+        queue->head = item->next;
+        if (queue->head == NULL)
+        {
+            queue->tail = NULL;
+        }
+
+        queue->depth--;
+        thiz->stats.pending--;
+
+        /**
+         * SEQ counts messages actually sent: 0 first, wraps to 1
+         */
+        seq = queue->seq;
+        queue->seq = (seq == 0xFFFFFFFF) ? 1 : seq + 1;
+        queue->busy = true;
+
+        retry = (queue->failures > 0);
+        if (retry)
+        {
+            thiz->retrying++;
+        }
+
+        thiz->stats.inFlight++;
+        if (thiz->stats.inFlight > thiz->stats.maxInFlight)
+        {
+            thiz->stats.maxInFlight = thiz->stats.inFlight;
+        }
+
+        TinyMutex_Unlock(&thiz->mutex);
+
+        connection = UpnpEventDispatcher_Acquire(thiz, queue->host, tiny_getusec());
+        if (connection == NULL)
+        {
+            ret = TINY_RET_E_OUT_OF_MEMORY;
+        }
+        else
+        {
+            ret = UpnpHttpClient_NotifyBody(&connection->client, queue->callback, queue->sid, seq, item->body, UPNP_EVENT_TIMEOUT);
+        }
+
+        now = tiny_getusec();
+
+        if (connection != NULL)
+        {
+            UpnpEventDispatcher_Park(thiz, connection, now);
+        }
+
+        TinyMutex_Lock(&thiz->mutex);
+
+        queue->busy = false;
+        thiz->stats.inFlight--;
+
+        if (retry)
+        {
+            /**
+             * a queue passed over for the limit may be waiting: wake a worker
+             */
+            thiz->retrying--;
+            if (thiz->head != NULL)
+            {
+                TinySemaphore_Post(&thiz->ready);
+            }
+        }
+
+        if (RET_SUCCEEDED(ret))
+        {
+            uint64_t lag = now - item->queued;
+
+            if (queue->retryAt != 0)
+            {
+                thiz->backoffs--;
+            }
+
+            queue->failures = 0;
+            queue->retryAt = 0;
+            queue->lagUsec = lag;
+
+            thiz->stats.delivered++;
+            thiz->stats.totalLagUsec += lag;
+            if (lag > thiz->stats.maxLagUsec)
+            {
+                thiz->stats.maxLagUsec = lag;
+            }
+        }
+        else
+        {
+            /**
+             * back off: changes keep coalescing meanwhile, and the queue
+             * is offered again by a change or by Retry once retryAt passes
+             */
+            if (queue->retryAt == 0)
+            {
+                thiz->backoffs++;
+            }
+
+            queue->failures++;
+            queue->retryAt = now + UpnpEventDispatcher_Backoff(queue->failures);
+            queue->seq = seq;
+            thiz->stats.failed++;
+
+            if (queue->failures >= UPNP_EVENT_FAILURES_MAX)
+            {
+                LOG_E(TAG, "callback dead, dropping: %s", queue->callback);
+
+                thiz->stats.dropped += queue->depth + 1;
+                thiz->stats.dead++;
+                thiz->deadCount++;
+                queue->dead = true;
+                UpnpEventDispatcher_DropItems(thiz, queue);
+            }
+            else if (!queue->closed)
+            {
+                item = UpnpEventDispatcher_Requeue(thiz, queue, item);
+            }
+
+            LOG_D(TAG, "NOTIFY failed: %s (%d times)", queue->callback, queue->failures);
+        }
+
+        if (queue->closed)
+        {
+            UpnpEventDispatcher_FreeQueue(thiz, queue);
+        }
+        else
+        {
+            UpnpEventDispatcher_Schedule(thiz, queue, now);
+        }
+
+        TinyMutex_Unlock(&thiz->mutex);
+
+        if (item != NULL)
+        {
+            UpnpEventBody_Release(item->body);
+            tiny_free(item);
+        }
+    }
+}
@@ -0,0 +1,152 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpEventDispatcher.h
+*
+* @remark
+*
+*/
+
+#ifndef __UPNP_EVENT_DISPATCHER_H__
+#define __UPNP_EVENT_DISPATCHER_H__
+
+#include "tiny_base.h"
+#include "TinyMutex.h"
+#include "TinySemaphore.h"
+#include "TinyThread.h"
+#include "upnp_define.h"
+#include "UpnpHttpClient.h"
+#include "message/EventBody.h"
+
+TINY_BEGIN_DECLS
+
+
+#define UPNP_EVENT_DISPATCHER_MAX_WORKERS   64
+#define UPNP_EVENT_HOST_LEN                 64
+
+typedef struct _UpnpEventItem
+{
+    struct _UpnpEventItem     * next;
+    UpnpEventBody             * body;
+    uint64_t                    queued;
+} UpnpEventItem;
+
+/**
+ * Pending NOTIFYs of one subscriber. At most one of them is in flight, so
+ * a dead callback only ever holds one worker; once the queue is full new
+ * changes are merged into its last body instead of growing it. After
+ * UPNP_EVENT_FAILURES_MAX failures in a row the queue is dead: nothing
+ * more is sent and the subscriber is to be dropped.
+ */
+typedef struct _UpnpEventQueue
+{
+    struct _UpnpEventQueue    * prev;
+    struct _UpnpEventQueue    * next;
+    struct _UpnpEventQueue    * nextReady;
+    char                        sid[UPNP_UUID_LEN];
+    char                        callback[TINY_URL_LEN];
+    char                        host[UPNP_EVENT_HOST_LEN];
+    uint32_t                    seq;
+    UpnpEventItem             * head;
+    UpnpEventItem             * tail;
+    uint32_t                    depth;
+    bool                        busy;
+    bool                        ready;
+    bool                        closed;
+    bool                        dead;
+    uint32_t                    failures;
+    uint64_t                    retryAt;
+    uint64_t                    lagUsec;
+} UpnpEventQueue;
+
+/**
+ * A keep-alive connection to one callback host, parked between NOTIFYs.
+ */
+typedef struct _UpnpEventConnection
+{
+    struct _UpnpEventConnection   * next;
+    char                            host[UPNP_EVENT_HOST_LEN];
+    uint64_t                        idleSince;
+    UpnpHttpClient                  client;
+} UpnpEventConnection;
+
+typedef struct _UpnpEventDispatcherStats
+{
+    uint32_t                    queues;
+    uint32_t                    pending;
+    uint32_t                    inFlight;
+    uint32_t                    maxInFlight;
+    uint32_t                    connections;
+    uint32_t                    reused;
+    uint32_t                    delivered;
+    uint32_t                    failed;
+    uint32_t                    coalesced;
+    uint32_t                    dropped;
+    uint32_t                    dead;
+    uint64_t                    totalLagUsec;
+    uint64_t                    maxLagUsec;
+} UpnpEventDispatcherStats;
+
+struct _UpnpEventDispatcher;
+
+typedef struct _UpnpEventWorker
+{
+    struct _UpnpEventDispatcher   * dispatcher;
+    TinyThread                      thread;
+} UpnpEventWorker;
+
+typedef struct _UpnpEventDispatcher
+{
+    bool                        running;
+    TinyMutex                   mutex;
+    TinySemaphore               ready;
+    UpnpEventQueue            * queues;
+    UpnpEventQueue            * head;
+    UpnpEventQueue            * tail;
+    UpnpEventConnection       * idle;
+    uint32_t                    idleCount;
+    uint32_t                    depth;
+    uint32_t                    backoffs;
+    uint32_t                    retrying;
+    uint32_t                    retryLimit;
+    uint32_t                    deadCount;
+    uint32_t                    workerCount;
+    UpnpEventWorker             workers[UPNP_EVENT_DISPATCHER_MAX_WORKERS];
+    UpnpEventDispatcherStats    stats;
+} UpnpEventDispatcher;
+
+/**
+ * workers bounds the NOTIFYs in flight at once, one per subscriber at most;
+ * no more than UPNP_EVENT_RETRY_WORKERS of them go to callbacks that failed
+ */
+TinyRet UpnpEventDispatcher_Construct(UpnpEventDispatcher *thiz, uint32_t workers, uint32_t depth);
+void UpnpEventDispatcher_Dispose(UpnpEventDispatcher *thiz);
+
+TinyRet UpnpEventDispatcher_Start(UpnpEventDispatcher *thiz);
+TinyRet UpnpEventDispatcher_Stop(UpnpEventDispatcher *thiz);
+
+/**
+ * Closing drops what is still pending; a NOTIFY in flight completes and
+ * its worker frees the queue.
+ */
+UpnpEventQueue * UpnpEventDispatcher_Open(UpnpEventDispatcher *thiz, const char *sid, const char *callback);
+void UpnpEventDispatcher_Close(UpnpEventDispatcher *thiz, UpnpEventQueue *queue);
+
+TinyRet UpnpEventDispatcher_Put(UpnpEventDispatcher *thiz, UpnpEventQueue *queue, UpnpEventBody *body);
+
+/**
+ * Offers again the queues whose backoff is over; called periodically so
+ * what is pending goes out even if nothing changes any more. Returns the
+ * number of dead queues not closed yet.
+ */
+uint32_t UpnpEventDispatcher_Retry(UpnpEventDispatcher *thiz, uint64_t now);
+bool UpnpEventDispatcher_IsDead(UpnpEventDispatcher *thiz, UpnpEventQueue *queue);
+void UpnpEventDispatcher_GetStats(UpnpEventDispatcher *thiz, UpnpEventDispatcherStats *stats);
+
+
+TINY_END_DECLS
+
+#endif /* __UPNP_EVENT_DISPATCHER_H__ */
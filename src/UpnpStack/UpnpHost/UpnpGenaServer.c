@@ -15,62 +15,363 @@
 #include "UpnpGenaServer.h"
 #include "tiny_memory.h"
 #include "tiny_log.h"
+#include "tiny_time.h"
+#include "TinyUuid.h"
+#include "upnp_define.h"
 #include "UpnpSubscriber.h"
+#include "message/EventBody.h"
 
-#define TAG     "UpnpGenaServer"
+#define TAG                     "UpnpGenaServer"
 
-static void OnNotifyJobDelete(TinyWorker *worker, void *job, void *ctx)
+#define GENA_TIMER_INTERVAL     (100 * 1000)
+#define LEASE_NONE              ((uint64_t)-1)
+
+/**
+ * one sweep over the subscribers, collecting the next expiry
+ */
+typedef struct _UpnpLeaseSweep
+{
+    UpnpGenaServer            * server;
+    uint64_t                    now;
+    uint64_t                    next;
+} UpnpLeaseSweep;
+
+/**
+ * A service with changes held back by moderation, evented again at dueAt.
+ */
+typedef struct _UpnpModeratedService
+{
+    struct _UpnpModeratedService  * next;
+    UpnpService                   * service;
+    uint64_t                        dueAt;
+} UpnpModeratedService;
+
+static bool UpnpGenaServer_GetNumber(DataValue *value, double *number)
 {
-    UpnpEvent * e = (UpnpEvent *)job;
-    UpnpEvent_Delete(e);
+    switch (value->internalType)
+    {
+    case INTERNAL_BYTE:
+        *number = value->internalValue.byteValue;
+        return true;
+
+    case INTERNAL_WORD:
+        *number = value->internalValue.wordValue;
+        return true;
+
+    case INTERNAL_INTEGER:
+        *number = value->internalValue.integerValue;
+        return true;
+
+    case INTERNAL_LONG:
+        *number = (double)value->internalValue.longValue;
+        return true;
+
+    case INTERNAL_FLOAT:
+        *number = value->internalValue.floatValue;
+        return true;
+
+    case INTERNAL_DOUBLE:
+        *number = value->internalValue.doubleValue;
+        return true;
+
+    default:
+        return false;
+    }
 }
 
-static bool DoNotify(TinyWorker *worker, void *job, void *ctx)
+/**
+ * Whether a changed variable may be evented now. One held by maximumRate
+ * stays changed and lowers *dueAt to when its window closes; one held by
+ * minimumDelta waits for a change that moves it far enough.
+ */
+static bool UpnpGenaServer_IsDue(UpnpStateVariable *v, uint64_t now, uint64_t *dueAt)
 {
-    UpnpGenaServer *thiz = (UpnpGenaServer *)ctx;
-    UpnpEvent * event = (UpnpEvent *)job;
+    double number = 0;
+
+    if (v->eventedAt == 0)
+    {
+        return true;
+    }
 
-    if (UpnpEvent_GetArgumentCount(event) > 0)
+    if (v->definition.maximumRate > 0)
     {
-        UpnpHttpClient_Notify(&thiz->http->client, event);
+        uint64_t at = v->eventedAt + (uint64_t)v->definition.maximumRate * 1000;
+        if (now < at)
+        {
+            if (at < *dueAt)
+            {
+                *dueAt = at;
+            }
+
+            return false;
+        }
     }
 
-    UpnpEvent_Delete(event);
+    if (v->definition.minimumDelta > 0 && UpnpGenaServer_GetNumber(&v->value, &number))
+    {
+        double delta = number - v->eventedValue;
+        if (delta < 0)
+        {
+            delta = -delta;
+        }
+
+        if (delta < v->definition.minimumDelta)
+        {
+            return false;
+        }
+    }
 
     return true;
 }
 
-static void OnSubscribe(UpnpHttpConnection *conn, const char *uri, const char *callback, const char *nt, uint32_t timeout, void *ctx)
+static UpnpEventBody * UpnpGenaServer_FinishBody(UpnpEventBody *body)
 {
-    UpnpGenaServer *thiz = (UpnpGenaServer *)ctx;
+    if (UpnpEventBody_GetPropertyCount(body) == 0 || RET_FAILED(UpnpEventBody_Finish(body)))
+    {
+        UpnpEventBody_Release(body);
+        body = NULL;
+    }
 
-    LOG_D(TAG, "OnSubscribe: %s", uri);
+    return body;
+}
 
-    UpnpProvider_Lock(thiz->provider);
+/**
+ * serialized once here, then shared by every subscriber's job.
+ * NULL if nothing is to be sent. Every evented variable, for the
+ * initial event of a new subscriber.
+ */
+static UpnpEventBody * UpnpGenaServer_RenderBody(UpnpService *service)
+{
+    UpnpEventBody *body = NULL;
+    uint32_t count = 0;
+    uint32_t i = 0;
 
-    do
+    body = UpnpEventBody_New();
+    if (body == NULL)
+    {
+        LOG_E(TAG, "UpnpEventBody_New failed");
+        return NULL;
+    }
+
+    count = UpnpService_GetStateVariableCount(service);
+    for (i = 0; i < count; ++i)
+    {
+        UpnpStateVariable *v = (UpnpStateVariable *)UpnpService_GetStateVariableAt(service, i);
+        if (v->sendEvents)
+        {
+            UpnpEventBody_AddValue(body, v->definition.name, &v->value);
+        }
+    }
+
+    return UpnpGenaServer_FinishBody(body);
+}
+
+typedef struct _UpnpChangeCapture
+{
+    UpnpService               * service;
+    UpnpEventBody             * body;
+    uint64_t                    now;
+    uint64_t                    dueAt;
+} UpnpChangeCapture;
+
+/**
+ * a variable held back by moderation is marked changed again
+ */
+static void OnChangedVisit(UpnpStateVariable *v, void *ctx)
+{
+    UpnpChangeCapture *capture = (UpnpChangeCapture *)ctx;
+
+    if (!v->sendEvents)
+    {
+        return;
+    }
+
+    if (!UpnpGenaServer_IsDue(v, capture->now, &capture->dueAt))
+    {
+        UpnpService_SetChanged(capture->service, v);
+        return;
+    }
+
+    UpnpEventBody_AddValue(capture->body, v->definition.name, &v->value);
+    v->eventedAt = capture->now;
+    UpnpGenaServer_GetNumber(&v->value, &v->eventedValue);
+}
+
+/**
+ * Only the variables marked changed since the last capture; dueAt gets
+ * the time the earliest one held back may go.
+ */
+static UpnpEventBody * UpnpGenaServer_RenderChanges(UpnpService *service, uint64_t now, uint64_t *dueAt)
+{
+    UpnpChangeCapture capture;
+
+    capture.body = UpnpEventBody_New();
+    if (capture.body == NULL)
+    {
+        LOG_E(TAG, "UpnpEventBody_New failed");
+        return NULL;
+    }
+
+    capture.service = service;
+    capture.now = now;
+    capture.dueAt = *dueAt;
+
+    UpnpService_TakeChanged(service, OnChangedVisit, &capture);
+
+    *dueAt = capture.dueAt;
+
+    return UpnpGenaServer_FinishBody(capture.body);
+}
+
+static void UpnpGenaServer_PutJob(UpnpGenaServer *thiz, UpnpEventBody *body, UpnpSubscriber *subscriber)
+{
+    UpnpEventQueue *queue = (UpnpEventQueue *)UpnpSubscriber_GetQueue(subscriber);
+    if (queue == NULL)
+    {
+        return;
+    }
+
+    if (RET_FAILED(UpnpEventDispatcher_Put(&thiz->dispatcher, queue, body)))
+    {
+        LOG_E(TAG, "UpnpEventDispatcher_Put failed: %s", UpnpSubscriber_GetCallback(subscriber));
+    }
+}
+
+static void UpnpGenaServer_CloseQueue(UpnpGenaServer *thiz, UpnpSubscriber *subscriber)
+{
+    UpnpEventQueue *queue = (UpnpEventQueue *)UpnpSubscriber_GetQueue(subscriber);
+    if (queue != NULL)
+    {
+        UpnpSubscriber_SetQueue(subscriber, NULL);
+        UpnpEventDispatcher_Close(&thiz->dispatcher, queue);
+    }
+}
+
+static void UpnpGenaServer_CloseQueues(UpnpGenaServer *thiz, UpnpDevice *device)
+{
+    uint32_t count = UpnpDevice_GetServiceCount(device);
+    uint32_t i = 0;
+
+    for (i = 0; i < count; ++i)
+    {
+        UpnpService *service = UpnpDevice_GetServiceAt(device, i);
+        uint32_t n = 0;
+        uint32_t j = 0;
+
+        UpnpService_Lock(service);
+        TinyMutex_Lock(&thiz->eventMutex);
+
+        n = UpnpService_GetSubscriberCount(service);
+        for (j = 0; j < n; ++j)
+        {
+            UpnpGenaServer_CloseQueue(thiz, UpnpService_GetSubscriberAt(service, j));
+        }
+
+        TinyMutex_Unlock(&thiz->eventMutex);
+        UpnpService_Unlock(service);
+
+        TinyMutex_Lock(&thiz->leaseMutex);
+        thiz->leases.active = (thiz->leases.active > n) ? thiz->leases.active - n : 0;
+        TinyMutex_Unlock(&thiz->leaseMutex);
+    }
+}
+
+/**
+ * the granted duration: what was asked for, capped; infinite is not granted
+ */
+static uint32_t UpnpGenaServer_GrantTimeout(uint32_t timeout)
+{
+    return (timeout == 0 || timeout > UPNP_SUBSCRIPTION_TIMEOUT) ? UPNP_SUBSCRIPTION_TIMEOUT : timeout;
+}
+
+static void UpnpGenaServer_Lease(UpnpGenaServer *thiz, UpnpSubscriber *subscriber, uint32_t timeout, bool renewal)
+{
+    uint64_t expireAt = tiny_getusec() + (uint64_t)timeout * 1000 * 1000;
+
+    UpnpSubscriber_SetTimeout(subscriber, timeout);
+    UpnpSubscriber_SetExpireAt(subscriber, expireAt);
+
+    TinyMutex_Lock(&thiz->leaseMutex);
+
+    if (renewal)
     {
         /**
-         * add subscriber
+         * a renewal only pushes the expiry out: nextExpiry stays a lower bound
          */
-        UpnpService *service = UpnpProvider_GetService(thiz->provider, uri);
-        if (service == NULL)
+        thiz->leases.renewed++;
+    }
+    else
+    {
+        thiz->leases.active++;
+        if (expireAt < thiz->nextExpiry)
+        {
+            thiz->nextExpiry = expireAt;
+        }
+    }
+
+    TinyMutex_Unlock(&thiz->leaseMutex);
+}
+
+static TinyRet UpnpGenaServer_NewSid(char *sid, uint32_t len)
+{
+    TinyRet ret = TINY_RET_OK;
+    TinyUuid uuid;
+
+    do
+    {
+        ret = TinyUuid_Construct(&uuid);
+        if (RET_FAILED(ret))
         {
-            UpnpHttpConnection_SendError(conn, 404, "NOT FOUND");
             break;
         }
 
-        if (RET_FAILED(UpnpService_GetSubscriber(service, callback)))
+        ret = TinyUuid_GenerateRandom(&uuid);
+        if (RET_SUCCEEDED(ret))
+        {
+            tiny_snprintf(sid, len, "uuid:%s", TinyUuid_ToString(&uuid, false));
+        }
+
+        TinyUuid_Dispose(&uuid);
+    } while (0);
+
+    return ret;
+}
+
+static void UpnpGenaServer_Subscribe(UpnpGenaServer *thiz, UpnpHttpConnection *conn, UpnpService *service, const char *callback, uint32_t timeout)
+{
+    do
+    {
+        if (UpnpService_GetSubscriber(service, callback) != NULL)
         {
             UpnpHttpConnection_SendError(conn, 404, "ALREADY SUBSCRIBED");
             break;
         }
 
-        UpnpSubscriber *subscriber = UpnpSubscriber_New();
+        UpnpSubscriber *subscriber = NULL;
+        char sid[UPNP_UUID_LEN];
+
+        memset(sid, 0, UPNP_UUID_LEN);
+        if (RET_FAILED(UpnpGenaServer_NewSid(sid, UPNP_UUID_LEN)))
+        {
+            UpnpHttpConnection_SendError(conn, 500, "INTERNAL SERVER ERROR");
+            break;
+        }
+
+        subscriber = UpnpSubscriber_New();
+        if (subscriber == NULL)
+        {
+            UpnpHttpConnection_SendError(conn, 500, "INTERNAL SERVER ERROR");
+            break;
+        }
+
         UpnpSubscriber_SetCallback(subscriber, callback);
-        UpnpSubscriber_SetTimeout(subscriber, timeout);
-        UpnpSubscriber_SetSid(subscriber, "uuid:xxxxx");
+        UpnpSubscriber_SetSid(subscriber, sid);
+        UpnpSubscriber_SetQueue(subscriber, UpnpEventDispatcher_Open(&thiz->dispatcher, sid, callback));
+        UpnpGenaServer_Lease(thiz, subscriber, UpnpGenaServer_GrantTimeout(timeout), false);
+
+        TinyMutex_Lock(&thiz->eventMutex);
         UpnpService_AddSubscriber(service, subscriber);
+        TinyMutex_Unlock(&thiz->eventMutex);
 
         /**
          * send response
@@ -80,63 +381,72 @@ static void OnSubscribe(UpnpHttpConnection *conn, const char *uri, const char *c
             UpnpSubscriber_GetTimeout(subscriber));
 
         /**
-         * send NOTIFY
+         * send NOTIFY: initial event with every evented variable
          */
         do
         {
-            uint32_t i = 0;
-            uint32_t count = 0;
-            UpnpEvent *event = NULL;
-
-            event = UpnpEvent_New();
-            if (event == NULL)
+            UpnpEventBody *body = UpnpGenaServer_RenderBody(service);
+            if (body == NULL)
             {
-                LOG_E(TAG, "UpnpEvent_New failed");
                 break;
             }
 
-            UpnpEvent_SetCallback(event, callback);
-            UpnpEvent_SetConnection(event, "Close");
-            UpnpEvent_SetNt(event, "upnp:event");
-            UpnpEvent_SetNts(event, "upnp:propchange");
-            UpnpEvent_SetSeq(event, "0");
-            UpnpEvent_SetSid(event, UpnpSubscriber_GetSid(subscriber));
+            UpnpGenaServer_PutJob(thiz, body, subscriber);
+            UpnpEventBody_Release(body);
+        } while (0);
 
-            count = UpnpService_GetStateVariableCount(service);
-            for (i = 0; i < count; ++i)
-            {
-                UpnpStateVariable *v = (UpnpStateVariable *)UpnpService_GetStateVariableAt(service, i);
-                if (v->sendEvents)
-                {
-                    const char *value = NULL;
-                    char buffer[128];
-
-                    memset(buffer, 0, 128);
-                    value = buffer;
-
-                    if (v->value.internalType == INTERNAL_STRING)
-                    {
-                        value = v->value.internalValue.stringValue;
-                    }
-                    else
-                    {
-                        if (RET_FAILED(DataValue_GetValue(&v->value, buffer, 128)))
-                        {
-                            LOG_E(TAG, "value invalid: %s", v->definition.name);
-                            break;
-                        }
-                    }
-
-                    UpnpEvent_SetArgumentValue(event, v->definition.name, value);
-                }
-            }
+    } while (0);
+}
 
-            TinyWorker_PutJob(&thiz->notifyWorker, event);
-        } while (0);
+static void UpnpGenaServer_Renew(UpnpGenaServer *thiz, UpnpHttpConnection *conn, UpnpService *service, const char *sid, uint32_t timeout)
+{
+    UpnpSubscriber *subscriber = UpnpService_GetSubscriberBySid(service, sid);
+    if (subscriber == NULL)
+    {
+        UpnpHttpConnection_SendError(conn, 412, "PRECONDITION FAILED");
+        return;
+    }
+
+    UpnpGenaServer_Lease(thiz, subscriber, UpnpGenaServer_GrantTimeout(timeout), true);
+
+    UpnpHttpConnection_SendSubscribeResponse(conn, sid, UpnpSubscriber_GetTimeout(subscriber));
+}
+
+static void OnSubscribe(UpnpHttpConnection *conn, const char *uri, const char *callback, const char *sid, const char *nt, uint32_t timeout, void *ctx)
+{
+    UpnpGenaServer *thiz = (UpnpGenaServer *)ctx;
+
+    LOG_D(TAG, "OnSubscribe: %s", uri);
+
+    UpnpProvider_ReadLock(thiz->provider);
+
+    do
+    {
+        /**
+         * add subscriber
+         */
+        UpnpService *service = UpnpProvider_GetService(thiz->provider, uri);
+        if (service == NULL)
+        {
+            UpnpHttpConnection_SendError(conn, 404, "NOT FOUND");
+            break;
+        }
+
+        UpnpService_Lock(service);
 
+        if (sid != NULL)
+        {
+            UpnpGenaServer_Renew(thiz, conn, service, sid, timeout);
+        }
+        else
+        {
+            UpnpGenaServer_Subscribe(thiz, conn, service, callback, timeout);
+        }
+
+        UpnpService_Unlock(service);
     } while (0);
 
-    UpnpProvider_Unlock(thiz->provider);
+    UpnpProvider_ReadUnlock(thiz->provider);
 }
 
 static void OnUnsubscribe(UpnpHttpConnection *conn, const char *uri, const char *sid, void *ctx)
@@ -145,10 +455,12 @@ static void OnUnsubscribe(UpnpHttpConnection *conn, const char *uri, const char
 
     LOG_D(TAG, "OnUnsubscribe: %s", uri);
 
-    UpnpProvider_Lock(thiz->provider);
+    UpnpProvider_ReadLock(thiz->provider);
 
     do
     {
+        TinyRet ret = TINY_RET_OK;
+
         /**
          * remove subscriber
          */
@@ -159,7 +471,33 @@ static void OnUnsubscribe(UpnpHttpConnection *conn, const char *uri, const char
             break;
         }
 
-        if (RET_FAILED(UpnpService_RemoveSubscriber(service, sid)))
+        UpnpService_Lock(service);
+
+        do
+        {
+            UpnpSubscriber *subscriber = UpnpService_GetSubscriberBySid(service, sid);
+            if (subscriber == NULL)
+            {
+                ret = TINY_RET_E_NOT_FOUND;
+                break;
+            }
+
+            TinyMutex_Lock(&thiz->eventMutex);
+            UpnpGenaServer_CloseQueue(thiz, subscriber);
+            ret = UpnpService_RemoveSubscriber(service, sid);
+            TinyMutex_Unlock(&thiz->eventMutex);
+        } while (0);
+
+        UpnpService_Unlock(service);
+
+        if (RET_SUCCEEDED(ret))
+        {
+            TinyMutex_Lock(&thiz->leaseMutex);
+            thiz->leases.active--;
+            TinyMutex_Unlock(&thiz->leaseMutex);
+        }
+
+        if (RET_FAILED(ret))
         {
             UpnpHttpConnection_SendError(conn, 404, "NOT SUBSCRIBED");
             break;
@@ -171,7 +509,88 @@ static void OnUnsubscribe(UpnpHttpConnection *conn, const char *uri, const char
         UpnpHttpConnection_SendOk(conn);
     } while (0);
 
-    UpnpProvider_Unlock(thiz->provider);
+    UpnpProvider_ReadUnlock(thiz->provider);
+}
+
+/**
+ * a service held back is kept once, at its earliest due time
+ */
+static void UpnpGenaServer_Hold(UpnpGenaServer *thiz, UpnpService *service, uint64_t dueAt)
+{
+    UpnpModeratedService *held = NULL;
+
+    for (held = thiz->held; held != NULL; held = held->next)
+    {
+        if (held->service == service)
+        {
+            if (dueAt < held->dueAt)
+            {
+                held->dueAt = dueAt;
+            }
+
+            return;
+        }
+    }
+
+    held = (UpnpModeratedService *)tiny_malloc(sizeof(UpnpModeratedService));
+    if (held == NULL)
+    {
+        LOG_E(TAG, "tiny_malloc failed");
+        return;
+    }
+
+    held->service = service;
+    held->dueAt = dueAt;
+    held->next = thiz->held;
+    thiz->held = held;
+}
+
+static void UpnpGenaServer_Release(UpnpGenaServer *thiz, UpnpService *service)
+{
+    UpnpModeratedService **link = &thiz->held;
+
+    while (*link != NULL)
+    {
+        UpnpModeratedService *held = *link;
+        if (held->service == service)
+        {
+            *link = held->next;
+            tiny_free(held);
+            break;
+        }
+
+        link = &held->next;
+    }
+}
+
+/**
+ * Service lock and eventMutex held. The subscribers are only added and
+ * removed under both, so the walk below is safe from either side; the
+ * values are read under the service lock actions write them with.
+ */
+static void UpnpGenaServer_Notify(UpnpGenaServer *thiz, UpnpService *service)
+{
+    uint64_t dueAt = LEASE_NONE;
+    UpnpEventBody *body = NULL;
+
+    body = UpnpGenaServer_RenderChanges(service, tiny_getusec(), &dueAt);
+    if (body != NULL)
+    {
+        uint32_t count = UpnpService_GetSubscriberCount(service);
+        uint32_t i = 0;
+
+        for (i = 0; i < count; ++i)
+        {
+            UpnpGenaServer_PutJob(thiz, body, (UpnpSubscriber *)UpnpService_GetSubscriberAt(service, i));
+        }
+
+        UpnpEventBody_Release(body);
+    }
+
+    if (dueAt != LEASE_NONE)
+    {
+        UpnpGenaServer_Hold(thiz, service, dueAt);
+    }
 }
 
 static void OnServiceChanged(UpnpService *service, void *ctx)
@@ -180,71 +599,220 @@ static void OnServiceChanged(UpnpService *service, void *ctx)
 
     LOG_D(TAG, "OnServiceChanged");
 
-    do
-    {
-        uint32_t i = 0;
-        uint32_t count = 0;
-        UpnpEvent *event = NULL;
+    TinyMutex_Lock(&thiz->eventMutex);
+    UpnpGenaServer_Notify(thiz, service);
+    TinyMutex_Unlock(&thiz->eventMutex);
+}
 
-        event = UpnpEvent_New();
-        if (event == NULL)
+/**
+ * the first service held back whose window closed, no longer held
+ */
+static UpnpService * UpnpGenaServer_TakeDue(UpnpGenaServer *thiz, uint64_t now)
+{
+    UpnpModeratedService *held = NULL;
+    UpnpService *service = NULL;
+
+    TinyMutex_Lock(&thiz->eventMutex);
+
+    for (held = thiz->held; held != NULL; held = held->next)
+    {
+        if (held->dueAt <= now)
         {
-            LOG_E(TAG, "UpnpEvent_New failed");
+            service = held->service;
+            UpnpGenaServer_Release(thiz, service);
             break;
         }
+    }
+
+    TinyMutex_Unlock(&thiz->eventMutex);
+
+    return service;
+}
+
+/**
+ * Services whose moderation window closed get their latest values out.
+ * The provider read lock keeps them from being removed meanwhile; the
+ * service lock is taken first, as on the path from an action handler.
+ */
+static void UpnpGenaServer_Flush(UpnpGenaServer *thiz, uint64_t now)
+{
+    UpnpService *service = NULL;
+    bool held = false;
+
+    TinyMutex_Lock(&thiz->eventMutex);
+    held = (thiz->held != NULL);
+    TinyMutex_Unlock(&thiz->eventMutex);
+
+    if (!held)
+    {
+        return;
+    }
+
+    UpnpProvider_ReadLock(thiz->provider);
+
+    while ((service = UpnpGenaServer_TakeDue(thiz, now)) != NULL)
+    {
+        UpnpService_Lock(service);
+        TinyMutex_Lock(&thiz->eventMutex);
+        UpnpGenaServer_Notify(thiz, service);
+        TinyMutex_Unlock(&thiz->eventMutex);
+        UpnpService_Unlock(service);
+    }
+
+    UpnpProvider_ReadUnlock(thiz->provider);
+}
+
+static void OnDeviceRemoved(UpnpDevice *device, void *ctx)
+{
+    UpnpGenaServer *thiz = (UpnpGenaServer *)ctx;
 
-        UpnpEvent_SetConnection(event, "Close");
-        UpnpEvent_SetNt(event, "upnp:event");
-        UpnpEvent_SetNts(event, "upnp:propchange");
-        UpnpEvent_SetSeq(event, "0");
+    LOG_D(TAG, "OnDeviceRemoved");
+
+    UpnpGenaServer_CloseQueues(thiz, device);
+
+    TinyMutex_Lock(&thiz->eventMutex);
+
+    do
+    {
+        uint32_t count = UpnpDevice_GetServiceCount(device);
+        uint32_t i = 0;
 
-        count = UpnpService_GetStateVariableCount(service);
         for (i = 0; i < count; ++i)
         {
-            UpnpStateVariable *v = (UpnpStateVariable *)UpnpService_GetStateVariableAt(service, i);
-            if (v->sendEvents && v->isChanged)
-            {
-                const char *value = NULL;
-                char buffer[128];
+            UpnpGenaServer_Release(thiz, UpnpDevice_GetServiceAt(device, i));
+        }
+    } while (0);
 
-                memset(buffer, 0, 128);
-                value = buffer;
+    TinyMutex_Unlock(&thiz->eventMutex);
+}
 
-                if (v->value.internalType == INTERNAL_STRING)
-                {
-                    value = v->value.internalValue.stringValue;
-                }
-                else
+static void OnDeviceVisit(UpnpDevice *device, void *ctx)
+{
+    UpnpGenaServer_CloseQueues((UpnpGenaServer *)ctx, device);
+}
+
+static void OnLeaseVisit(UpnpDevice *device, void *ctx)
+{
+    UpnpLeaseSweep *sweep = (UpnpLeaseSweep *)ctx;
+    uint32_t count = UpnpDevice_GetServiceCount(device);
+    uint32_t i = 0;
+
+    for (i = 0; i < count; ++i)
+    {
+        UpnpService *service = UpnpDevice_GetServiceAt(device, i);
+        uint32_t expired = 0;
+        uint32_t dropped = 0;
+        uint32_t j = 0;
+
+        UpnpService_Lock(service);
+
+        for (j = UpnpService_GetSubscriberCount(service); j > 0; --j)
+        {
+            UpnpSubscriber *subscriber = UpnpService_GetSubscriberAt(service, j - 1);
+            UpnpEventQueue *queue = (UpnpEventQueue *)UpnpSubscriber_GetQueue(subscriber);
+            uint64_t expireAt = UpnpSubscriber_GetExpireAt(subscriber);
+
+            if (queue != NULL && UpnpEventDispatcher_IsDead(&sweep->server->dispatcher, queue))
+            {
+                LOG_D(TAG, "subscription dropped: %s", UpnpSubscriber_GetSid(subscriber));
+                dropped++;
+            }
+            else if (expireAt > sweep->now)
+            {
+                if (expireAt < sweep->next)
                 {
-                    if (RET_FAILED(DataValue_GetValue(&v->value, buffer, 128)))
-                    {
-                        LOG_E(TAG, "value invalid: %s", v->definition.name);
-                        break;
-                    }
+                    sweep->next = expireAt;
                 }
 
-                UpnpEvent_SetArgumentValue(event, v->definition.name, value);
+                continue;
+            }
+            else
+            {
+                LOG_D(TAG, "subscription expired: %s", UpnpSubscriber_GetSid(subscriber));
+                expired++;
             }
+
+            TinyMutex_Lock(&sweep->server->eventMutex);
+            UpnpGenaServer_CloseQueue(sweep->server, subscriber);
+            UpnpService_RemoveSubscriber(service, UpnpSubscriber_GetSid(subscriber));
+            TinyMutex_Unlock(&sweep->server->eventMutex);
         }
 
-        if (UpnpEvent_GetArgumentCount(event) > 0)
+        UpnpService_Unlock(service);
+
+        if (expired > 0 || dropped > 0)
         {
-            count = UpnpService_GetSubscriberCount(service);
-            for (i = 0; i < count; ++i)
-            {
-                UpnpEvent *job = NULL;
-                UpnpSubscriber *s = (UpnpSubscriber *)UpnpService_GetSubscriberAt(service, i);
-                UpnpEvent_SetCallback(event, UpnpSubscriber_GetCallback(s));
-                UpnpEvent_SetSid(event, UpnpSubscriber_GetSid(s));
-
-                job = UpnpEvent_New();
-                UpnpEvent_Copy(job, event);
-                TinyWorker_PutJob(&thiz->notifyWorker, job);
-            }
+            TinyMutex_Lock(&sweep->server->leaseMutex);
+            sweep->server->leases.expired += expired;
+            sweep->server->leases.dropped += dropped;
+            sweep->server->leases.active -= expired + dropped;
+            TinyMutex_Unlock(&sweep->server->leaseMutex);
         }
+    }
+}
 
-        UpnpEvent_Delete(event);
-    } while (0);
+/**
+ * Nothing is scanned until the earliest lease is due; renewals never
+ * touch nextExpiry, so a sweep may find that lease renewed and just
+ * collect the next one.
+ */
+static void UpnpGenaServer_Expire(UpnpGenaServer *thiz, uint64_t now)
+{
+    UpnpLeaseSweep sweep;
+    bool due = false;
+
+    sweep.server = thiz;
+    sweep.now = now;
+    sweep.next = LEASE_NONE;
+
+    TinyMutex_Lock(&thiz->leaseMutex);
+    due = (thiz->nextExpiry <= sweep.now);
+    if (due)
+    {
+        thiz->nextExpiry = LEASE_NONE;
+    }
+    TinyMutex_Unlock(&thiz->leaseMutex);
+
+    if (!due)
+    {
+        return;
+    }
+
+    UpnpProvider_ReadLock(thiz->provider);
+    UpnpProvider_Foreach(thiz->provider, NULL, OnLeaseVisit, &sweep);
+    UpnpProvider_ReadUnlock(thiz->provider);
+
+    /**
+     * subscriptions added meanwhile may have lowered it already
+     */
+    TinyMutex_Lock(&thiz->leaseMutex);
+    if (sweep.next < thiz->nextExpiry)
+    {
+        thiz->nextExpiry = sweep.next;
+    }
+    TinyMutex_Unlock(&thiz->leaseMutex);
+}
+
+static bool OnTimer(TinyTimer *timer, void *ctx)
+{
+    UpnpGenaServer *thiz = (UpnpGenaServer *)ctx;
+    uint64_t now = tiny_getusec();
+
+    UpnpGenaServer_Flush(thiz, now);
+
+    if (UpnpEventDispatcher_Retry(&thiz->dispatcher, now) > 0)
+    {
+        /**
+         * subscribers whose callback is dead go with the next sweep
+         */
+        TinyMutex_Lock(&thiz->leaseMutex);
+        thiz->nextExpiry = now;
+        TinyMutex_Unlock(&thiz->leaseMutex);
+    }
+
+    UpnpGenaServer_Expire(thiz, now);
+
+    return true;
 }
 
 UpnpGenaServer * UpnpGenaServer_New(UpnpHttpManager *http, UpnpProvider *provider)
@@ -299,17 +867,40 @@ TinyRet UpnpGenaServer_Construct(UpnpGenaServer *thiz, UpnpHttpManager *http, Up
             break;
         }
 
-        ret = TinyWorker_Construct(&thiz->notifyWorker);
+        ret = UpnpEventDispatcher_Construct(&thiz->dispatcher, UPNP_EVENT_WORKERS, UPNP_EVENT_QUEUE_DEPTH);
         if (RET_FAILED(ret))
         {
-            LOG_E(TAG, "TinyWorker_Construct: failed");
+            LOG_E(TAG, "UpnpEventDispatcher_Construct: failed");
             break;
         }
 
-        ret = TinyWorker_Initialize(&thiz->notifyWorker, OnNotifyJobDelete, thiz);
+        thiz->nextExpiry = LEASE_NONE;
+
+        ret = TinyMutex_Construct(&thiz->leaseMutex);
         if (RET_FAILED(ret))
         {
-            LOG_E(TAG, "TinyWorker_Initialize: failed");
+            LOG_E(TAG, "TinyMutex_Construct: failed");
+            break;
+        }
+
+        ret = TinyMutex_Construct(&thiz->eventMutex);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyMutex_Construct: failed");
+            break;
+        }
+
+        ret = TinyTimer_Construct(&thiz->timer);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyTimer_Construct: failed");
+            break;
+        }
+
+        ret = TinyTimer_Initialize(&thiz->timer, GENA_TIMER_INTERVAL, 0);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyTimer_Initialize: failed");
             break;
         }
 
@@ -320,7 +911,7 @@ TinyRet UpnpGenaServer_Construct(UpnpGenaServer *thiz, UpnpHttpManager *http, Up
 
         do
         {
-            ret = UpnpProvider_AddObserver(thiz->provider, "UpnpGenaServer", NULL, NULL, OnServiceChanged, thiz);
+            ret = UpnpProvider_AddObserver(thiz->provider, "UpnpGenaServer", NULL, OnDeviceRemoved, OnServiceChanged, thiz);
             if (RET_FAILED(ret))
             {
                 LOG_E(TAG, "UpnpProvider_AddObserver failed");
@@ -347,6 +938,11 @@ void UpnpGenaServer_Dispose(UpnpGenaServer *thiz)
             LOG_E(TAG, "UpnpProvider_RemoveObserver failed");
             break;
         }
+
+        /**
+         * subscribers outlive us: detach them from the queues freed below
+         */
+        UpnpProvider_Foreach(thiz->provider, NULL, OnDeviceVisit, thiz);
     } while (0);
 
     UpnpProvider_Unlock(thiz->provider);
@@ -361,7 +957,16 @@ void UpnpGenaServer_Dispose(UpnpGenaServer *thiz)
         LOG_E(TAG, "UpnpHttpServer_UnregisterUnsubscriberHandler: failed");
     }
 
-    TinyWorker_Dispose(&thiz->notifyWorker);
+    TinyTimer_Dispose(&thiz->timer);
+    UpnpEventDispatcher_Dispose(&thiz->dispatcher);
+    TinyMutex_Dispose(&thiz->leaseMutex);
+
+    while (thiz->held != NULL)
+    {
+        UpnpGenaServer_Release(thiz, thiz->held->service);
+    }
+
+    TinyMutex_Dispose(&thiz->eventMutex);
 
     thiz->http = NULL;
     thiz->provider = NULL;
@@ -377,14 +982,54 @@ void UpnpGenaServer_Delete(UpnpGenaServer *thiz)
 
 TinyRet UpnpGenaServer_Start(UpnpGenaServer *thiz)
 {
+    TinyRet ret = TINY_RET_OK;
+
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
 
-    return TinyWorker_Start(&thiz->notifyWorker, "Notifier", DoNotify, thiz);
+    do
+    {
+        ret = UpnpEventDispatcher_Start(&thiz->dispatcher);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "UpnpEventDispatcher_Start: failed");
+            break;
+        }
+
+        ret = TinyTimer_Start(&thiz->timer, OnTimer, thiz);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyTimer_Start: failed");
+            UpnpEventDispatcher_Stop(&thiz->dispatcher);
+            break;
+        }
+    } while (0);
+
+    return ret;
 }
 
 TinyRet UpnpGenaServer_Stop(UpnpGenaServer *thiz)
 {
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
 
-    return TinyWorker_Stop(&thiz->notifyWorker);
-}
\ No newline at end of file
+    TinyTimer_Stop(&thiz->timer);
+
+    return UpnpEventDispatcher_Stop(&thiz->dispatcher);
+}
+
+void UpnpGenaServer_GetStats(UpnpGenaServer *thiz, UpnpEventDispatcherStats *stats)
+{
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(stats);
+
+    UpnpEventDispatcher_GetStats(&thiz->dispatcher, stats);
+}
+
+void UpnpGenaServer_GetLeaseStats(UpnpGenaServer *thiz, UpnpLeaseStats *stats)
+{
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(stats);
+
+    TinyMutex_Lock(&thiz->leaseMutex);
+    memcpy(stats, &thiz->leases, sizeof(UpnpLeaseStats));
+    TinyMutex_Unlock(&thiz->leaseMutex);
+}
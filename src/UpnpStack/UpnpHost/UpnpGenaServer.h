@@ -18,16 +18,32 @@
 #include "tiny_base.h"
 #include "UpnpHttpManager.h"
 #include "UpnpProvider.h"
-#include "TinyWorker.h"
+#include "UpnpEventDispatcher.h"
+#include "TinyMutex.h"
+#include "TinyTimer.h"
 
 TINY_BEGIN_DECLS
 
 
+typedef struct _UpnpLeaseStats
+{
+    uint32_t                    active;
+    uint32_t                    renewed;
+    uint32_t                    expired;
+    uint32_t                    dropped;
+} UpnpLeaseStats;
+
 typedef struct _UpnpGenaServer
 {
     UpnpHttpManager *http;
     UpnpProvider *provider;
-    TinyWorker notifyWorker;
+    UpnpEventDispatcher dispatcher;
+    TinyTimer timer;
+    TinyMutex leaseMutex;
+    TinyMutex eventMutex;
+    struct _UpnpModeratedService *held;
+    uint64_t nextExpiry;
+    UpnpLeaseStats leases;
 } UpnpGenaServer;
 
 UpnpGenaServer * UpnpGenaServer_New(UpnpHttpManager *http, UpnpProvider *provider);
@@ -38,6 +54,9 @@ void UpnpGenaServer_Delete(UpnpGenaServer *thiz);
 TinyRet UpnpGenaServer_Start(UpnpGenaServer *thiz);
 TinyRet UpnpGenaServer_Stop(UpnpGenaServer *thiz);
 
+void UpnpGenaServer_GetStats(UpnpGenaServer *thiz, UpnpEventDispatcherStats *stats);
+void UpnpGenaServer_GetLeaseStats(UpnpGenaServer *thiz, UpnpLeaseStats *stats);
+
 
 TINY_END_DECLS
 
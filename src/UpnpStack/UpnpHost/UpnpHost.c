@@ -93,14 +93,34 @@ void UpnpHost_Delete(UpnpHost *thiz)
 
 TinyRet UpnpHost_Start(UpnpHost *thiz)
 {
+    TinyRet ret = TINY_RET_OK;
+
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
 
-    return UpnpGenaServer_Start(&thiz->genaServer);
+    do
+    {
+        ret = UpnpActionExecutor_Start(&thiz->actionExecutor);
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+
+        ret = UpnpGenaServer_Start(&thiz->genaServer);
+        if (RET_FAILED(ret))
+        {
+            UpnpActionExecutor_Stop(&thiz->actionExecutor);
+            break;
+        }
+    } while (0);
+
+    return ret;
 }
 
 TinyRet UpnpHost_Stop(UpnpHost *thiz)
 {
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
 
+    UpnpActionExecutor_Stop(&thiz->actionExecutor);
+
     return UpnpGenaServer_Stop(&thiz->genaServer);
 }
\ No newline at end of file
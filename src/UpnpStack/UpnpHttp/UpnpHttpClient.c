@@ -17,6 +17,7 @@
 #include "HttpClient.h"
 #include "tiny_log.h"
 #include "tiny_memory.h"
+#include "tiny_str_equal.h"
 #include "message/ActionRequest.h"
 #include "message/ActionResponse.h"
 #include "message/ServiceSubRequest.h"
@@ -160,6 +161,92 @@ TinyRet UpnpHttpClient_Post(UpnpHttpClient *thiz, UpnpAction *action, UpnpError
     return ret;
 }
 
+/**
+ * HTTP/1.1 keeps the connection unless the peer says otherwise,
+ * HTTP/1.0 only when it asks for it
+ */
+static bool UpnpHttpClient_IsKeepAlive(HttpMessage *response)
+{
+    const char *connection = HttpMessage_GetHeaderValue(response, "Connection");
+
+    if (connection != NULL)
+    {
+        if (str_equal(connection, "close", true))
+        {
+            return false;
+        }
+
+        if (str_equal(connection, "keep-alive", true))
+        {
+            return true;
+        }
+    }
+
+    return (HttpMessage_GetMajorVersion(response) > 1)
+        || (HttpMessage_GetMajorVersion(response) == 1 && HttpMessage_GetMinorVersion(response) >= 1);
+}
+
+/**
+ * The connection is left open for the next NOTIFY to the same host. An
+ * idle connection the peer dropped meanwhile is retried once on a new one;
+ * a timeout is not, the host is just slow.
+ */
+static TinyRet UpnpHttpClient_SendNotify(UpnpHttpClient *thiz, HttpMessage *request, uint32_t timeout)
+{
+    TinyRet ret = TINY_RET_OK;
+    HttpMessage response;
+    bool reused = HttpClient_IsConnected(thiz->client);
+
+    ret = HttpMessage_Construct(&response);
+    if (RET_FAILED(ret))
+    {
+        return ret;
+    }
+
+    do
+    {
+        ret = HttpClient_Execute(thiz->client, request, &response, timeout);
+        if (RET_FAILED(ret) && reused && ret != TINY_RET_E_TIMEOUT)
+        {
+            HttpClient_Shutdown(thiz->client);
+            HttpMessage_Dispose(&response);
+
+            ret = HttpMessage_Construct(&response);
+            if (RET_FAILED(ret))
+            {
+                return ret;
+            }
+
+            ret = HttpClient_Execute(thiz->client, request, &response, timeout);
+        }
+
+        if (RET_FAILED(ret))
+        {
+            LOG_D(TAG, "HttpClient_Execute failed: %s", tiny_ret_to_str(ret));
+            HttpClient_Shutdown(thiz->client);
+            break;
+        }
+
+        if (!UpnpHttpClient_IsKeepAlive(&response))
+        {
+            HttpClient_Shutdown(thiz->client);
+        }
+
+        if (HttpMessage_GetStatusCode(&response) != HTTP_STATUS_OK)
+        {
+            LOG_D(TAG, "HttpClient_Execute failed: %d %s",
+                HttpMessage_GetStatusCode(&response),
+                HttpMessage_GetStatus(&response));
+            ret = TINY_RET_E_UPNP_NOTIFY_FAILED;
+            break;
+        }
+    } while (0);
+
+    HttpMessage_Dispose(&response);
+
+    return ret;
+}
+
 TinyRet UpnpHttpClient_Notify(UpnpHttpClient *thiz, UpnpEvent *event)
 {
     LOG_TIME_BEGIN(TAG, UpnpHttpClient_Notify);
@@ -172,7 +259,6 @@ TinyRet UpnpHttpClient_Notify(UpnpHttpClient *thiz, UpnpEvent *event)
     do
     {
         HttpMessage request;
-        HttpMessage response;
 
         ret = HttpMessage_Construct(&request);
         if (RET_FAILED(ret))
@@ -180,53 +266,55 @@ TinyRet UpnpHttpClient_Notify(UpnpHttpClient *thiz, UpnpEvent *event)
             break;
         }
 
-        ret = HttpMessage_Construct(&response);
-        if (RET_FAILED(ret))
+        /**
+         * UpnpEvent -> HttpReqeust
+         */
+        ret = UpnpEventToRequest(event, &request);
+        if (RET_SUCCEEDED(ret))
         {
-            HttpMessage_Dispose(&request);
-            break;
+            ret = UpnpHttpClient_SendNotify(thiz, &request, UPNP_TIMEOUT);
         }
 
-        do
-        {
-            /**
-             * UpnpEvent -> HttpReqeust
-             */
-            ret = UpnpEventToRequest(event, &request);
-            if (RET_FAILED(ret))
-            {
-                break;
-            }
+        HttpMessage_Dispose(&request);
+    } while (0);
 
-            //
-            // 2016.3.24
-            // ÿHTTP¿ʼӣʱô
-            // ǽһӳأܸóӵľãٷõٶȡ
-            //
-            HttpClient_Shutdown(thiz->client);
+    LOG_TIME_END(TAG, UpnpHttpClient_Notify);
 
-            ret = HttpClient_Execute(thiz->client, &request, &response, UPNP_TIMEOUT);
-            if (RET_FAILED(ret))
-            {
-                LOG_D(TAG, "HttpClient_Execute failed: %s", tiny_ret_to_str(ret));
-                break;
-            }
+    return ret;
+}
 
-            if (HttpMessage_GetStatusCode(&response) != HTTP_STATUS_OK)
-            {
-                LOG_D(TAG, "HttpClient_Execute failed: %d %s",
-                    HttpMessage_GetStatusCode(&response),
-                    HttpMessage_GetStatus(&response));
-                ret = TINY_RET_E_UPNP_NOTIFY_FAILED;
-                break;
-            }
-        } while (0);
+TinyRet UpnpHttpClient_NotifyBody(UpnpHttpClient *thiz, const char *callback, const char *sid, uint32_t seq, UpnpEventBody *body, uint32_t timeout)
+{
+    LOG_TIME_BEGIN(TAG, UpnpHttpClient_NotifyBody);
+
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(body, TINY_RET_E_ARG_NULL);
+
+    do
+    {
+        HttpMessage request;
+
+        ret = HttpMessage_Construct(&request);
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+
+        /**
+         * shared body, per-subscriber headers
+         */
+        ret = UpnpEventBodyToRequest(body, callback, sid, seq, &request);
+        if (RET_SUCCEEDED(ret))
+        {
+            ret = UpnpHttpClient_SendNotify(thiz, &request, timeout);
+        }
 
         HttpMessage_Dispose(&request);
-        HttpMessage_Dispose(&response);
     } while (0);
 
-    LOG_TIME_END(TAG, UpnpHttpClient_Notify);
+    LOG_TIME_END(TAG, UpnpHttpClient_NotifyBody);
 
     return ret;
 }
@@ -21,6 +21,7 @@
 #include "UpnpAction.h"
 #include "UpnpError.h"
 #include "UpnpSubscription.h"
+#include "message/EventBody.h"
 
 TINY_BEGIN_DECLS
 
@@ -37,6 +38,7 @@ void UpnpHttpClient_Delete(UpnpHttpClient *thiz);
 
 TinyRet UpnpHttpClient_Post(UpnpHttpClient *thiz, UpnpAction *action, UpnpError *error, uint32_t timeout);
 TinyRet UpnpHttpClient_Notify(UpnpHttpClient *thiz, UpnpEvent *event);
+TinyRet UpnpHttpClient_NotifyBody(UpnpHttpClient *thiz, const char *callback, const char *sid, uint32_t seq, UpnpEventBody *body, uint32_t timeout);
 TinyRet UpnpHttpClient_Subscribe(UpnpHttpClient *thiz, UpnpSubscription *subscription, UpnpError *error, uint32_t timeout);
 TinyRet UpnpHttpClient_Unsubscribe(UpnpHttpClient *thiz, UpnpSubscription *subscription, UpnpError *error, uint32_t timeout);
 
@@ -78,6 +78,44 @@ void UpnpHttpConnection_Delete(UpnpHttpConnection *thiz)
     tiny_free(thiz);
 }
 
+UpnpHttpConnection * UpnpHttpConnection_Detach(UpnpHttpConnection *thiz)
+{
+    UpnpHttpConnection *detached = NULL;
+    TcpConn *conn = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+
+    do
+    {
+        detached = (UpnpHttpConnection *)tiny_malloc(sizeof(UpnpHttpConnection));
+        if (detached == NULL)
+        {
+            break;
+        }
+
+        conn = TcpConn_Detach(thiz->conn);
+        if (conn == NULL)
+        {
+            tiny_free(detached);
+            detached = NULL;
+            break;
+        }
+
+        UpnpHttpConnection_Construct(detached, conn);
+    } while (0);
+
+    return detached;
+}
+
+void UpnpHttpConnection_Close(UpnpHttpConnection *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TcpConn_Disconnect(thiz->conn);
+    TcpConn_Delete(thiz->conn);
+    UpnpHttpConnection_Delete(thiz);
+}
+
 TinyRet UpnpHttpConnection_SendOk(UpnpHttpConnection *thiz)
 {
     return UpnpHttpConnection_SendError(thiz, 200, "OK");
@@ -181,6 +219,145 @@ TinyRet UpnpHttpConnection_SendFileContent(UpnpHttpConnection *thiz, const char
     return ret;
 }
 
+TinyRet UpnpHttpConnection_SendDocument(UpnpHttpConnection *thiz, const char *content, uint32_t contentLength, const char *contentEncoding, const char *etag)
+{
+    TinyRet ret = TINY_RET_OK;
+    HttpMessage *response = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(content, TINY_RET_E_ARG_NULL);
+
+    do
+    {
+        char *bytes = NULL;
+        uint32_t size = 0;
+
+        response = HttpMessage_New();
+        if (response == NULL)
+        {
+            LOG_E(TAG, "HttpMessage_New failed");
+            ret = TINY_RET_E_NEW;
+            break;
+        }
+
+        HttpMessage_SetType(response, HTTP_RESPONSE);
+        HttpMessage_SetVersion(response, 1, 1);
+        HttpMessage_SetResponse(response, 200, "OK");
+        HttpMessage_SetHeader(response, "Content-Type", "text/xml; charset=\"utf-8\"");
+        HttpMessage_SetHeaderInteger(response, "Content-Length", contentLength);
+        HttpMessage_SetHeader(response, "Vary", "Accept-Encoding");
+
+        if (contentEncoding != NULL)
+        {
+            HttpMessage_SetHeader(response, "Content-Encoding", contentEncoding);
+        }
+
+        if (etag != NULL)
+        {
+            HttpMessage_SetHeader(response, "ETag", etag);
+        }
+
+        ret = HttpMessage_ToBytes(response, &bytes, &size);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "HttpMessage_ToBytes failed");
+            break;
+        }
+
+        ret = TcpConn_Send(thiz->conn, bytes, size, UPNP_TIMEOUT);
+
+        tiny_free(bytes);
+        bytes = NULL;
+        size = 0;
+
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+
+        ret = TcpConn_Send(thiz->conn, content, contentLength, UPNP_TIMEOUT);
+    } while (0);
+
+    if (response != NULL)
+    {
+        HttpMessage_Delete(response);
+    }
+
+    return ret;
+}
+
+TinyRet UpnpHttpConnection_SendNotModified(UpnpHttpConnection *thiz, const char *etag)
+{
+    TinyRet ret = TINY_RET_OK;
+    HttpMessage *response = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    do
+    {
+        char *bytes = NULL;
+        uint32_t size = 0;
+
+        response = HttpMessage_New();
+        if (response == NULL)
+        {
+            LOG_E(TAG, "HttpMessage_New failed");
+            ret = TINY_RET_E_NEW;
+            break;
+        }
+
+        HttpMessage_SetType(response, HTTP_RESPONSE);
+        HttpMessage_SetVersion(response, 1, 1);
+        HttpMessage_SetResponse(response, 304, "Not Modified");
+
+        if (etag != NULL)
+        {
+            HttpMessage_SetHeader(response, "ETag", etag);
+        }
+
+        ret = HttpMessage_ToBytes(response, &bytes, &size);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "HttpMessage_ToBytes failed");
+            break;
+        }
+
+        ret = TcpConn_Send(thiz->conn, bytes, size, UPNP_TIMEOUT);
+
+        tiny_free(bytes);
+    } while (0);
+
+    if (response != NULL)
+    {
+        HttpMessage_Delete(response);
+    }
+
+    return ret;
+}
+
+TinyRet UpnpHttpConnection_SendResponse(UpnpHttpConnection *thiz, HttpMessage *response)
+{
+    TinyRet ret = TINY_RET_OK;
+    char *bytes = NULL;
+    uint32_t size = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(response, TINY_RET_E_ARG_NULL);
+
+    ret = HttpMessage_ToBytes(response, &bytes, &size);
+    if (RET_FAILED(ret))
+    {
+        LOG_E(TAG, "HttpMessage_ToBytes failed");
+        return ret;
+    }
+
+    ret = TcpConn_Send(thiz->conn, bytes, size, UPNP_TIMEOUT);
+
+    tiny_free(bytes);
+
+    return ret;
+}
+
 TinyRet UpnpHttpConnection_SendActionResponse(UpnpHttpConnection *thiz, UpnpAction *action)
 {
     TinyRet ret = TINY_RET_OK;
@@ -18,6 +18,7 @@
 #include "tiny_base.h"
 #include "TcpConn.h"
 #include "UpnpAction.h"
+#include "HttpMessage.h"
 
 TINY_BEGIN_DECLS
 
@@ -32,10 +33,20 @@ TinyRet UpnpHttpConnection_Construct(UpnpHttpConnection *thiz, TcpConn *conn);
 void UpnpHttpConnection_Dispose(UpnpHttpConnection *thiz);
 void UpnpHttpConnection_Delete(UpnpHttpConnection *thiz);
 
+/**
+ * Detach: takes the socket over, so the request can be answered after its
+ * handler returned, from any thread. Close closes and deletes such a one.
+ */
+UpnpHttpConnection * UpnpHttpConnection_Detach(UpnpHttpConnection *thiz);
+void UpnpHttpConnection_Close(UpnpHttpConnection *thiz);
+
 TinyRet UpnpHttpConnection_SendOk(UpnpHttpConnection *thiz);
 TinyRet UpnpHttpConnection_SendError(UpnpHttpConnection *thiz, int code, const char *status);
 TinyRet UpnpHttpConnection_SendFile(UpnpHttpConnection *thiz, const char *file);
 TinyRet UpnpHttpConnection_SendFileContent(UpnpHttpConnection *thiz, const char *content, uint32_t contentLength);
+TinyRet UpnpHttpConnection_SendDocument(UpnpHttpConnection *thiz, const char *content, uint32_t contentLength, const char *contentEncoding, const char *etag);
+TinyRet UpnpHttpConnection_SendNotModified(UpnpHttpConnection *thiz, const char *etag);
+TinyRet UpnpHttpConnection_SendResponse(UpnpHttpConnection *thiz, HttpMessage *response);
 TinyRet UpnpHttpConnection_SendActionResponse(UpnpHttpConnection *thiz, UpnpAction *action);
 TinyRet UpnpHttpConnection_SendSubscribeResponse(UpnpHttpConnection *thiz, const char *sid, uint32_t timeout);
 
@@ -407,7 +407,11 @@ static void doGet(UpnpHttpServer *thiz, UpnpHttpConnection *conn, HttpMessage *r
             break;
         }
 
-        thiz->OnGet(conn, HttpMessage_GetUri(request), thiz->OnGetCtx);
+        thiz->OnGet(conn,
+            HttpMessage_GetUri(request),
+            HttpMessage_GetHeaderValue(request, "If-None-Match"),
+            HttpMessage_GetHeaderValue(request, "Accept-Encoding"),
+            thiz->OnGetCtx);
     } while (0);
 }
 
@@ -459,18 +463,37 @@ static void doSubscribe(UpnpHttpServer *thiz, UpnpHttpConnection *conn, HttpMess
         uint32_t second = 0;
         const char * timeout = HttpMessage_GetHeaderValue(request, "TIMEOUT");
         const char * callback = HttpMessage_GetHeaderValue(request, "CALLBACK");
+        const char * sid = HttpMessage_GetHeaderValue(request, "SID");
         char url[TINY_URL_LEN];
 
-        if (callback == NULL)
+        memset(url, 0, TINY_URL_LEN);
+
+        if (sid != NULL)
         {
-            UpnpHttpConnection_SendError(conn, 404, "CALLBACK invalid");
-            break;
+            /**
+             * renewal: SID only
+             */
+            if (callback != NULL || HttpMessage_GetHeaderValue(request, "NT") != NULL)
+            {
+                UpnpHttpConnection_SendError(conn, 400, "BAD REQUEST");
+                break;
+            }
         }
+        else
+        {
+            if (callback == NULL || strlen(callback) < 2)
+            {
+                UpnpHttpConnection_SendError(conn, 404, "CALLBACK invalid");
+                break;
+            }
 
-        memset(url, 0, TINY_URL_LEN);
-        strncpy(url, callback + 1, strlen(callback) - 2);
+            strncpy(url, callback + 1, strlen(callback) - 2);
+        }
 
-        if (RET_FAILED(upnp_timeout_get_second(timeout, &second)))
+        /**
+         * TIMEOUT is optional: the host picks the duration
+         */
+        if (timeout != NULL && RET_FAILED(upnp_timeout_get_second(timeout, &second)))
         {
             UpnpHttpConnection_SendError(conn, 404, "TIMEOUT invalid");
             break;
@@ -482,11 +505,12 @@ static void doSubscribe(UpnpHttpServer *thiz, UpnpHttpConnection *conn, HttpMess
             break;
         }
 
-        LOG_D(TAG, "timeout: %s", timeout);
+        LOG_D(TAG, "timeout: %s", (timeout == NULL) ? "none" : timeout);
 
         thiz->OnSubscribe(conn,
             HttpMessage_GetUri(request),
-            url,
+            (sid == NULL) ? url : NULL,
+            sid,
             HttpMessage_GetHeaderValue(request, "NT"),
             second,
             thiz->OnSubscribeCtx);
@@ -23,8 +23,10 @@ TINY_BEGIN_DECLS
 
 
 typedef void(*UpnpGetHandler)(UpnpHttpConnection *conn,
-const char *uri,
-void *ctx);
+    const char *uri,
+    const char *ifNoneMatch,
+    const char *acceptEncoding,
+    void *ctx);
 
 typedef void(*UpnpPostHandler)(UpnpHttpConnection *conn,
     const char *uri,
@@ -43,9 +45,13 @@ typedef void(*UpnpNotifyHandler)(UpnpHttpConnection *conn,
     uint32_t contentLength,
     void *ctx);
 
+/**
+ * A renewal carries sid and no callback; a new subscription the reverse.
+ */
 typedef void(*UpnpSubscribeHandler)(UpnpHttpConnection *conn,
     const char *uri,
     const char *callback,
+    const char *sid,
     const char *nt,
     uint32_t timeout,
     void *ctx);
@@ -14,6 +14,7 @@
 
 #include "ActionRequest.h"
 #include "soap/SoapMessage.h"
+#include "soap/SoapActionDecoder.h"
 #include "UpnpDevice.h"
 #include "UpnpService.h"
 #include "tiny_memory.h"
@@ -160,115 +161,95 @@ static TinyRet ActionToSoapRequest(UpnpAction *action, SoapMessage *soap)
 static TinyRet SoapRequestToHttpRequest(SoapMessage *soap, HttpMessage *request)
 {
     TinyRet ret = TINY_RET_OK;
+    SoapWriter writer;
+
+    ret = SoapWriter_Construct(&writer, 1024);
+    if (RET_FAILED(ret))
+    {
+        return ret;
+    }
 
     do
     {
         char soap_action[256];
-        char *data = NULL;
-        uint32_t size = UPNP_SOAP_LEN;
         const char * serverUrl = SoapMessage_GetServerURL(soap);
         const char * actionName = SoapMessage_GetActionName(soap);
         const char * actionXmlns = SoapMessage_GetActionXmlns(soap);
 
         tiny_snprintf(soap_action, 256, "\"%s#%s\"", actionXmlns, actionName);
 
-        data = (char *)tiny_malloc(size);
-        if (data == NULL)
-        {
-            ret = TINY_RET_E_OUT_OF_MEMORY;
-            break;
-        }
-
-        memset(data, 0, size);
-        ret = SoapMessage_ToString(soap, data, size);
+        ret = SoapMessage_Write(soap, &writer);
         if (RET_FAILED(ret))
         {
-            tiny_free(data);
             break;
         }
 
-        size = strlen(data);
-
         HttpMessage_SetRequest(request, "POST", serverUrl);
         HttpMessage_SetHeader(request, "Content-Type", "text/xml;charset=\"utf-8\"");
         HttpMessage_SetHeader(request, "Soapaction", soap_action);
         HttpMessage_SetHeader(request, "User-Agent", UPNP_STACK_INFO);
-        HttpMessage_SetHeaderInteger(request, "Content-Length", size);
-        HttpMessage_SetContentSize(request, size);
-        HttpMessage_AddContentObject(request, data, size);
-
-        tiny_free(data);
+        HttpMessage_SetHeaderInteger(request, "Content-Length", writer.length);
+        HttpMessage_SetContentSize(request, writer.length);
+        HttpMessage_AddContentObject(request, writer.data, writer.length);
     } while (0);
 
+    SoapWriter_Dispose(&writer);
+
     return ret;
 }
 
 TinyRet ActionFromRequest(UpnpAction *action, const char *content, uint32_t contentLength)
+{
+    RETURN_VAL_IF_FAIL(action, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(content, TINY_RET_E_ARG_NULL);
+
+    return SoapActionDecoder_Decode(action, NULL, content, contentLength);
+}
+
+TinyRet ActionArgumentsFromRequest(UpnpAction *action, PropertyList *arguments, const char *content, uint32_t contentLength)
+{
+    RETURN_VAL_IF_FAIL(action, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(arguments, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(content, TINY_RET_E_ARG_NULL);
+
+    return SoapActionDecoder_Decode(action, arguments, content, contentLength);
+}
+
+TinyRet ActionFromArguments(UpnpAction *action, PropertyList *arguments)
 {
     TinyRet ret = TINY_RET_OK;
+    UpnpService *service = NULL;
+    uint32_t count = 0;
+    uint32_t i = 0;
 
-    do
+    RETURN_VAL_IF_FAIL(action, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(arguments, TINY_RET_E_ARG_NULL);
+
+    service = (UpnpService *)UpnpAction_GetParentService(action);
+    if (service == NULL)
     {
-        SoapMessage * soap = SoapMessage_New();
-        if (soap == NULL)
+        return TINY_RET_E_UPNP_SERVICE_NOT_FOUND;
+    }
+
+    count = PropertyList_GetSize(arguments);
+    for (i = 0; i < count; i++)
+    {
+        Property *argument = PropertyList_GetPropertyAt(arguments, i);
+        UpnpStateVariable *state = NULL;
+
+        state = UpnpService_GetStateVariable(service, UpnpAction_GetArgumentRelatedStateVariable(action, argument->name));
+        if (state == NULL)
         {
-            ret = TINY_RET_E_NEW;
+            ret = TINY_RET_E_UPNP_ARGUMENT_NOT_FOUND;
             break;
         }
 
-        do
+        ret = DataValue_SetValue(&state->value, argument->value);
+        if (RET_FAILED(ret))
         {
-            uint32_t i = 0;
-            uint32_t count = 0;
-            UpnpService * service = UpnpAction_GetParentService(action);
-
-            printf("content: %s\n", content);
-
-            ret = SoapMessage_ParseRequest(soap, content, contentLength);
-            if (RET_FAILED(ret))
-            {
-                break;
-            }
-
-            count = UpnpAction_GetArgumentCount(action);
-            for (i = 0; i < count; i++)
-            {
-                UpnpArgument *argument = UpnpAction_GetArgumentAt(action, i);
-                if (UpnpArgument_GetDirection(argument) == ARG_IN)
-                {
-                    const char *name = UpnpArgument_GetName(argument);
-                    const char *relatedStateVariable = NULL;
-                    UpnpStateVariable *state = NULL;
-                    PropertyList *list = NULL;
-                    const char *value = NULL;
-
-                    list = SoapMessage_GetArgumentList(soap);
-                    value = PropertyList_GetPropertyValue(list, name);
-                    if (value == NULL)
-                    {
-                        ret = TINY_RET_E_UPNP_ARGUMENT_NOT_FOUND;
-                        break;
-                    }
-
-                    relatedStateVariable = UpnpArgument_GetRelatedStateVariable(argument);
-                    state = UpnpService_GetStateVariable(service, relatedStateVariable);
-                    if (state == NULL)
-                    {
-                        ret = TINY_RET_E_UPNP_ARGUMENT_NOT_FOUND;
-                        break;
-                    }
-
-                    ret = DataValue_SetValue(&state->value, value);
-                    if (RET_FAILED(ret))
-                    {
-                        break;
-                    }
-                }
-            }
-        } while (0);
-
-        SoapMessage_Delete(soap);
-    } while (0);
+            break;
+        }
+    }
 
     return ret;
-}
\ No newline at end of file
+}
@@ -18,6 +18,7 @@
 #include "tiny_base.h"
 #include "UpnpAction.h"
 #include "HttpMessage.h"
+#include "PropertyList.h"
 
 TINY_BEGIN_DECLS
 
@@ -25,6 +26,14 @@ TINY_BEGIN_DECLS
 TinyRet ActionToRequest(UpnpAction *action, HttpMessage *request);
 TinyRet ActionFromRequest(UpnpAction *action, const char *content, uint32_t contentLength);
 
+/**
+ * ArgumentsFromRequest decodes the in arguments into a list of their own,
+ * without the service lock; FromArguments then stores them in the related
+ * state variables, under it.
+ */
+TinyRet ActionArgumentsFromRequest(UpnpAction *action, PropertyList *arguments, const char *content, uint32_t contentLength);
+TinyRet ActionFromArguments(UpnpAction *action, PropertyList *arguments);
+
 
 TINY_END_DECLS
 
@@ -14,6 +14,7 @@
 #include "UpnpDevice.h"
 #include "UpnpService.h"
 #include "soap/SoapMessage.h"
+#include "soap/SoapWriter.h"
 #include "tiny_log.h"
 #include "UpnpCode.h"
 #include "tiny_memory.h"
@@ -137,56 +138,105 @@ TinyRet SoapResponseToActionResult(SoapMessage *soap, UpnpAction *action, UpnpEr
     return ret;
 }
 
-static TinyRet ActionToSoapResponse(UpnpAction *action, SoapMessage *soap);
-static TinyRet SoapResponseToHttpResponse(SoapMessage *soap, HttpMessage *response);
+#define SOAP_RESPONSE_SUFFIX    "Response"
 
-TinyRet ActionToResponse(UpnpAction *action, HttpMessage *response)
+TinyRet ActionResponse_Prepare(UpnpAction *action)
 {
-    TinyRet ret = TINY_RET_OK;
+    UpnpService *service = NULL;
+    SoapTemplate *soapTemplate = NULL;
 
     RETURN_VAL_IF_FAIL(action, TINY_RET_E_ARG_NULL);
-    RETURN_VAL_IF_FAIL(response, TINY_RET_E_ARG_NULL);
 
-    do
+    service = (UpnpService *)UpnpAction_GetParentService(action);
+    if (service == NULL)
     {
-        SoapMessage * soap = SoapMessage_New();
-        if (soap == NULL)
+        return TINY_RET_E_UPNP_SERVICE_NOT_FOUND;
+    }
+
+    soapTemplate = SoapTemplate_New(UpnpAction_GetName(action), SOAP_RESPONSE_SUFFIX, UpnpService_GetServiceType(service));
+    if (soapTemplate == NULL)
+    {
+        return TINY_RET_E_OUT_OF_MEMORY;
+    }
+
+    UpnpAction_SetResponseTemplate(action, soapTemplate);
+
+    return TINY_RET_OK;
+}
+
+TinyRet ActionToResponse(UpnpAction *action, HttpMessage *response)
+{
+    return ActionResultsToResponse(action, NULL, response);
+}
+
+static TinyRet ActionWriteResults(UpnpAction *action, UpnpService *service, PropertyList *results, SoapWriter *writer)
+{
+    TinyRet ret = TINY_RET_OK;
+    uint32_t count = UpnpAction_GetArgumentCount(action);
+    uint32_t i = 0;
+
+    for (i = 0; i < count; ++i)
+    {
+        UpnpArgument * argument = NULL;
+        UpnpStateVariable * state = NULL;
+        const char *name = NULL;
+        const char *value = NULL;
+
+        argument = UpnpAction_GetArgumentAt(action, i);
+        if (UpnpArgument_GetDirection(argument) != ARG_OUT)
         {
-            ret = TINY_RET_E_NEW;
-            break;
+            continue;
         }
 
-        ret = ActionToSoapResponse(action, soap);
-        if (RET_SUCCEEDED(ret))
+        name = UpnpArgument_GetName(argument);
+
+        if (results != NULL)
         {
-            ret = SoapResponseToHttpResponse(soap, response);
+            value = PropertyList_GetPropertyValue(results, name);
+            if (value == NULL)
+            {
+                LOG_D(TAG, "result NOT SET: %s", name);
+                value = "";
+            }
+
+            SoapWriter_AppendArgument(writer, name, value);
+            continue;
         }
 
-        SoapMessage_Delete(soap);
-    } while (0);
+        state = UpnpService_GetStateVariable(service, UpnpArgument_GetRelatedStateVariable(argument));
+        if (state == NULL)
+        {
+            LOG_E(TAG, "RelatedStateVariable NOT FOUND: %s", UpnpArgument_GetRelatedStateVariable(argument));
+            break;
+        }
+
+        SoapWriter_AppendValueArgument(writer, name, &state->value);
+    }
 
     return ret;
 }
 
-static TinyRet ActionToSoapResponse(UpnpAction *action, SoapMessage *soap)
+/**
+ * one pass into a single buffer: envelope head, escaped arguments, envelope tail
+ */
+TinyRet ActionResultsToResponse(UpnpAction *action, PropertyList *results, HttpMessage *response)
 {
     TinyRet ret = TINY_RET_OK;
+    SoapWriter writer;
 
     RETURN_VAL_IF_FAIL(action, TINY_RET_E_ARG_NULL);
-    RETURN_VAL_IF_FAIL(soap, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(response, TINY_RET_E_ARG_NULL);
+
+    ret = SoapWriter_Construct(&writer, 1024);
+    if (RET_FAILED(ret))
+    {
+        return ret;
+    }
 
     do
     {
-        uint32_t i = 0;
-        uint32_t count = 0;
-        PropertyList *soapArguments = SoapMessage_GetArgumentList(soap);
-        UpnpDevice *device = NULL;
         UpnpService *service = NULL;
-        const char *ctrlUrl = NULL;
-        const char *urlBase = NULL;
-        char url[TINY_URL_LEN];
-
-        memset(url, 0, TINY_URL_LEN);
+        SoapTemplate *soapTemplate = NULL;
 
         service = (UpnpService *)UpnpAction_GetParentService(action);
         if (service == NULL)
@@ -195,127 +245,48 @@ static TinyRet ActionToSoapResponse(UpnpAction *action, SoapMessage *soap)
             break;
         }
 
-        device = (UpnpDevice *)UpnpService_GetParentDevice(service);
-        if (service == NULL)
+        soapTemplate = (SoapTemplate *)UpnpAction_GetResponseTemplate(action);
+        if (soapTemplate != NULL)
         {
-            ret = TINY_RET_E_UPNP_DEVICE_NOT_FOUND;
-            break;
+            SoapWriter_Append(&writer, soapTemplate->prefix, soapTemplate->prefixLength);
         }
-
-        ctrlUrl = UpnpService_GetControlURL(service);
-        urlBase = UpnpDevice_GetURLBase(device);
-
-        tiny_snprintf(url, TINY_URL_LEN, "%s%s", urlBase, ctrlUrl);
-
-        ret = SoapMessage_SetServerURL(soap, url);
-        if (RET_FAILED(ret))
+        else
         {
-            break;
+            SoapWriter_AppendEnvelopeBegin(&writer, UpnpAction_GetName(action), SOAP_RESPONSE_SUFFIX, UpnpService_GetServiceType(service));
         }
 
-        ret = SoapMessage_SetResponseActionName(soap, UpnpAction_GetName(action));
+        ret = ActionWriteResults(action, service, results, &writer);
         if (RET_FAILED(ret))
         {
             break;
         }
 
-        ret = SoapMessage_SetActionXmlns(soap, UpnpService_GetServiceType(service));
-        if (RET_FAILED(ret))
+        if (soapTemplate != NULL)
         {
-            break;
+            SoapWriter_Append(&writer, soapTemplate->suffix, soapTemplate->suffixLength);
         }
-
-        count = UpnpAction_GetArgumentCount(action);
-        for (i = 0; i < count; ++i)
+        else
         {
-            UpnpArgument * argument = NULL;
-            UpnpStateVariable * state = NULL;
-            const char *name = NULL;
-            const char *value = NULL;
-            char buffer[128];
-
-            argument = UpnpAction_GetArgumentAt(action, i);
-            if (UpnpArgument_GetDirection(argument) != ARG_OUT)
-            {
-                continue;
-            }
-
-            state = UpnpService_GetStateVariable(service, UpnpArgument_GetRelatedStateVariable(argument));
-            if (state == NULL)
-            {
-                LOG_E(TAG, "RelatedStateVariable NOT FOUND: %s", UpnpArgument_GetRelatedStateVariable(argument));
-                break;
-            }
-
-            memset(buffer, 0, 128);
-
-            name = UpnpArgument_GetName(argument);
-            value = buffer;
-
-            if (state->value.internalType == INTERNAL_STRING)
-            {
-                value = state->value.internalValue.stringValue;
-            }
-            else
-            {
-                ret = DataValue_GetValue(&state->value, buffer, 128);
-                if (RET_FAILED(ret))
-                {
-                    LOG_E(TAG, "value invalid: %s", name);
-                    break;
-                }
-            }
-
-            PropertyList_Add(soapArguments, name, value);
+            SoapWriter_AppendEnvelopeEnd(&writer, UpnpAction_GetName(action), SOAP_RESPONSE_SUFFIX);
         }
-    } while (0);
-
-    return ret;
-}
-
-static TinyRet SoapResponseToHttpResponse(SoapMessage *soap, HttpMessage *response)
-{
-    TinyRet ret = TINY_RET_OK;
 
-    do
-    {
-        char soap_action[256];
-        char *data = NULL;
-        uint32_t size = UPNP_SOAP_LEN;
-        const char * serverUrl = SoapMessage_GetServerURL(soap);
-        const char * actionName = SoapMessage_GetActionName(soap);
-        const char * actionXmlns = SoapMessage_GetActionXmlns(soap);
-
-        tiny_snprintf(soap_action, 256, "\"%s#%s\"", actionXmlns, actionName);
-
-        data = (char *)tiny_malloc(size);
-        if (data == NULL)
-        {
-            ret = TINY_RET_E_OUT_OF_MEMORY;
-            break;
-        }
-
-        memset(data, 0, size);
-        ret = SoapMessage_ToString(soap, data, size);
+        ret = SoapWriter_Finish(&writer);
         if (RET_FAILED(ret))
         {
-            tiny_free(data);
             break;
         }
 
-        size = strlen(data);
-
         HttpMessage_SetType(response, HTTP_RESPONSE);
         HttpMessage_SetVersion(response, 1, 1);
         HttpMessage_SetResponse(response, 200, "OK");
         HttpMessage_SetHeader(response, "Content-Type", "text/xml;charset=\"utf-8\"");
         HttpMessage_SetHeader(response, "User-Agent", UPNP_STACK_INFO);
-        HttpMessage_SetHeaderInteger(response, "Content-Length", size);
-        HttpMessage_SetContentSize(response, size);
-        HttpMessage_AddContentObject(response, data, size);
-
-        tiny_free(data);
+        HttpMessage_SetHeaderInteger(response, "Content-Length", writer.length);
+        HttpMessage_SetContentSize(response, writer.length);
+        HttpMessage_AddContentObject(response, writer.data, writer.length);
     } while (0);
 
+    SoapWriter_Dispose(&writer);
+
     return ret;
-}
\ No newline at end of file
+}
@@ -17,6 +17,7 @@
 #include "UpnpAction.h"
 #include "UpnpError.h"
 #include "HttpMessage.h"
+#include "PropertyList.h"
 
 TINY_BEGIN_DECLS
 
@@ -24,6 +25,17 @@ TINY_BEGIN_DECLS
 TinyRet ActionFromResponse(UpnpAction *action, UpnpError *error, HttpMessage *response);
 TinyRet ActionToResponse(UpnpAction *action, HttpMessage *response);
 
+/**
+ * renders the action's response envelope once, see UpnpAction_SetResponseTemplate
+ */
+TinyRet ActionResponse_Prepare(UpnpAction *action);
+
+/**
+ * out arguments are taken from results instead of the service's state
+ * variables, so no service lock is needed.
+ */
+TinyRet ActionResultsToResponse(UpnpAction *action, PropertyList *results, HttpMessage *response);
+
 
 TINY_END_DECLS
 
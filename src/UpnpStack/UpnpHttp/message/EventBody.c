@@ -0,0 +1,287 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   EventBody.c
+*
+* @remark
+*
+*/
+
+#include "EventBody.h"
+#include "tiny_memory.h"
+#include "tiny_log.h"
+
+#define TAG                 "EventBody"
+
+#define EVENT_BODY_HEAD     "<?xml version=\"1.0\"?>" \
+                            "<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">" \
+                            "<e:property>"
+#define EVENT_BODY_TAIL     "</e:property></e:propertyset>"
+
+static bool UpnpEventBody_AddSpan(UpnpEventBody *thiz, uint32_t offset, uint32_t nameLength)
+{
+    if (thiz->properties == thiz->size)
+    {
+        uint32_t size = (thiz->size == 0) ? 8 : thiz->size * 2;
+        UpnpEventProperty *spans = (UpnpEventProperty *)tiny_realloc(thiz->spans, sizeof(UpnpEventProperty) * size);
+        if (spans == NULL)
+        {
+            return false;
+        }
+
+        thiz->spans = spans;
+        thiz->size = size;
+    }
+
+    thiz->spans[thiz->properties].offset = offset;
+    thiz->spans[thiz->properties].length = thiz->writer.length - offset;
+    thiz->spans[thiz->properties].nameLength = nameLength;
+    thiz->properties++;
+
+    return true;
+}
+
+static void UpnpEventBody_AppendSpan(UpnpEventBody *thiz, UpnpEventBody *from, UpnpEventProperty *span)
+{
+    uint32_t offset = thiz->writer.length;
+
+    SoapWriter_Append(&thiz->writer, from->writer.data + span->offset, span->length);
+
+    if (!UpnpEventBody_AddSpan(thiz, offset, span->nameLength))
+    {
+        thiz->writer.failed = true;
+    }
+}
+
+static bool UpnpEventBody_Carries(UpnpEventBody *thiz, UpnpEventBody *from, UpnpEventProperty *span)
+{
+    const char *name = from->writer.data + span->offset + 1;
+    uint32_t i = 0;
+
+    for (i = 0; i < thiz->properties; i++)
+    {
+        UpnpEventProperty *p = thiz->spans + i;
+        if (p->nameLength == span->nameLength && memcmp(thiz->writer.data + p->offset + 1, name, span->nameLength) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+UpnpEventBody * UpnpEventBody_New(void)
+{
+    UpnpEventBody *thiz = NULL;
+
+    do
+    {
+        thiz = (UpnpEventBody *)tiny_malloc(sizeof(UpnpEventBody));
+        if (thiz == NULL)
+        {
+            break;
+        }
+
+        memset(thiz, 0, sizeof(UpnpEventBody));
+        thiz->ref = 1;
+
+        if (RET_FAILED(TinyMutex_Construct(&thiz->mutex)))
+        {
+            LOG_E(TAG, "TinyMutex_Construct failed");
+            tiny_free(thiz);
+            thiz = NULL;
+            break;
+        }
+
+        if (RET_FAILED(SoapWriter_Construct(&thiz->writer, 512)))
+        {
+            LOG_E(TAG, "SoapWriter_Construct failed");
+            TinyMutex_Dispose(&thiz->mutex);
+            tiny_free(thiz);
+            thiz = NULL;
+            break;
+        }
+
+        SoapWriter_Append(&thiz->writer, EVENT_BODY_HEAD, sizeof(EVENT_BODY_HEAD) - 1);
+    } while (0);
+
+    return thiz;
+}
+
+UpnpEventBody * UpnpEventBody_Retain(UpnpEventBody *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+
+    TinyMutex_Lock(&thiz->mutex);
+    thiz->ref++;
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return thiz;
+}
+
+void UpnpEventBody_Release(UpnpEventBody *thiz)
+{
+    uint32_t ref = 0;
+
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Lock(&thiz->mutex);
+    ref = --thiz->ref;
+    TinyMutex_Unlock(&thiz->mutex);
+
+    if (ref > 0)
+    {
+        return;
+    }
+
+    if (thiz->spans != NULL)
+    {
+        tiny_free(thiz->spans);
+    }
+
+    SoapWriter_Dispose(&thiz->writer);
+    TinyMutex_Dispose(&thiz->mutex);
+    tiny_free(thiz);
+}
+
+void UpnpEventBody_AddProperty(UpnpEventBody *thiz, const char *name, const char *value)
+{
+    uint32_t offset = 0;
+
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(name);
+    RETURN_IF_FAIL(value);
+
+    offset = thiz->writer.length;
+    SoapWriter_AppendArgument(&thiz->writer, name, value);
+
+    if (!UpnpEventBody_AddSpan(thiz, offset, strlen(name)))
+    {
+        thiz->writer.failed = true;
+    }
+}
+
+void UpnpEventBody_AddValue(UpnpEventBody *thiz, const char *name, DataValue *value)
+{
+    uint32_t offset = 0;
+
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(name);
+    RETURN_IF_FAIL(value);
+
+    offset = thiz->writer.length;
+    SoapWriter_AppendValueArgument(&thiz->writer, name, value);
+
+    if (!UpnpEventBody_AddSpan(thiz, offset, strlen(name)))
+    {
+        thiz->writer.failed = true;
+    }
+}
+
+TinyRet UpnpEventBody_Finish(UpnpEventBody *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    SoapWriter_Append(&thiz->writer, EVENT_BODY_TAIL, sizeof(EVENT_BODY_TAIL) - 1);
+
+    return SoapWriter_Finish(&thiz->writer);
+}
+
+uint32_t UpnpEventBody_GetPropertyCount(UpnpEventBody *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, 0);
+
+    return thiz->properties;
+}
+
+const char * UpnpEventBody_GetData(UpnpEventBody *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+
+    return thiz->writer.data;
+}
+
+uint32_t UpnpEventBody_GetLength(UpnpEventBody *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, 0);
+
+    return thiz->writer.length;
+}
+
+UpnpEventBody * UpnpEventBody_FromList(PropertyList *list)
+{
+    UpnpEventBody *thiz = NULL;
+
+    RETURN_VAL_IF_FAIL(list, NULL);
+
+    do
+    {
+        uint32_t count = PropertyList_GetSize(list);
+        uint32_t i = 0;
+
+        thiz = UpnpEventBody_New();
+        if (thiz == NULL)
+        {
+            break;
+        }
+
+        for (i = 0; i < count; ++i)
+        {
+            Property *p = (Property *)PropertyList_GetPropertyAt(list, i);
+            UpnpEventBody_AddProperty(thiz, p->name, p->value);
+        }
+
+        if (RET_FAILED(UpnpEventBody_Finish(thiz)))
+        {
+            UpnpEventBody_Release(thiz);
+            thiz = NULL;
+            break;
+        }
+    } while (0);
+
+    return thiz;
+}
+
+UpnpEventBody * UpnpEventBody_Merge(UpnpEventBody *older, UpnpEventBody *newer)
+{
+    UpnpEventBody *thiz = NULL;
+
+    RETURN_VAL_IF_FAIL(older, NULL);
+    RETURN_VAL_IF_FAIL(newer, NULL);
+
+    do
+    {
+        uint32_t i = 0;
+
+        thiz = UpnpEventBody_New();
+        if (thiz == NULL)
+        {
+            break;
+        }
+
+        for (i = 0; i < older->properties; i++)
+        {
+            if (!UpnpEventBody_Carries(newer, older, older->spans + i))
+            {
+                UpnpEventBody_AppendSpan(thiz, older, older->spans + i);
+            }
+        }
+
+        for (i = 0; i < newer->properties; i++)
+        {
+            UpnpEventBody_AppendSpan(thiz, newer, newer->spans + i);
+        }
+
+        if (RET_FAILED(UpnpEventBody_Finish(thiz)))
+        {
+            UpnpEventBody_Release(thiz);
+            thiz = NULL;
+            break;
+        }
+    } while (0);
+
+    return thiz;
+}
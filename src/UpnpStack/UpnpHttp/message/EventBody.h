@@ -0,0 +1,75 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   EventBody.h
+*
+* @remark
+*
+*/
+
+#ifndef __EVENT_BODY_H__
+#define __EVENT_BODY_H__
+
+#include "tiny_base.h"
+#include "TinyMutex.h"
+#include "soap/SoapWriter.h"
+#include "PropertyList.h"
+
+TINY_BEGIN_DECLS
+
+
+/**
+ * Where one <name>value</name> sits in the serialized body, so two bodies
+ * can be merged without parsing them again.
+ */
+typedef struct _UpnpEventProperty
+{
+    uint32_t                    offset;
+    uint32_t                    length;
+    uint32_t                    nameLength;
+} UpnpEventProperty;
+
+/**
+ * A serialized e:propertyset, written once per change and shared by
+ * reference between the NOTIFY jobs of all subscribers. Immutable after
+ * UpnpEventBody_Finish.
+ */
+typedef struct _UpnpEventBody
+{
+    uint32_t                    ref;
+    TinyMutex                   mutex;
+    uint32_t                    properties;
+    uint32_t                    size;
+    UpnpEventProperty         * spans;
+    SoapWriter                  writer;
+} UpnpEventBody;
+
+UpnpEventBody * UpnpEventBody_New(void);
+UpnpEventBody * UpnpEventBody_Retain(UpnpEventBody *thiz);
+void UpnpEventBody_Release(UpnpEventBody *thiz);
+
+void UpnpEventBody_AddProperty(UpnpEventBody *thiz, const char *name, const char *value);
+void UpnpEventBody_AddValue(UpnpEventBody *thiz, const char *name, DataValue *value);
+TinyRet UpnpEventBody_Finish(UpnpEventBody *thiz);
+uint32_t UpnpEventBody_GetPropertyCount(UpnpEventBody *thiz);
+const char * UpnpEventBody_GetData(UpnpEventBody *thiz);
+uint32_t UpnpEventBody_GetLength(UpnpEventBody *thiz);
+
+/**
+ * a finished body with every property of list, NULL if out of memory
+ */
+UpnpEventBody * UpnpEventBody_FromList(PropertyList *list);
+
+/**
+ * A finished body with the latest value of every variable in both:
+ * older's properties that newer does not carry, then all of newer's.
+ */
+UpnpEventBody * UpnpEventBody_Merge(UpnpEventBody *older, UpnpEventBody *newer);
+
+
+TINY_END_DECLS
+
+#endif /* __EVENT_BODY_H__ */
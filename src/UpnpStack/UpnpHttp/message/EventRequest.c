@@ -14,20 +14,23 @@
 
 #include "EventRequest.h"
 
+/**
+ * The body grows with the event, so no property is dropped for size.
+ */
 TinyRet UpnpEventToRequest(UpnpEvent *event, HttpMessage *request)
 {
     TinyRet ret = TINY_RET_OK;
+    UpnpEventBody *body = NULL;
+
+    RETURN_VAL_IF_FAIL(event, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(request, TINY_RET_E_ARG_NULL);
 
     do
     {
-        char data[1024 * 4];
-        uint32_t size = 0;
-
-        memset(data, 0, 1024 * 4);
-        size = UpnpEvent_ToString(event, data, 1024 * 4);
-        if (size == 0)
+        body = UpnpEventBody_FromList(UpnpEvent_GetArgumentList(event));
+        if (body == NULL)
         {
-            ret = TINY_RET_E_ARG_INVALID;
+            ret = TINY_RET_E_OUT_OF_MEMORY;
             break;
         }
 
@@ -37,10 +40,39 @@ TinyRet UpnpEventToRequest(UpnpEvent *event, HttpMessage *request)
         HttpMessage_SetHeader(request, "nts", UpnpEvent_GetNts(event));
         HttpMessage_SetHeader(request, "sid", UpnpEvent_GetSid(event));
         HttpMessage_SetHeader(request, "seq", UpnpEvent_GetSeq(event));
-        HttpMessage_SetHeaderInteger(request, "Content-Length", size);
-        HttpMessage_SetContentSize(request, size);
-        HttpMessage_AddContentObject(request, data, size);
+        HttpMessage_SetHeaderInteger(request, "Content-Length", UpnpEventBody_GetLength(body));
+        HttpMessage_SetContentSize(request, UpnpEventBody_GetLength(body));
+        HttpMessage_AddContentObject(request, UpnpEventBody_GetData(body), UpnpEventBody_GetLength(body));
     } while (0);
 
+    if (body != NULL)
+    {
+        UpnpEventBody_Release(body);
+    }
+
     return ret;
-}
\ No newline at end of file
+}
+
+TinyRet UpnpEventBodyToRequest(UpnpEventBody *body, const char *callback, const char *sid, uint32_t seq, HttpMessage *request)
+{
+    uint32_t size = 0;
+
+    RETURN_VAL_IF_FAIL(body, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(callback, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(sid, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(request, TINY_RET_E_ARG_NULL);
+
+    size = UpnpEventBody_GetLength(body);
+
+    HttpMessage_SetRequest(request, "NOTIFY", callback);
+    HttpMessage_SetHeader(request, "Content-Type", "text/xml;charset=\"utf-8\"");
+    HttpMessage_SetHeader(request, "nt", "upnp:event");
+    HttpMessage_SetHeader(request, "nts", "upnp:propchange");
+    HttpMessage_SetHeader(request, "sid", sid);
+    HttpMessage_SetHeaderInteger(request, "seq", seq);
+    HttpMessage_SetHeaderInteger(request, "Content-Length", size);
+    HttpMessage_SetContentSize(request, size);
+    HttpMessage_AddContentObject(request, UpnpEventBody_GetData(body), size);
+
+    return TINY_RET_OK;
+}
@@ -18,11 +18,13 @@
 #include "tiny_base.h"
 #include "UpnpEvent.h"
 #include "HttpMessage.h"
+#include "EventBody.h"
 
 TINY_BEGIN_DECLS
 
 
 TinyRet UpnpEventToRequest(UpnpEvent *event, HttpMessage *request);
+TinyRet UpnpEventBodyToRequest(UpnpEventBody *body, const char *callback, const char *sid, uint32_t seq, HttpMessage *request);
 
 
 TINY_END_DECLS
@@ -0,0 +1,372 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   SoapActionDecoder.c
+*
+* @remark
+*
+*/
+
+#include "SoapActionDecoder.h"
+#include "UpnpService.h"
+#include "tiny_memory.h"
+#include "tiny_log.h"
+#include <expat.h>
+
+#define TAG                     "SoapActionDecoder"
+
+#define DEPTH_ENVELOPE          1
+#define DEPTH_BODY              2
+#define DEPTH_ACTION            3
+#define DEPTH_ARGUMENT          4
+
+#define VALUE_INLINE_LEN        256
+
+typedef struct _SoapActionDecoder
+{
+    XML_Parser                  parser;
+    TinyRet                     ret;
+    UpnpAction                * action;
+    UpnpService               * service;
+    PropertyList              * arguments;
+    uint32_t                    depth;
+    bool                        inBody;
+    bool                        inAction;
+    bool                      * seen;
+    uint32_t                    argumentCount;
+    UpnpArgument              * argument;
+    char                        inlineValue[VALUE_INLINE_LEN];
+    char                      * value;
+    uint32_t                    valueLength;
+    uint32_t                    valueSize;
+} SoapActionDecoder;
+
+static void decoder_fail(SoapActionDecoder *thiz, TinyRet ret)
+{
+    if (RET_SUCCEEDED(thiz->ret))
+    {
+        thiz->ret = ret;
+    }
+
+    XML_StopParser(thiz->parser, XML_FALSE);
+}
+
+/**
+ * "s:Envelope" -> "Envelope"
+ */
+static const char * local_name(const XML_Char *name)
+{
+    const char *colon = strchr(name, ':');
+    return (colon != NULL) ? colon + 1 : name;
+}
+
+static int find_in_argument(SoapActionDecoder *thiz, const char *name)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < thiz->argumentCount; i++)
+    {
+        UpnpArgument *argument = UpnpAction_GetArgumentAt(thiz->action, i);
+        if (UpnpArgument_GetDirection(argument) == ARG_IN && STR_EQUAL(UpnpArgument_GetName(argument), name))
+        {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+static void decoder_start(void *userData, const XML_Char *name, const XML_Char **atts)
+{
+    SoapActionDecoder *thiz = (SoapActionDecoder *)userData;
+    const char *local = local_name(name);
+
+    thiz->depth++;
+
+    switch (thiz->depth)
+    {
+    case DEPTH_ENVELOPE:
+        if (!STR_EQUAL(local, "Envelope"))
+        {
+            decoder_fail(thiz, TINY_RET_E_XML_INVALID);
+        }
+        break;
+
+    case DEPTH_BODY:
+        thiz->inBody = STR_EQUAL(local, "Body");
+        break;
+
+    case DEPTH_ACTION:
+        if (!thiz->inBody)
+        {
+            break;
+        }
+
+        if (!STR_EQUAL(local, UpnpAction_GetName(thiz->action)))
+        {
+            LOG_D(TAG, "action mismatch: %s", local);
+            decoder_fail(thiz, TINY_RET_E_UPNP_ACTION_NOT_FOUND);
+            break;
+        }
+
+        thiz->inAction = true;
+        break;
+
+    case DEPTH_ARGUMENT:
+        if (thiz->inAction)
+        {
+            int index = find_in_argument(thiz, local);
+            if (index < 0)
+            {
+                LOG_D(TAG, "unknown argument: %s", local);
+                decoder_fail(thiz, TINY_RET_E_UPNP_ARGUMENT_NOT_FOUND);
+                break;
+            }
+
+            if (thiz->seen[index])
+            {
+                LOG_D(TAG, "duplicate argument: %s", local);
+                decoder_fail(thiz, TINY_RET_E_ARG_INVALID);
+                break;
+            }
+
+            thiz->seen[index] = true;
+            thiz->argument = UpnpAction_GetArgumentAt(thiz->action, index);
+            thiz->valueLength = 0;
+        }
+        break;
+
+    default:
+        if (thiz->argument != NULL)
+        {
+            /**
+             * argument values are simple types
+             */
+            decoder_fail(thiz, TINY_RET_E_XML_INVALID);
+        }
+        break;
+    }
+}
+
+static void decoder_data(void *userData, const XML_Char *s, int len)
+{
+    SoapActionDecoder *thiz = (SoapActionDecoder *)userData;
+    uint32_t need = 0;
+
+    if (thiz->argument == NULL || thiz->depth != DEPTH_ARGUMENT)
+    {
+        return;
+    }
+
+    need = thiz->valueLength + len + 1;
+    if (need > thiz->valueSize)
+    {
+        uint32_t size = thiz->valueSize * 2;
+        char *value = NULL;
+
+        while (size < need)
+        {
+            size *= 2;
+        }
+
+        if (thiz->value == thiz->inlineValue)
+        {
+            value = (char *)tiny_malloc(size);
+            if (value != NULL)
+            {
+                memcpy(value, thiz->value, thiz->valueLength);
+            }
+        }
+        else
+        {
+            value = (char *)tiny_realloc(thiz->value, size);
+        }
+
+        if (value == NULL)
+        {
+            decoder_fail(thiz, TINY_RET_E_OUT_OF_MEMORY);
+            return;
+        }
+
+        thiz->value = value;
+        thiz->valueSize = size;
+    }
+
+    memcpy(thiz->value + thiz->valueLength, s, len);
+    thiz->valueLength += len;
+}
+
+/**
+ * checks the value against the variable's type on a scratch value; only
+ * the definition is read, the value itself is the service lock's
+ */
+static TinyRet decoder_add_argument(SoapActionDecoder *thiz, UpnpStateVariable *state)
+{
+    TinyRet ret = TINY_RET_OK;
+    DataValue scratch;
+
+    DataValue_Construct(&scratch);
+    scratch.internalType = state->definition.dataType.internalType;
+
+    ret = DataValue_SetValue(&scratch, thiz->value);
+    if (RET_SUCCEEDED(ret))
+    {
+        ret = PropertyList_Add(thiz->arguments, UpnpArgument_GetName(thiz->argument), thiz->value);
+    }
+
+    DataValue_Dispose(&scratch);
+
+    return ret;
+}
+
+static void decoder_end(void *userData, const XML_Char *name)
+{
+    SoapActionDecoder *thiz = (SoapActionDecoder *)userData;
+
+    if (thiz->depth == DEPTH_ARGUMENT && thiz->argument != NULL)
+    {
+        const char *related = UpnpArgument_GetRelatedStateVariable(thiz->argument);
+        UpnpStateVariable *state = UpnpService_GetStateVariable(thiz->service, related);
+
+        do
+        {
+            TinyRet ret = TINY_RET_OK;
+
+            if (state == NULL)
+            {
+                LOG_E(TAG, "RelatedStateVariable NOT FOUND: %s", related);
+                decoder_fail(thiz, TINY_RET_E_UPNP_ARGUMENT_NOT_FOUND);
+                break;
+            }
+
+            thiz->value[thiz->valueLength] = 0;
+
+            if (thiz->arguments == NULL)
+            {
+                ret = DataValue_SetValue(&state->value, thiz->value);
+            }
+            else
+            {
+                ret = decoder_add_argument(thiz, state);
+            }
+
+            if (RET_FAILED(ret))
+            {
+                decoder_fail(thiz, ret);
+                break;
+            }
+        } while (0);
+
+        thiz->argument = NULL;
+    }
+    else if (thiz->depth == DEPTH_ACTION && thiz->inAction)
+    {
+        /**
+         * only the first element of Body is the action
+         */
+        XML_StopParser(thiz->parser, XML_FALSE);
+    }
+
+    thiz->depth--;
+}
+
+TinyRet SoapActionDecoder_Decode(UpnpAction *action, PropertyList *arguments, const char *content, uint32_t length)
+{
+    LOG_TIME_BEGIN(TAG, SoapActionDecoder_Decode);
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(action, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(content, TINY_RET_E_ARG_NULL);
+
+    do
+    {
+        SoapActionDecoder decoder;
+        uint32_t i = 0;
+
+        memset(&decoder, 0, sizeof(SoapActionDecoder));
+        decoder.action = action;
+        decoder.service = (UpnpService *)UpnpAction_GetParentService(action);
+        decoder.arguments = arguments;
+        decoder.argumentCount = UpnpAction_GetArgumentCount(action);
+        decoder.value = decoder.inlineValue;
+        decoder.valueSize = VALUE_INLINE_LEN;
+
+        if (decoder.service == NULL)
+        {
+            ret = TINY_RET_E_UPNP_SERVICE_NOT_FOUND;
+            break;
+        }
+
+        if (decoder.argumentCount > 0)
+        {
+            decoder.seen = (bool *)tiny_malloc(sizeof(bool) * decoder.argumentCount);
+            if (decoder.seen == NULL)
+            {
+                ret = TINY_RET_E_OUT_OF_MEMORY;
+                break;
+            }
+
+            memset(decoder.seen, 0, sizeof(bool) * decoder.argumentCount);
+        }
+
+        decoder.parser = XML_ParserCreate(NULL);
+        if (decoder.parser == NULL)
+        {
+            if (decoder.seen != NULL)
+            {
+                tiny_free(decoder.seen);
+            }
+
+            ret = TINY_RET_E_OUT_OF_MEMORY;
+            break;
+        }
+
+        XML_SetElementHandler(decoder.parser, decoder_start, decoder_end);
+        XML_SetCharacterDataHandler(decoder.parser, decoder_data);
+        XML_SetUserData(decoder.parser, &decoder);
+
+        if (XML_Parse(decoder.parser, content, length, 1) == XML_STATUS_ERROR)
+        {
+            /**
+             * stopped by us after the action element is not an error
+             */
+            if (XML_GetErrorCode(decoder.parser) != XML_ERROR_ABORTED || RET_FAILED(decoder.ret))
+            {
+                ret = RET_FAILED(decoder.ret) ? decoder.ret : TINY_RET_E_XML_INVALID;
+            }
+        }
+
+        XML_ParserFree(decoder.parser);
+
+        if (RET_SUCCEEDED(ret) && !decoder.inAction)
+        {
+            ret = TINY_RET_E_NOT_FOUND;
+        }
+
+        for (i = 0; RET_SUCCEEDED(ret) && i < decoder.argumentCount; i++)
+        {
+            UpnpArgument *argument = UpnpAction_GetArgumentAt(action, i);
+            if (UpnpArgument_GetDirection(argument) == ARG_IN && !decoder.seen[i])
+            {
+                LOG_D(TAG, "argument missing: %s", UpnpArgument_GetName(argument));
+                ret = TINY_RET_E_UPNP_ARGUMENT_NOT_FOUND;
+            }
+        }
+
+        if (decoder.value != decoder.inlineValue)
+        {
+            tiny_free(decoder.value);
+        }
+
+        if (decoder.seen != NULL)
+        {
+            tiny_free(decoder.seen);
+        }
+    } while (0);
+
+    LOG_TIME_END(TAG, SoapActionDecoder_Decode);
+    return ret;
+}
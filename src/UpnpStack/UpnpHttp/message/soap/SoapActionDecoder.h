@@ -0,0 +1,36 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   SoapActionDecoder.h
+*
+* @remark
+*
+*/
+
+#ifndef __SOAP_ACTION_DECODER_H__
+#define __SOAP_ACTION_DECODER_H__
+
+#include "tiny_base.h"
+#include "UpnpAction.h"
+#include "PropertyList.h"
+
+TINY_BEGIN_DECLS
+
+
+/**
+ * Decodes a SOAP control request straight into the in arguments of action
+ * (their related state variables), from expat callbacks, without building
+ * a document tree. The action element must match the action's name, and
+ * every argument element must name one of its in arguments.
+ * With arguments set, the values go there instead, type-checked, and
+ * the service's state variables are not touched.
+ */
+TinyRet SoapActionDecoder_Decode(UpnpAction *action, PropertyList *arguments, const char *content, uint32_t length);
+
+
+TINY_END_DECLS
+
+#endif /* __SOAP_ACTION_DECODER_H__ */
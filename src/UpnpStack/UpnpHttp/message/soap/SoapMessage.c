@@ -322,94 +322,62 @@ s:encodingStyle="http://schemas.xmlsoap.org/soap/encoding/">
 </s:Envelope>
 */
 
-#define XML_VERSION                     "<?xml version = \"1.0\"?>\n"
-#define SOAP_ENVELOPE_BEGIN             "<s:Envelope"
-#define SOAP_ENVELOPE_BEGIN_XMLNS       " xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\""
-#define SOAP_ENVELOPE_BEGIN_ENCODING    " s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\">\n"
-#define SOAP_ENVELOPE_END               "</s:Envelope>\n"
-#define SOAP_BODY_BEGIN                 "<s:Body>\n"
-#define SOAP_BODY_END                   "</s:Body>\n"
-#define SOAP_ACTION_BEGIN               "<u:%s xmlns:u=\"%s\">\n"
-#define SOAP_ACTION_END                 "</u:%s>\n"
+TinyRet SoapMessage_Write(SoapMessage *thiz, SoapWriter *writer)
+{
+    uint32_t i = 0;
+    uint32_t count = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(writer, TINY_RET_E_ARG_NULL);
+
+    SoapWriter_AppendEnvelopeBegin(writer, thiz->actionName, "", thiz->actionXmlns);
+
+    count = PropertyList_GetSize(thiz->argumentList);
+    for (i = 0; i < count; i++)
+    {
+        Property *property = PropertyList_GetPropertyAt(thiz->argumentList, i);
+        SoapWriter_AppendArgument(writer, property->name, property->value);
+    }
+
+    SoapWriter_AppendEnvelopeEnd(writer, thiz->actionName, "");
+
+    return SoapWriter_Finish(writer);
+}
 
 TinyRet SoapMessage_ToString(SoapMessage *thiz, char *bytes, uint32_t len)
 {
     TinyRet ret = TINY_RET_OK;
+    SoapWriter writer;
 
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(bytes, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(len, TINY_RET_E_ARG_NULL);
 
-    do
+    ret = SoapWriter_Construct(&writer, len);
+    if (RET_FAILED(ret))
     {
-        uint32_t i = 0;
-        uint32_t count = 0;
-        int32_t unused = 0;
-        char *p = NULL;
-
-        tiny_snprintf(bytes, len, "%s%s%s%s%s",
-            XML_VERSION,
-            SOAP_ENVELOPE_BEGIN,
-            SOAP_ENVELOPE_BEGIN_XMLNS,
-            SOAP_ENVELOPE_BEGIN_ENCODING,
-            SOAP_BODY_BEGIN);
-        bytes[len - 1] = 0;
-
-        p = bytes + strlen(bytes);
-        unused = len - (p - bytes);
-        if (unused < 0)
-        {
-            ret = TINY_RET_E_ARG_INVALID;
-            break;
-        }
-
-        tiny_snprintf(p, unused, SOAP_ACTION_BEGIN, thiz->actionName, thiz->actionXmlns);
-        p[unused - 1] = 0;
+        return ret;
+    }
 
-        p += strlen(p);
-        unused = len - (p - bytes);
-        if (unused < 0)
+    do
+    {
+        ret = SoapMessage_Write(thiz, &writer);
+        if (RET_FAILED(ret))
         {
-            ret = TINY_RET_E_ARG_INVALID;
             break;
         }
 
-        count = PropertyList_GetSize(thiz->argumentList);
-        for (i = 0; i < count; i++)
-        {
-            Property *property = PropertyList_GetPropertyAt(thiz->argumentList, i);
-            tiny_snprintf(p, unused, "<%s>%s</%s>\n", property->name, property->value, property->name);
-
-            p[unused - 1] = 0;
-
-            p += strlen(p);
-            unused = len - (p - bytes);
-
-            if (unused < 0)
-            {
-                ret = TINY_RET_E_ARG_INVALID;
-                break;
-            }
-        }
-
-        tiny_snprintf(p, unused, SOAP_ACTION_END, thiz->actionName);
-        p[unused - 1] = 0;
-
-        p += strlen(p);
-        unused = len - (p - bytes);
-        if (unused < 0)
+        if (writer.length >= len)
         {
             ret = TINY_RET_E_ARG_INVALID;
             break;
         }
 
-        tiny_snprintf(p, unused, "%s%s",
-            SOAP_BODY_END,
-            SOAP_ENVELOPE_END);
-        p[unused - 1] = 0;
-
+        memcpy(bytes, writer.data, writer.length + 1);
     } while (0);
 
+    SoapWriter_Dispose(&writer);
+
     return ret;
 }
 
@@ -18,6 +18,7 @@
 #include "tiny_base.h"
 #include "upnp_define.h"
 #include "PropertyList.h"
+#include "SoapWriter.h"
 
 TINY_BEGIN_DECLS
 
@@ -34,6 +35,7 @@ PropertyList *SoapMessage_GetFault(SoapMessage *thiz);
 TinyRet SoapMessage_ParseRequest(SoapMessage *thiz, const char *bytes, uint32_t len);
 TinyRet SoapMessage_ParseResponse(SoapMessage *thiz, const char *bytes, uint32_t len);
 TinyRet SoapMessage_ToString(SoapMessage *thiz, char *bytes, uint32_t len);
+TinyRet SoapMessage_Write(SoapMessage *thiz, SoapWriter *writer);
 
 TinyRet SoapMessage_SetServerURL(SoapMessage *thiz, const char *serverURL);
 TinyRet SoapMessage_SetActionName(SoapMessage *thiz, const char *actionName);
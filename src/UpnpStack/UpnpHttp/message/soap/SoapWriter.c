@@ -0,0 +1,307 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   SoapWriter.c
+*
+* @remark
+*
+*/
+
+#include "SoapWriter.h"
+#include "tiny_memory.h"
+#include "tiny_log.h"
+
+#define TAG                             "SoapWriter"
+
+#define XML_VERSION                     "<?xml version = \"1.0\"?>\n"
+#define SOAP_ENVELOPE_BEGIN             "<s:Envelope"
+#define SOAP_ENVELOPE_BEGIN_XMLNS       " xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\""
+#define SOAP_ENVELOPE_BEGIN_ENCODING    " s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\">\n"
+#define SOAP_ENVELOPE_END               "</s:Envelope>\n"
+#define SOAP_BODY_BEGIN                 "<s:Body>\n"
+#define SOAP_BODY_END                   "</s:Body>\n"
+
+#define SOAP_HEAD                       XML_VERSION SOAP_ENVELOPE_BEGIN SOAP_ENVELOPE_BEGIN_XMLNS SOAP_ENVELOPE_BEGIN_ENCODING SOAP_BODY_BEGIN
+#define SOAP_TAIL                       SOAP_BODY_END SOAP_ENVELOPE_END
+
+#define LITERAL(s)                      s, (sizeof(s) - 1)
+
+/**
+ * index into escapes[], 0 for bytes copied as they are: & < > " '
+ */
+static const uint8_t escape_table[256] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 4, 0, 0, 0, 1, 5, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 3, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const struct
+{
+    const char *bytes;
+    uint32_t length;
+} escapes[] =
+{
+    { "", 0 },
+    { LITERAL("&amp;") },
+    { LITERAL("&lt;") },
+    { LITERAL("&gt;") },
+    { LITERAL("&quot;") },
+    { LITERAL("&apos;") },
+};
+
+static bool SoapWriter_Reserve(SoapWriter *thiz, uint32_t length)
+{
+    uint32_t need = thiz->length + length + 1;
+    uint32_t size = 0;
+    char *data = NULL;
+
+    if (thiz->failed)
+    {
+        return false;
+    }
+
+    if (need <= thiz->size)
+    {
+        return true;
+    }
+
+    size = (thiz->size > 0) ? thiz->size : 256;
+    while (size < need)
+    {
+        size *= 2;
+    }
+
+    data = (char *)tiny_realloc(thiz->data, size);
+    if (data == NULL)
+    {
+        LOG_E(TAG, "tiny_realloc failed: %d", size);
+        thiz->failed = true;
+        return false;
+    }
+
+    thiz->data = data;
+    thiz->size = size;
+
+    return true;
+}
+
+TinyRet SoapWriter_Construct(SoapWriter *thiz, uint32_t size)
+{
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    memset(thiz, 0, sizeof(SoapWriter));
+
+    if (!SoapWriter_Reserve(thiz, size))
+    {
+        return TINY_RET_E_OUT_OF_MEMORY;
+    }
+
+    thiz->data[0] = 0;
+
+    return TINY_RET_OK;
+}
+
+void SoapWriter_Dispose(SoapWriter *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    if (thiz->data != NULL)
+    {
+        tiny_free(thiz->data);
+    }
+
+    memset(thiz, 0, sizeof(SoapWriter));
+}
+
+void SoapWriter_Append(SoapWriter *thiz, const char *bytes, uint32_t length)
+{
+    if (!SoapWriter_Reserve(thiz, length))
+    {
+        return;
+    }
+
+    memcpy(thiz->data + thiz->length, bytes, length);
+    thiz->length += length;
+    thiz->data[thiz->length] = 0;
+}
+
+void SoapWriter_AppendString(SoapWriter *thiz, const char *string)
+{
+    SoapWriter_Append(thiz, string, strlen(string));
+}
+
+/**
+ * copies runs of plain bytes with one memcpy each
+ */
+void SoapWriter_AppendEscaped(SoapWriter *thiz, const char *value)
+{
+    const uint8_t *run = (const uint8_t *)value;
+    const uint8_t *p = run;
+
+    while (true)
+    {
+        while (*p != 0 && escape_table[*p] == 0)
+        {
+            p++;
+        }
+
+        if (p > run)
+        {
+            SoapWriter_Append(thiz, (const char *)run, (uint32_t)(p - run));
+        }
+
+        if (*p == 0)
+        {
+            break;
+        }
+
+        SoapWriter_Append(thiz, escapes[escape_table[*p]].bytes, escapes[escape_table[*p]].length);
+        run = ++p;
+    }
+}
+
+void SoapWriter_AppendValue(SoapWriter *thiz, DataValue *value)
+{
+    char c[2];
+
+    switch (value->internalType)
+    {
+    case INTERNAL_UNDEFINED:
+        break;
+
+    case INTERNAL_STRING:
+        if (value->internalValue.stringValue != NULL)
+        {
+            SoapWriter_AppendEscaped(thiz, value->internalValue.stringValue);
+        }
+        break;
+
+    case INTERNAL_CHAR:
+        c[0] = value->internalValue.charValue;
+        c[1] = 0;
+        SoapWriter_AppendEscaped(thiz, c);
+        break;
+
+    default:
+        if (SoapWriter_Reserve(thiz, DATA_VALUE_FORMAT_LEN))
+        {
+            thiz->length += DataValue_Format(value, thiz->data + thiz->length);
+        }
+        break;
+    }
+}
+
+TinyRet SoapWriter_Finish(SoapWriter *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    return thiz->failed ? TINY_RET_E_OUT_OF_MEMORY : TINY_RET_OK;
+}
+
+void SoapWriter_AppendEnvelopeBegin(SoapWriter *thiz, const char *actionName, const char *nameSuffix, const char *actionXmlns)
+{
+    SoapWriter_Append(thiz, LITERAL(SOAP_HEAD));
+    SoapWriter_Append(thiz, LITERAL("<u:"));
+    SoapWriter_AppendString(thiz, actionName);
+    SoapWriter_AppendString(thiz, nameSuffix);
+    SoapWriter_Append(thiz, LITERAL(" xmlns:u=\""));
+    SoapWriter_AppendEscaped(thiz, actionXmlns);
+    SoapWriter_Append(thiz, LITERAL("\">\n"));
+}
+
+void SoapWriter_AppendEnvelopeEnd(SoapWriter *thiz, const char *actionName, const char *nameSuffix)
+{
+    SoapWriter_Append(thiz, LITERAL("</u:"));
+    SoapWriter_AppendString(thiz, actionName);
+    SoapWriter_AppendString(thiz, nameSuffix);
+    SoapWriter_Append(thiz, LITERAL(">\n"));
+    SoapWriter_Append(thiz, LITERAL(SOAP_TAIL));
+}
+
+void SoapWriter_AppendArgument(SoapWriter *thiz, const char *name, const char *value)
+{
+    uint32_t length = strlen(name);
+
+    SoapWriter_Append(thiz, "<", 1);
+    SoapWriter_Append(thiz, name, length);
+    SoapWriter_Append(thiz, ">", 1);
+    SoapWriter_AppendEscaped(thiz, value);
+    SoapWriter_Append(thiz, "</", 2);
+    SoapWriter_Append(thiz, name, length);
+    SoapWriter_Append(thiz, ">\n", 2);
+}
+
+void SoapWriter_AppendValueArgument(SoapWriter *thiz, const char *name, DataValue *value)
+{
+    uint32_t length = strlen(name);
+
+    SoapWriter_Append(thiz, "<", 1);
+    SoapWriter_Append(thiz, name, length);
+    SoapWriter_Append(thiz, ">", 1);
+    SoapWriter_AppendValue(thiz, value);
+    SoapWriter_Append(thiz, "</", 2);
+    SoapWriter_Append(thiz, name, length);
+    SoapWriter_Append(thiz, ">\n", 2);
+}
+
+SoapTemplate * SoapTemplate_New(const char *actionName, const char *nameSuffix, const char *actionXmlns)
+{
+    SoapTemplate *thiz = NULL;
+    SoapWriter writer;
+
+    RETURN_VAL_IF_FAIL(actionName, NULL);
+    RETURN_VAL_IF_FAIL(nameSuffix, NULL);
+    RETURN_VAL_IF_FAIL(actionXmlns, NULL);
+
+    if (RET_FAILED(SoapWriter_Construct(&writer, 512)))
+    {
+        return NULL;
+    }
+
+    do
+    {
+        uint32_t prefixLength = 0;
+
+        SoapWriter_AppendEnvelopeBegin(&writer, actionName, nameSuffix, actionXmlns);
+        prefixLength = writer.length;
+        SoapWriter_AppendEnvelopeEnd(&writer, actionName, nameSuffix);
+
+        if (RET_FAILED(SoapWriter_Finish(&writer)))
+        {
+            break;
+        }
+
+        thiz = (SoapTemplate *)tiny_malloc(sizeof(SoapTemplate) + writer.length + 1);
+        if (thiz == NULL)
+        {
+            break;
+        }
+
+        thiz->prefix = (char *)(thiz + 1);
+        thiz->prefixLength = prefixLength;
+        thiz->suffix = thiz->prefix + prefixLength;
+        thiz->suffixLength = writer.length - prefixLength;
+        memcpy(thiz->prefix, writer.data, writer.length + 1);
+    } while (0);
+
+    SoapWriter_Dispose(&writer);
+
+    return thiz;
+}
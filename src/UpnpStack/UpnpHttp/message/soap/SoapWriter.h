@@ -0,0 +1,70 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   SoapWriter.h
+*
+* @remark
+*
+*/
+
+#ifndef __SOAP_WRITER_H__
+#define __SOAP_WRITER_H__
+
+#include "tiny_base.h"
+#include "DataValue.h"
+
+TINY_BEGIN_DECLS
+
+
+/**
+ * Growable output buffer that tracks its length. A failed allocation is
+ * sticky: later appends are ignored and SoapWriter_Finish reports it.
+ */
+typedef struct _SoapWriter
+{
+    char                      * data;
+    uint32_t                    length;
+    uint32_t                    size;
+    bool                        failed;
+} SoapWriter;
+
+TinyRet SoapWriter_Construct(SoapWriter *thiz, uint32_t size);
+void SoapWriter_Dispose(SoapWriter *thiz);
+
+void SoapWriter_Append(SoapWriter *thiz, const char *bytes, uint32_t length);
+void SoapWriter_AppendString(SoapWriter *thiz, const char *string);
+void SoapWriter_AppendEscaped(SoapWriter *thiz, const char *value);
+
+/**
+ * numbers and booleans are formatted in place, at the end of data
+ */
+void SoapWriter_AppendValue(SoapWriter *thiz, DataValue *value);
+TinyRet SoapWriter_Finish(SoapWriter *thiz);
+
+/**
+ * Envelope bytes around the arguments of one action element, rendered
+ * once: prefix is everything up to and including the action start tag,
+ * suffix the action end tag to the end of the envelope. One allocation,
+ * released with tiny_free.
+ */
+typedef struct _SoapTemplate
+{
+    uint32_t                    prefixLength;
+    uint32_t                    suffixLength;
+    char                      * prefix;
+    char                      * suffix;
+} SoapTemplate;
+
+SoapTemplate * SoapTemplate_New(const char *actionName, const char *nameSuffix, const char *actionXmlns);
+void SoapWriter_AppendEnvelopeBegin(SoapWriter *thiz, const char *actionName, const char *nameSuffix, const char *actionXmlns);
+void SoapWriter_AppendEnvelopeEnd(SoapWriter *thiz, const char *actionName, const char *nameSuffix);
+void SoapWriter_AppendArgument(SoapWriter *thiz, const char *name, const char *value);
+void SoapWriter_AppendValueArgument(SoapWriter *thiz, const char *name, DataValue *value);
+
+
+TINY_END_DECLS
+
+#endif /* __SOAP_WRITER_H__ */
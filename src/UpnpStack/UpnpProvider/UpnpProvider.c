@@ -18,10 +18,12 @@
 #include "UpnpDeviceParser.h"
 #include "UpnpServiceParser.h"
 #include "tiny_str_split.h"
+#include "message/ActionResponse.h"
 
 #define TAG     "UpnpProvider"
 
-static uint32_t UpnpProvider_GetServiceDocument(UpnpProvider *thiz, UpnpDevice *device, const char *uri, char *content, uint32_t len);
+static TinyRet UpnpProvider_AddRoutes(UpnpProvider *thiz, UpnpDevice *device, UpnpActionHandlerContext *context);
+static TinyRet UpnpProvider_AddDevice(UpnpProvider *thiz, UpnpDevice *device, UpnpActionHandler handler, UpnpAsyncActionHandler asyncHandler, void *ctx);
 
 static void device_delete_listener(void * data, void *ctx)
 {
@@ -31,7 +33,11 @@ static void device_delete_listener(void * data, void *ctx)
 static void handler_delete_listener(void *data, void *ctx)
 {
     UpnpActionHandlerContext *context = (UpnpActionHandlerContext *)data;
-    tiny_free(context);
+
+    if (!context->removed)
+    {
+        tiny_free(context);
+    }
 }
 
 static void observer_delete_listener(void *data, void *ctx)
@@ -92,7 +98,13 @@ TinyRet UpnpProvider_Construct(UpnpProvider *thiz)
     {
         memset(thiz, 0, sizeof(UpnpProvider));
 
-        ret = TinyMutex_Construct(&thiz->mutex);
+        ret = TinyRwLock_Construct(&thiz->lock);
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+
+        ret = TinyMutex_Construct(&thiz->busyMutex);
         if (RET_FAILED(ret))
         {
             break;
@@ -130,6 +142,15 @@ TinyRet UpnpProvider_Construct(UpnpProvider *thiz)
         }
 
         TinyMap_SetDeleteListener(&thiz->observers, observer_delete_listener, NULL);
+
+        /**
+         * routes
+         */
+        ret = UpnpRouteTable_Construct(&thiz->routes);
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
     } while (0);
 
     return ret;
@@ -139,7 +160,9 @@ TinyRet UpnpProvider_Dispose(UpnpProvider *thiz)
 {
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
 
-    TinyMutex_Dispose(&thiz->mutex);
+    TinyRwLock_Dispose(&thiz->lock);
+    TinyMutex_Dispose(&thiz->busyMutex);
+    UpnpRouteTable_Dispose(&thiz->routes);
     TinyMap_Dispose(&thiz->handlers);
     TinyMap_Dispose(&thiz->devices);
 
@@ -156,12 +179,22 @@ void UpnpProvider_Delete(UpnpProvider *thiz)
 
 void UpnpProvider_Lock(UpnpProvider *thiz)
 {
-    TinyMutex_Lock(&thiz->mutex);
+    TinyRwLock_WriteLock(&thiz->lock);
 }
 
 void UpnpProvider_Unlock(UpnpProvider *thiz)
 {
-    TinyMutex_Unlock(&thiz->mutex);
+    TinyRwLock_WriteUnlock(&thiz->lock);
+}
+
+void UpnpProvider_ReadLock(UpnpProvider *thiz)
+{
+    TinyRwLock_ReadLock(&thiz->lock);
+}
+
+void UpnpProvider_ReadUnlock(UpnpProvider *thiz)
+{
+    TinyRwLock_ReadUnlock(&thiz->lock);
 }
 
 TinyRet UpnpProvider_AddObserver(UpnpProvider *thiz,
@@ -269,6 +302,7 @@ void UpnpProvider_Foreach(UpnpProvider *thiz, const char *st, DeviceVisitor OnDe
 
 void UpnpProvider_Clear(UpnpProvider *thiz)
 {
+     UpnpRouteTable_Clear(&thiz->routes);
      TinyMap_Clear(&thiz->devices);
 }
 
@@ -282,12 +316,26 @@ UpnpDevice * UpnpProvider_GetDevice(UpnpProvider *thiz, const char *deviceId)
 
 TinyRet UpnpProvider_Add(UpnpProvider *thiz, UpnpDevice *device, UpnpActionHandler handler, void *ctx)
 {
-    TinyRet ret = TINY_RET_OK;
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(device, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(handler, TINY_RET_E_ARG_NULL);
+
+    return UpnpProvider_AddDevice(thiz, device, handler, NULL, ctx);
+}
 
+TinyRet UpnpProvider_AddAsync(UpnpProvider *thiz, UpnpDevice *device, UpnpAsyncActionHandler handler, void *ctx)
+{
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(device, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(handler, TINY_RET_E_ARG_NULL);
 
+    return UpnpProvider_AddDevice(thiz, device, NULL, handler, ctx);
+}
+
+static TinyRet UpnpProvider_AddDevice(UpnpProvider *thiz, UpnpDevice *device, UpnpActionHandler handler, UpnpAsyncActionHandler asyncHandler, void *ctx)
+{
+    TinyRet ret = TINY_RET_OK;
+
     do
     {
         UpnpActionHandlerContext *context = NULL;
@@ -320,7 +368,11 @@ TinyRet UpnpProvider_Add(UpnpProvider *thiz, UpnpDevice *device, UpnpActionHandl
         }
 
         context->handler = handler;
+        context->asyncHandler = asyncHandler;
         context->ctx = ctx;
+        context->busy = 0;
+        context->drained = NULL;
+        context->removed = false;
 
         ret = TinyMap_Insert(&thiz->handlers, deviceId, context);
         if (RET_FAILED(ret))
@@ -329,6 +381,15 @@ TinyRet UpnpProvider_Add(UpnpProvider *thiz, UpnpDevice *device, UpnpActionHandl
             break;
         }
 
+        ret = UpnpProvider_AddRoutes(thiz, device, context);
+        if (RET_FAILED(ret))
+        {
+            UpnpRouteTable_RemoveDevice(&thiz->routes, device);
+            TinyMap_Erase(&thiz->handlers, deviceId);
+            TinyMap_Erase(&thiz->devices, deviceId);
+            break;
+        }
+
         /**
          * Notify
          */
@@ -355,12 +416,15 @@ TinyRet UpnpProvider_Add(UpnpProvider *thiz, UpnpDevice *device, UpnpActionHandl
     return ret;
 }
 
-TinyRet UpnpProvider_Remove(UpnpProvider *thiz, const char *deviceId)
+TinyRet UpnpProvider_Remove(UpnpProvider *thiz, const char *deviceId, UpnpActionHandlerContext **context)
 {
     TinyRet ret = TINY_RET_OK;
 
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(deviceId, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(context, TINY_RET_E_ARG_NULL);
+
+    *context = NULL;
 
     do
     {
@@ -397,17 +461,33 @@ TinyRet UpnpProvider_Remove(UpnpProvider *thiz, const char *deviceId)
         }
 
         /**
-         * delete device & handler
+         * delete routes, device & handler
          */
+        UpnpRouteTable_RemoveDevice(&thiz->routes, device);
+
         ret = TinyMap_Erase(&thiz->devices, deviceId);
         if (RET_FAILED(ret))
         {
             break;
         }
 
+        /**
+         * no new action can find the device now; the ones in flight still
+         * hold the context, so it leaves the map without being freed
+         */
+        *context = (UpnpActionHandlerContext *)TinyMap_GetValue(&thiz->handlers, deviceId);
+        if (*context == NULL)
+        {
+            break;
+        }
+
+        (*context)->removed = true;
+
         ret = TinyMap_Erase(&thiz->handlers, deviceId);
         if (RET_FAILED(ret))
         {
+            (*context)->removed = false;
+            *context = NULL;
             break;
         }
     } while (0);
@@ -415,61 +495,106 @@ TinyRet UpnpProvider_Remove(UpnpProvider *thiz, const char *deviceId)
     return ret;
 }
 
-uint32_t UpnpProvider_GetDocument(UpnpProvider *thiz, const char *uri, char *content, uint32_t len)
+static TinyRet UpnpProvider_AddRoute(UpnpProvider *thiz, UpnpRouteType type, const char *url, UpnpDevice *device, UpnpService *service, UpnpActionHandlerContext *context)
 {
-    uint32_t ret = 0;
+    TinyRet ret = TINY_RET_OK;
 
-    RETURN_VAL_IF_FAIL(thiz, 0);
-    RETURN_VAL_IF_FAIL(content, 0);
+    /**
+     * optional URLs (e.g. no eventing) are left empty
+     */
+    if (url == NULL || url[0] == 0)
+    {
+        return TINY_RET_OK;
+    }
 
-    do
+    ret = UpnpRouteTable_Add(&thiz->routes, type, url, device, service, context);
+    if (RET_FAILED(ret))
     {
-        uint32_t i = 0;
-        uint32_t count = TinyMap_GetCount(&thiz->devices);
+        LOG_D(TAG, "URL in use: %s", url);
+    }
 
-        for (i = 0; i < count; i++)
+    return ret;
+}
+
+/**
+ * render the response envelopes now, while nothing else can see the service
+ */
+static void UpnpProvider_PrepareActions(UpnpService *service)
+{
+    uint32_t count = UpnpService_GetActionCount(service);
+    uint32_t i = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        if (RET_FAILED(ActionResponse_Prepare(UpnpService_GetActionAt(service, i))))
         {
-            UpnpDevice *device = (UpnpDevice *)TinyMap_GetValueAt(&thiz->devices, i);
+            LOG_D(TAG, "ActionResponse_Prepare failed");
+        }
+    }
+}
 
-            if (STR_EQUAL(uri, UpnpDevice_GetURI(device)))
-            {
-                ret = UpnpDeviceParser_ToXml(device, content, len);
-                break;
-            }
+static TinyRet UpnpProvider_AddRoutes(UpnpProvider *thiz, UpnpDevice *device, UpnpActionHandlerContext *context)
+{
+    TinyRet ret = TINY_RET_OK;
+    uint32_t count = UpnpDevice_GetServiceCount(device);
+    uint32_t i = 0;
 
-            ret = UpnpProvider_GetServiceDocument(thiz, device, uri, content, len);
-            if (ret > 0)
-            {
-                break;
-            }
+    ret = UpnpProvider_AddRoute(thiz, ROUTE_DEVICE_DESCRIPTION, UpnpDevice_GetURI(device), device, NULL, context);
+    if (RET_FAILED(ret))
+    {
+        return ret;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        UpnpService *service = UpnpDevice_GetServiceAt(device, i);
+
+        ret = UpnpProvider_AddRoute(thiz, ROUTE_SCPD, UpnpService_GetSCPDURL(service), device, service, context);
+        if (RET_FAILED(ret))
+        {
+            break;
         }
-    } while (0);
+
+        ret = UpnpProvider_AddRoute(thiz, ROUTE_CONTROL, UpnpService_GetControlURL(service), device, service, context);
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+
+        UpnpProvider_PrepareActions(service);
+
+        ret = UpnpProvider_AddRoute(thiz, ROUTE_EVENT_SUB, UpnpService_GetEventSubURL(service), device, service, context);
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+    }
 
     return ret;
 }
 
-static uint32_t UpnpProvider_GetServiceDocument(UpnpProvider *thiz, UpnpDevice *device, const char *uri, char *content, uint32_t len)
+uint32_t UpnpProvider_GetDocument(UpnpProvider *thiz, const char *uri, char *content, uint32_t len)
 {
     uint32_t ret = 0;
 
     RETURN_VAL_IF_FAIL(thiz, 0);
+    RETURN_VAL_IF_FAIL(uri, 0);
     RETURN_VAL_IF_FAIL(content, 0);
 
     do
     {
-        uint32_t count = UpnpDevice_GetServiceCount(device);
-        uint32_t i = 0;
-
-        for (i = 0; i < count; i++)
+        UpnpRoute *route = UpnpRouteTable_Get(&thiz->routes, ROUTE_DEVICE_DESCRIPTION, uri);
+        if (route != NULL)
         {
-            UpnpService *service = UpnpDevice_GetServiceAt(device, i);
-            const char *scpd = UpnpService_GetSCPDURL(service);
+            ret = UpnpDeviceParser_ToXml(route->device, content, len);
+            break;
+        }
 
-            if (STR_EQUAL(uri, scpd))
-            {
-                ret = UpnpServiceParser_ToXml(service, content, len);
-                break;
-            }
+        route = UpnpRouteTable_Get(&thiz->routes, ROUTE_SCPD, uri);
+        if (route != NULL)
+        {
+            ret = UpnpServiceParser_ToXml(route->service, content, len);
+            break;
         }
     } while (0);
 
@@ -478,41 +603,30 @@ static uint32_t UpnpProvider_GetServiceDocument(UpnpProvider *thiz, UpnpDevice *
 
 UpnpAction * UpnpProvider_GetAction(UpnpProvider *thiz, const char *controlURL, const char *serviceType, const char *actionName)
 {
-    RETURN_VAL_IF_FAIL(thiz, 0);
-    RETURN_VAL_IF_FAIL(controlURL, 0);
-    RETURN_VAL_IF_FAIL(serviceType, 0);
-    RETURN_VAL_IF_FAIL(actionName, 0);
+    UpnpAction *action = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+    RETURN_VAL_IF_FAIL(controlURL, NULL);
+    RETURN_VAL_IF_FAIL(serviceType, NULL);
+    RETURN_VAL_IF_FAIL(actionName, NULL);
 
     do
     {
-        uint32_t i = 0;
-        uint32_t count = TinyMap_GetCount(&thiz->devices);
-
-        for (i = 0; i < count; i++)
+        UpnpRoute *route = UpnpRouteTable_Get(&thiz->routes, ROUTE_CONTROL, controlURL);
+        if (route == NULL)
         {
+            break;
+        }
 
-            UpnpDevice *device = NULL;
-            UpnpService *service = NULL;
-            UpnpAction * action = NULL;
-
-            device = (UpnpDevice *)TinyMap_GetValueAt(&thiz->devices, i);
-
-            service = UpnpDevice_GetServiceByControlURL(device, controlURL);
-            if (service == NULL)
-            {
-                continue;
-            }
-
-            if (STR_EQUAL(UpnpService_GetServiceType(service), serviceType))
-            {
-                return UpnpService_GetAction(service, actionName);
-            }
-
-            return NULL;
+        if (!STR_EQUAL(UpnpService_GetServiceType(route->service), serviceType))
+        {
+            break;
         }
+
+        action = UpnpService_GetAction(route->service, actionName);
     } while (0);
 
-    return NULL;
+    return action;
 }
 
 UpnpActionHandlerContext * UpnpProvider_GetActionHandlerContext(UpnpProvider *thiz, UpnpAction *action)
@@ -524,8 +638,8 @@ UpnpActionHandlerContext * UpnpProvider_GetActionHandlerContext(UpnpProvider *th
 
     do
     {
-        UpnpDevice *device = NULL;
         UpnpService *service = NULL;
+        UpnpRoute *route = NULL;
         
         service = UpnpAction_GetParentService(action);
         if (service == NULL)
@@ -533,42 +647,111 @@ UpnpActionHandlerContext * UpnpProvider_GetActionHandlerContext(UpnpProvider *th
             break;
         }
 
-        device = UpnpService_GetParentDevice(service);
-        if (device == NULL)
+        route = UpnpRouteTable_Get(&thiz->routes, ROUTE_CONTROL, UpnpService_GetControlURL(service));
+        if (route == NULL)
         {
             break;
         }
 
-        context = (UpnpActionHandlerContext *)TinyMap_GetValue(&thiz->handlers, UpnpDevice_GetDeviceId(device));
+        context = (UpnpActionHandlerContext *)route->data;
     } while (0);
 
     return context;
 }
 
-UpnpService * UpnpProvider_GetService(UpnpProvider *thiz, const char *eventSubURL)
+UpnpActionHandlerContext * UpnpProvider_AcquireAction(UpnpProvider *thiz, const char *uri, const char *serviceType, const char *actionName, UpnpAction **action)
 {
-    RETURN_VAL_IF_FAIL(thiz, 0);
-    RETURN_VAL_IF_FAIL(eventSubURL, 0);
+    UpnpActionHandlerContext *context = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+    RETURN_VAL_IF_FAIL(action, NULL);
 
     do
     {
-        uint32_t i = 0;
-        uint32_t count = TinyMap_GetCount(&thiz->devices);
-
-        for (i = 0; i < count; i++)
+        *action = UpnpProvider_GetAction(thiz, uri, serviceType, actionName);
+        if (*action == NULL)
         {
-            UpnpDevice *device = NULL;
-            UpnpService *service = NULL;
-
-            device = (UpnpDevice *)TinyMap_GetValueAt(&thiz->devices, i);
+            break;
+        }
 
-            service = UpnpDevice_GetServiceByEventSubURL(device, eventSubURL);
-            if (service != NULL)
-            {
-                return service;
-            }
+        context = UpnpProvider_GetActionHandlerContext(thiz, *action);
+        if (context == NULL)
+        {
+            break;
         }
+
+        TinyMutex_Lock(&thiz->busyMutex);
+        context->busy++;
+        TinyMutex_Unlock(&thiz->busyMutex);
     } while (0);
 
-    return NULL;
-}
\ No newline at end of file
+    return context;
+}
+
+void UpnpProvider_ReleaseAction(UpnpProvider *thiz, UpnpActionHandlerContext *context)
+{
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(context);
+
+    TinyMutex_Lock(&thiz->busyMutex);
+
+    context->busy--;
+    if (context->busy == 0 && context->drained != NULL)
+    {
+        TinySemaphore_Post(context->drained);
+    }
+
+    TinyMutex_Unlock(&thiz->busyMutex);
+}
+
+void UpnpProvider_Drain(UpnpProvider *thiz, UpnpActionHandlerContext *context)
+{
+    TinySemaphore drained;
+    bool wait = false;
+
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(context);
+
+    if (RET_FAILED(TinySemaphore_Construct(&drained)))
+    {
+        LOG_E(TAG, "TinySemaphore_Construct failed");
+        return;
+    }
+
+    TinyMutex_Lock(&thiz->busyMutex);
+
+    if (context->busy > 0)
+    {
+        context->drained = &drained;
+        wait = true;
+    }
+
+    TinyMutex_Unlock(&thiz->busyMutex);
+
+    if (wait)
+    {
+        LOG_D(TAG, "waiting for actions in flight");
+        TinySemaphore_Wait(&drained);
+
+        /**
+         * the last ReleaseAction posts under busyMutex: let it leave
+         */
+        TinyMutex_Lock(&thiz->busyMutex);
+        TinyMutex_Unlock(&thiz->busyMutex);
+    }
+
+    TinySemaphore_Dispose(&drained);
+    tiny_free(context);
+}
+
+UpnpService * UpnpProvider_GetService(UpnpProvider *thiz, const char *eventSubURL)
+{
+    UpnpRoute *route = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, 0);
+    RETURN_VAL_IF_FAIL(eventSubURL, 0);
+
+    route = UpnpRouteTable_Get(&thiz->routes, ROUTE_EVENT_SUB, eventSubURL);
+
+    return (route != NULL) ? route->service : NULL;
+}
@@ -18,26 +18,41 @@
 #include "tiny_base.h"
 #include "upnp_define.h"
 #include "UpnpDevice.h"
+#include "TinyRwLock.h"
 #include "TinyMutex.h"
+#include "TinySemaphore.h"
 #include "TinyMap.h"
 #include "UpnpListener.h"
 #include "UpnpObserver.h"
+#include "UpnpRouteTable.h"
 
 TINY_BEGIN_DECLS
 
 
 typedef struct _UpnpProvider
 {
-    TinyMutex     mutex;
+    TinyRwLock    lock;
+    TinyMutex     busyMutex;
     TinyMap       devices;
     TinyMap       handlers;
     TinyMap       observers;
+    UpnpRouteTable routes;
 } UpnpProvider;
 
+/**
+ * exactly one of handler and asyncHandler is set.
+ * busy counts the actions in flight on the device; Drain waits on
+ * drained until it drops to zero, so the device outlives them.
+ * removed: taken out by Remove, freed by Drain rather than the map.
+ */
 typedef struct _UpnpActionHandlerContext
 {
     UpnpActionHandler handler;
+    UpnpAsyncActionHandler asyncHandler;
     void *ctx;
+    uint32_t busy;
+    TinySemaphore *drained;
+    bool removed;
 } UpnpActionHandlerContext;
 
 UpnpProvider * UpnpProvider_New(void);
@@ -45,8 +60,15 @@ TinyRet UpnpProvider_Construct(UpnpProvider *thiz);
 TinyRet UpnpProvider_Dispose(UpnpProvider *thiz);
 void UpnpProvider_Delete(UpnpProvider *thiz);
 
+/**
+ * Lock/Unlock: exclusive, for changes to the device table and observers.
+ * ReadLock/ReadUnlock: shared, for lookups and rendering. Requests that
+ * change a service's state also hold UpnpService_Lock on that service.
+ */
 void UpnpProvider_Lock(UpnpProvider *thiz);
 void UpnpProvider_Unlock(UpnpProvider *thiz);
+void UpnpProvider_ReadLock(UpnpProvider *thiz);
+void UpnpProvider_ReadUnlock(UpnpProvider *thiz);
 
 TinyRet UpnpProvider_AddObserver(UpnpProvider *thiz, 
     const char *name, 
@@ -62,11 +84,26 @@ void UpnpProvider_Foreach(UpnpProvider *thiz, const char *st, DeviceVisitor OnDe
 void UpnpProvider_Clear(UpnpProvider *thiz);
 UpnpDevice * UpnpProvider_GetDevice(UpnpProvider *thiz, const char *deviceId);
 TinyRet UpnpProvider_Add(UpnpProvider *thiz, UpnpDevice *device, UpnpActionHandler handler, void *ctx);
-TinyRet UpnpProvider_Remove(UpnpProvider *thiz, const char *deviceId);
+TinyRet UpnpProvider_AddAsync(UpnpProvider *thiz, UpnpDevice *device, UpnpAsyncActionHandler handler, void *ctx);
+
+/**
+ * Remove, under Lock, unroutes the device and hands back its context.
+ * Drain, called once the lock is dropped, waits for the actions still in
+ * flight on the device and frees the context; readers are not held up.
+ */
+TinyRet UpnpProvider_Remove(UpnpProvider *thiz, const char *deviceId, UpnpActionHandlerContext **context);
+void UpnpProvider_Drain(UpnpProvider *thiz, UpnpActionHandlerContext *context);
 
 uint32_t UpnpProvider_GetDocument(UpnpProvider *thiz, const char *uri, char *content, uint32_t len);
 UpnpAction * UpnpProvider_GetAction(UpnpProvider *thiz, const char *uri, const char *serviceType, const char *actionName);
 UpnpActionHandlerContext * UpnpProvider_GetActionHandlerContext(UpnpProvider *thiz, UpnpAction *action);
+
+/**
+ * Acquire: under ReadLock, looks the action up and pins its device, so the
+ * caller can drop the lock while the action runs. Release unpins it.
+ */
+UpnpActionHandlerContext * UpnpProvider_AcquireAction(UpnpProvider *thiz, const char *uri, const char *serviceType, const char *actionName, UpnpAction **action);
+void UpnpProvider_ReleaseAction(UpnpProvider *thiz, UpnpActionHandlerContext *context);
 UpnpService * UpnpProvider_GetService(UpnpProvider *thiz, const char *eventSubURL);
 
 
@@ -0,0 +1,216 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpRouteTable.c
+*
+* @remark
+*
+*/
+
+#include "UpnpRouteTable.h"
+#include "tiny_memory.h"
+#include "tiny_log.h"
+#include "tiny_str_hash.h"
+
+#define TAG                     "UpnpRouteTable"
+
+#define ROUTE_TABLE_INIT_SIZE   64
+
+static uint32_t route_hash(UpnpRouteType type, const char *url)
+{
+    return str_hash(url) ^ ((uint32_t)type * 0x9E3779B9U);
+}
+
+static TinyRet UpnpRouteTable_Resize(UpnpRouteTable *thiz, uint32_t size)
+{
+    UpnpRoute **buckets = NULL;
+    uint32_t i = 0;
+
+    buckets = (UpnpRoute **)tiny_malloc(sizeof(UpnpRoute *) * size);
+    if (buckets == NULL)
+    {
+        return TINY_RET_E_OUT_OF_MEMORY;
+    }
+
+    memset(buckets, 0, sizeof(UpnpRoute *) * size);
+
+    for (i = 0; i < thiz->size; i++)
+    {
+        UpnpRoute *route = thiz->buckets[i];
+        while (route != NULL)
+        {
+            UpnpRoute *next = route->next;
+            uint32_t index = route->hash & (size - 1);
+
+            route->next = buckets[index];
+            buckets[index] = route;
+            route = next;
+        }
+    }
+
+    if (thiz->buckets != NULL)
+    {
+        tiny_free(thiz->buckets);
+    }
+
+    thiz->buckets = buckets;
+    thiz->size = size;
+
+    return TINY_RET_OK;
+}
+
+TinyRet UpnpRouteTable_Construct(UpnpRouteTable *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    memset(thiz, 0, sizeof(UpnpRouteTable));
+
+    return UpnpRouteTable_Resize(thiz, ROUTE_TABLE_INIT_SIZE);
+}
+
+void UpnpRouteTable_Dispose(UpnpRouteTable *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    UpnpRouteTable_Clear(thiz);
+
+    if (thiz->buckets != NULL)
+    {
+        tiny_free(thiz->buckets);
+        thiz->buckets = NULL;
+    }
+
+    thiz->size = 0;
+}
+
+TinyRet UpnpRouteTable_Add(UpnpRouteTable *thiz, UpnpRouteType type, const char *url, UpnpDevice *device, UpnpService *service, void *data)
+{
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(url, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(device, TINY_RET_E_ARG_NULL);
+
+    do
+    {
+        UpnpRoute *route = NULL;
+        uint32_t index = 0;
+
+        if (UpnpRouteTable_Get(thiz, type, url) != NULL)
+        {
+            LOG_D(TAG, "route exist: %s", url);
+            ret = TINY_RET_E_ITEM_EXIST;
+            break;
+        }
+
+        if (thiz->count >= thiz->size)
+        {
+            ret = UpnpRouteTable_Resize(thiz, thiz->size * 2);
+            if (RET_FAILED(ret))
+            {
+                LOG_E(TAG, "UpnpRouteTable_Resize failed");
+                break;
+            }
+        }
+
+        route = (UpnpRoute *)tiny_malloc(sizeof(UpnpRoute));
+        if (route == NULL)
+        {
+            ret = TINY_RET_E_OUT_OF_MEMORY;
+            break;
+        }
+
+        route->hash = route_hash(type, url);
+        route->type = type;
+        route->url = url;
+        route->device = device;
+        route->service = service;
+        route->data = data;
+
+        index = route->hash & (thiz->size - 1);
+        route->next = thiz->buckets[index];
+        thiz->buckets[index] = route;
+        thiz->count++;
+    } while (0);
+
+    return ret;
+}
+
+void UpnpRouteTable_RemoveDevice(UpnpRouteTable *thiz, UpnpDevice *device)
+{
+    uint32_t i = 0;
+
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(device);
+
+    for (i = 0; i < thiz->size; i++)
+    {
+        UpnpRoute **link = &thiz->buckets[i];
+
+        while (*link != NULL)
+        {
+            UpnpRoute *route = *link;
+            if (route->device == device)
+            {
+                *link = route->next;
+                tiny_free(route);
+                thiz->count--;
+            }
+            else
+            {
+                link = &route->next;
+            }
+        }
+    }
+}
+
+void UpnpRouteTable_Clear(UpnpRouteTable *thiz)
+{
+    uint32_t i = 0;
+
+    RETURN_IF_FAIL(thiz);
+
+    for (i = 0; i < thiz->size; i++)
+    {
+        UpnpRoute *route = thiz->buckets[i];
+        while (route != NULL)
+        {
+            UpnpRoute *next = route->next;
+            tiny_free(route);
+            route = next;
+        }
+
+        thiz->buckets[i] = NULL;
+    }
+
+    thiz->count = 0;
+}
+
+UpnpRoute * UpnpRouteTable_Get(UpnpRouteTable *thiz, UpnpRouteType type, const char *url)
+{
+    UpnpRoute *route = NULL;
+    uint32_t hash = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+    RETURN_VAL_IF_FAIL(url, NULL);
+
+    if (thiz->buckets == NULL)
+    {
+        return NULL;
+    }
+
+    hash = route_hash(type, url);
+
+    for (route = thiz->buckets[hash & (thiz->size - 1)]; route != NULL; route = route->next)
+    {
+        if (route->hash == hash && route->type == type && STR_EQUAL(route->url, url))
+        {
+            break;
+        }
+    }
+
+    return route;
+}
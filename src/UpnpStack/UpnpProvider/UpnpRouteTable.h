@@ -0,0 +1,64 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpRouteTable.h
+*
+* @remark
+*
+*/
+
+#ifndef __UPNP_ROUTE_TABLE_H__
+#define __UPNP_ROUTE_TABLE_H__
+
+#include "tiny_base.h"
+#include "UpnpDevice.h"
+#include "UpnpService.h"
+
+TINY_BEGIN_DECLS
+
+
+typedef enum _UpnpRouteType
+{
+    ROUTE_DEVICE_DESCRIPTION = 0,
+    ROUTE_SCPD = 1,
+    ROUTE_CONTROL = 2,
+    ROUTE_EVENT_SUB = 3,
+} UpnpRouteType;
+
+/**
+ * url points into the device or service it routes to, so a route must be
+ * removed before its device is released.
+ */
+typedef struct _UpnpRoute
+{
+    struct _UpnpRoute         * next;
+    uint32_t                    hash;
+    UpnpRouteType               type;
+    const char                * url;
+    UpnpDevice                * device;
+    UpnpService               * service;
+    void                      * data;
+} UpnpRoute;
+
+typedef struct _UpnpRouteTable
+{
+    UpnpRoute                ** buckets;
+    uint32_t                    size;
+    uint32_t                    count;
+} UpnpRouteTable;
+
+TinyRet UpnpRouteTable_Construct(UpnpRouteTable *thiz);
+void UpnpRouteTable_Dispose(UpnpRouteTable *thiz);
+
+TinyRet UpnpRouteTable_Add(UpnpRouteTable *thiz, UpnpRouteType type, const char *url, UpnpDevice *device, UpnpService *service, void *data);
+void UpnpRouteTable_RemoveDevice(UpnpRouteTable *thiz, UpnpDevice *device);
+void UpnpRouteTable_Clear(UpnpRouteTable *thiz);
+UpnpRoute * UpnpRouteTable_Get(UpnpRouteTable *thiz, UpnpRouteType type, const char *url);
+
+
+TINY_END_DECLS
+
+#endif /* __UPNP_ROUTE_TABLE_H__ */
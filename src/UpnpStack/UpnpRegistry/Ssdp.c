@@ -25,7 +25,7 @@ static TinyRet Ssdp_CloseSockets(Ssdp *thiz);
 static void Ssdp_Loop(void *param);
 static TinyRet Ssdp_PreSelect(Ssdp *thiz, uint32_t *timeout);
 static bool Ssdp_SelectOnce(Ssdp *thiz, uint32_t timeout);
-static void Ssdp_ProcessMessage(Ssdp *thiz, const char *localIp, const char *buf, size_t len, const char *ip, uint16_t port);
+static void Ssdp_ProcessMessage(Ssdp *thiz, const char *localIp, char *buf, size_t len, const char *ip, uint16_t port);
 
 Ssdp * Ssdp_New(void)
 {
@@ -282,7 +282,18 @@ TinyRet Ssdp_SendMessage(Ssdp *thiz, SsdpMessage *message)
             len = SsdpMessage_ToString(message, string, SSDP_MSG_MAX_LEN);
             if (len > 0)
             {
-                ret = Ssdp_Send(thiz, string, len, thiz->search_fd, UPNP_GROUP, UPNP_PORT);
+                /**
+                 * one request per interface, falls back to the search socket
+                 */
+                for (i = 0; i < thiz->searchCount; ++i)
+                {
+                    ret = Ssdp_Send(thiz, string, len, thiz->search[i].fd, UPNP_GROUP, UPNP_PORT);
+                }
+
+                if (i == 0)
+                {
+                    ret = Ssdp_Send(thiz, string, len, thiz->search_fd, UPNP_GROUP, UPNP_PORT);
+                }
             }
             break;
 
@@ -314,6 +325,7 @@ TinyRet Ssdp_SendMessage(Ssdp *thiz, SsdpMessage *message)
 static TinyRet Ssdp_OpenSockets(Ssdp *thiz)
 {
     TinyRet ret = TINY_RET_OK;
+    uint32_t i = 0;
 
     do
     {
@@ -330,6 +342,22 @@ static TinyRet Ssdp_OpenSockets(Ssdp *thiz)
             LOG_D(TAG, "tiny_udp_unicast_open failed : %s", tiny_ret_to_str(ret));
             break;
         }
+
+        thiz->searchCount = 0;
+        for (i = 0; i < TinyMulticast_GetCount(&thiz->multicast) && thiz->searchCount < TINY_MULTICAST_MAX; ++i)
+        {
+            TinyMulticastSocket *m = (TinyMulticastSocket *)TinyMulticast_GetSocketAt(&thiz->multicast, i);
+            TinyMulticastSocket *s = &thiz->search[thiz->searchCount];
+
+            if (RET_FAILED(tiny_udp_unicast_open_on(&s->fd, m->ip, 0, false)))
+            {
+                LOG_D(TAG, "tiny_udp_unicast_open_on failed : %s", m->ip);
+                continue;
+            }
+
+            strncpy(s->ip, m->ip, TINY_IP_LEN);
+            thiz->searchCount++;
+        }
     } while (0);
 
     return ret;
@@ -339,6 +367,11 @@ static TinyRet Ssdp_CloseSockets(Ssdp *thiz)
 {
     TinyRet ret = TINY_RET_OK;
 
+    while (thiz->searchCount > 0)
+    {
+        tiny_udp_unicast_close(thiz->search[--thiz->searchCount].fd);
+    }
+
     do
     {
         ret = tiny_udp_unicast_close(thiz->search_fd);
@@ -394,6 +427,11 @@ static TinyRet Ssdp_PreSelect(Ssdp *thiz, uint32_t *timeout)
         TinySelector_Register(&thiz->selector, s->fd, SELECTOR_OP_READ);
     }
 
+    for (i = 0; i < thiz->searchCount; ++i)
+    {
+        TinySelector_Register(&thiz->selector, thiz->search[i].fd, SELECTOR_OP_READ);
+    }
+
     TinySelector_Register(&thiz->selector, thiz->search_fd, SELECTOR_OP_READ);
     TinySelector_Register(&thiz->selector, TinySocketIpc_GetFd(&thiz->ipc), SELECTOR_OP_READ);
 
@@ -455,6 +493,15 @@ static bool Ssdp_SelectOnce(Ssdp *thiz, uint32_t timeout)
             }
         }
 
+        for (i = 0; fd == 0 && i < thiz->searchCount; ++i)
+        {
+            if (TinySelector_IsReadable(&thiz->selector, thiz->search[i].fd))
+            {
+                fd = thiz->search[i].fd;
+                localIp = thiz->search[i].ip;
+            }
+        }
+
         if (fd == 0)
         {
             if (TinySelector_IsReadable(&thiz->selector, thiz->search_fd))
@@ -471,10 +518,10 @@ static bool Ssdp_SelectOnce(Ssdp *thiz, uint32_t timeout)
         {
             char ip[TINY_IP_LEN];
             uint16_t port;
-            char buf[2048];
+            char buf[SSDP_MSG_MAX_LEN + 1];
             int bytes_read = 0;
 
-            bytes_read = tiny_udp_read(fd, buf, 2048, ip, TINY_IP_LEN, &port);
+            bytes_read = tiny_udp_read(fd, buf, SSDP_MSG_MAX_LEN, ip, TINY_IP_LEN, &port);
             if (bytes_read <= 0)
             {
                 LOG_D(TAG, "tiny_udp_read failed");
@@ -492,16 +539,14 @@ static bool Ssdp_SelectOnce(Ssdp *thiz, uint32_t timeout)
     return select_result;
 }
 
-static void Ssdp_ProcessMessage(Ssdp *thiz, const char *localIp, const char *buf, size_t len, const char *ip, uint16_t port)
+static void Ssdp_ProcessMessage(Ssdp *thiz, const char *localIp, char *buf, size_t len, const char *ip, uint16_t port)
 {
-    SsdpMessage message;
+    SsdpPacket packet;
 
-    if (RET_FAILED(SsdpMessage_Construct(&message, localIp, ip, port, buf, len)))
+    if (RET_FAILED(SsdpPacket_Parse(&packet, localIp, ip, port, buf, len)))
     {
         return;
     }
 
-    thiz->handler(&message, thiz->ctx);
-
-    SsdpMessage_Dispose(&message);
+    thiz->handler(&packet, thiz->ctx);
 }
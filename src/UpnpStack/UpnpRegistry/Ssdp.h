@@ -19,11 +19,12 @@
 #include "TinySocketIpc.h"
 #include "TinyMulticast.h"
 #include "SsdpMessage.h"
+#include "SsdpPacket.h"
 
 TINY_BEGIN_DECLS
 
 
-typedef void(*SsdpMessageHandler)(SsdpMessage *message, void *ctx);
+typedef void(*SsdpMessageHandler)(SsdpPacket *packet, void *ctx);
 
 typedef struct _Ssdp
 {
@@ -32,7 +33,15 @@ typedef struct _Ssdp
     TinySocketIpc               ipc;
     bool                        running;
     TinyMulticast               multicast;
+
+    /**
+     * M-SEARCH leaves from an ephemeral port, never 1900, so unicast
+     * replies reach us alone: one socket bound to each interface, and
+     * search_fd when there is none.
+     */
     int                         search_fd;
+    TinyMulticastSocket         search[TINY_MULTICAST_MAX];
+    uint32_t                    searchCount;
     SsdpMessageHandler          handler;
     void                      * ctx;
 } Ssdp;
@@ -185,7 +185,6 @@ typedef struct _SsdpMessage
     } v;
 } SsdpMessage;
 
-TinyRet SsdpMessage_Construct(SsdpMessage *thiz, const char *localIp, const char *remoteIp, uint16_t remotePort, const char *buf, uint32_t len);
 TinyRet SsdpMessage_ConstructAlive_ROOTDEVICE(SsdpMessage *thiz, UpnpDevice *device, const char *uri, uint16_t port);
 TinyRet SsdpMessage_ConstructAlive_DEVICE_UUID(SsdpMessage *thiz, UpnpDevice *device, const char *uri, uint16_t port);
 TinyRet SsdpMessage_ConstructAlive_DEVICE(SsdpMessage *thiz, UpnpDevice *device, const char *uri, uint16_t port);
@@ -195,7 +194,7 @@ TinyRet SsdpMessage_ConstructByebye_DEVICE_UUID(SsdpMessage *thiz, UpnpDevice *d
 TinyRet SsdpMessage_ConstructByebye_DEVICE(SsdpMessage *thiz, UpnpDevice *device);
 TinyRet SsdpMessage_ConstructByebye_SERVICE(SsdpMessage *thiz, UpnpService *service);
 
-TinyRet SsdpMessage_ConstructRequest(SsdpMessage *thiz, const char *target);
+TinyRet SsdpMessage_ConstructRequest(SsdpMessage *thiz, const char *target, uint32_t mx);
 TinyRet SsdpMessage_ConstructResponse_ROOTDEVICE(SsdpMessage *thiz, UpnpDevice *device, const char *uri, uint16_t ex_port, const char *localIp, const char *ip, uint16_t port);
 TinyRet SsdpMessage_ConstructResponse_DEVICE_UUID(SsdpMessage *thiz, UpnpDevice *device, const char *uri, uint16_t ex_port, const char *localIp, const char *ip, uint16_t port);
 TinyRet SsdpMessage_ConstructResponse_DEVICE(SsdpMessage *thiz, UpnpDevice *device, const char *uri, uint16_t ex_port, const char *localIp, const char *ip, uint16_t port);
@@ -0,0 +1,346 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   SsdpPacket.c
+*
+* @remark
+*
+*/
+
+#include "SsdpPacket.h"
+#include "tiny_log.h"
+#include <ctype.h>
+
+#define TAG     "SsdpPacket"
+
+#define IS_BLANK(c)     ((c) == ' ' || (c) == '\t')
+
+typedef enum _SsdpStartLine
+{
+    START_LINE_INVALID = 0,
+    START_LINE_NOTIFY = 1,
+    START_LINE_MSEARCH = 2,
+    START_LINE_RESPONSE = 3,
+} SsdpStartLine;
+
+static char * ssdp_find_eol(char *p, char *end)
+{
+    while (p < end && *p != '\r' && *p != '\n')
+    {
+        p++;
+    }
+
+    return p;
+}
+
+static char * ssdp_skip_eol(char *p, char *end)
+{
+    if (p < end && *p == '\r')
+    {
+        p++;
+    }
+
+    if (p < end && *p == '\n')
+    {
+        p++;
+    }
+
+    return p;
+}
+
+static bool ssdp_starts_with(const char *p, uint32_t len, const char *prefix)
+{
+    uint32_t n = strlen(prefix);
+    return (len >= n && memcmp(p, prefix, n) == 0);
+}
+
+static bool ssdp_name_equal(const char *name, uint32_t len, const char *header)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < len; ++i)
+    {
+        if (header[i] == '\0' || tolower((unsigned char)name[i]) != tolower((unsigned char)header[i]))
+        {
+            return false;
+        }
+    }
+
+    return (header[len] == '\0');
+}
+
+static SsdpStartLine ssdp_parse_start_line(const char *line, uint32_t len)
+{
+    if (ssdp_starts_with(line, len, METHOD_NOTIFY " "))
+    {
+        return START_LINE_NOTIFY;
+    }
+
+    if (ssdp_starts_with(line, len, METHOD_MSEARCH " "))
+    {
+        return START_LINE_MSEARCH;
+    }
+
+    if (ssdp_starts_with(line, len, "HTTP/"))
+    {
+        const char *code = memchr(line, ' ', len);
+        if (code != NULL && (uint32_t)(line + len - code) > 3 && memcmp(code + 1, "200", 3) == 0)
+        {
+            return START_LINE_RESPONSE;
+        }
+    }
+
+    return START_LINE_INVALID;
+}
+
+static void ssdp_parse_header(SsdpPacket *thiz, char *line, char *eol)
+{
+    char *colon = memchr(line, ':', eol - line);
+    char *name_end = NULL;
+    char *value = NULL;
+    char *value_end = eol;
+    uint32_t name_len = 0;
+
+    if (colon == NULL)
+    {
+        return;
+    }
+
+    name_end = colon;
+    while (name_end > line && IS_BLANK(name_end[-1]))
+    {
+        name_end--;
+    }
+
+    value = colon + 1;
+    while (value < eol && IS_BLANK(*value))
+    {
+        value++;
+    }
+
+    while (value_end > value && IS_BLANK(value_end[-1]))
+    {
+        value_end--;
+    }
+
+    *value_end = '\0';
+    name_len = (uint32_t)(name_end - line);
+
+    switch (tolower((unsigned char)line[0]))
+    {
+    case 'c':
+        if (ssdp_name_equal(line, name_len, HEAD_CACHE_CONTROL))
+        {
+            thiz->cache_control = value;
+        }
+        break;
+
+    case 'h':
+        if (ssdp_name_equal(line, name_len, HEAD_HOST))
+        {
+            thiz->host = value;
+        }
+        break;
+
+    case 'l':
+        if (ssdp_name_equal(line, name_len, HEAD_LOCATION))
+        {
+            thiz->location = value;
+        }
+        break;
+
+    case 'm':
+        if (ssdp_name_equal(line, name_len, HEAD_MAN))
+        {
+            thiz->man = value;
+        }
+        else if (ssdp_name_equal(line, name_len, HEAD_MX))
+        {
+            thiz->mx = atoi(value);
+        }
+        break;
+
+    case 'n':
+        if (ssdp_name_equal(line, name_len, HEAD_NT))
+        {
+            thiz->nt = value;
+        }
+        else if (ssdp_name_equal(line, name_len, HEAD_NTS))
+        {
+            thiz->nts = value;
+        }
+        break;
+
+    case 's':
+        if (ssdp_name_equal(line, name_len, HEAD_ST))
+        {
+            thiz->st = value;
+        }
+        else if (ssdp_name_equal(line, name_len, HEAD_SERVER))
+        {
+            thiz->server = value;
+        }
+        break;
+
+    case 'u':
+        if (ssdp_name_equal(line, name_len, HEAD_USN))
+        {
+            thiz->usn = value;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+static bool ssdp_check(const char *name, const char *value, uint32_t max)
+{
+    if (value == NULL)
+    {
+        LOG_D(TAG, "NOT FOUND: %s", name);
+        return false;
+    }
+
+    if (max > 0 && strlen(value) > max)
+    {
+        LOG_D(TAG, "TOO LONG: %s", name);
+        return false;
+    }
+
+    return true;
+}
+
+TinyRet SsdpPacket_Parse(SsdpPacket *thiz, const char *localIp, const char *remoteIp, uint16_t remotePort, char *buf, uint32_t len)
+{
+    TinyRet ret = TINY_RET_E_HTTP_MSG_INVALID;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(buf, TINY_RET_E_ARG_NULL);
+
+    do
+    {
+        char *p = buf;
+        char *end = buf + len;
+        char *eol = NULL;
+        SsdpStartLine start = START_LINE_INVALID;
+
+        memset(thiz, 0, sizeof(SsdpPacket));
+        thiz->localIp = localIp;
+        thiz->remoteIp = remoteIp;
+        thiz->remotePort = remotePort;
+        thiz->mx = -1;
+        buf[len] = '\0';
+
+        /**
+         * start line
+         */
+        eol = ssdp_find_eol(p, end);
+        start = ssdp_parse_start_line(p, (uint32_t)(eol - p));
+        if (start == START_LINE_INVALID)
+        {
+            break;
+        }
+
+        p = ssdp_skip_eol(eol, end);
+
+        /**
+         * headers, until the empty line
+         */
+        while (p < end)
+        {
+            char *next = NULL;
+
+            eol = ssdp_find_eol(p, end);
+            if (eol == p)
+            {
+                break;
+            }
+
+            next = ssdp_skip_eol(eol, end);
+            ssdp_parse_header(thiz, p, eol);
+            p = next;
+        }
+
+        /**
+         * classify & check the headers this type requires
+         */
+        if (start == START_LINE_NOTIFY)
+        {
+            if (!ssdp_check(HEAD_NTS, thiz->nts, HEAD_NTS_LEN))
+            {
+                break;
+            }
+
+            if (STR_EQUAL(thiz->nts, NTS_ALIVE))
+            {
+                thiz->type = SSDP_ALIVE;
+
+                if (!ssdp_check(HEAD_HOST, thiz->host, HEAD_HOST_LEN)
+                    || !ssdp_check(HEAD_CACHE_CONTROL, thiz->cache_control, HEAD_CACHE_CONTROL_LEN)
+                    || !ssdp_check(HEAD_LOCATION, thiz->location, HEAD_LOCATION_LEN)
+                    || !ssdp_check(HEAD_NT, thiz->nt, HEAD_NT_LEN)
+                    || !ssdp_check(HEAD_USN, thiz->usn, HEAD_USN_LEN))
+                {
+                    break;
+                }
+            }
+            else if (STR_EQUAL(thiz->nts, NTS_BYEBYE))
+            {
+                thiz->type = SSDP_BYEBYE;
+
+                if (!ssdp_check(HEAD_HOST, thiz->host, HEAD_HOST_LEN)
+                    || !ssdp_check(HEAD_NT, thiz->nt, HEAD_NT_LEN)
+                    || !ssdp_check(HEAD_USN, thiz->usn, HEAD_USN_LEN))
+                {
+                    break;
+                }
+            }
+            else
+            {
+                break;
+            }
+        }
+        else if (start == START_LINE_MSEARCH)
+        {
+            thiz->type = SSDP_MSEARCH_REQUEST;
+
+            if (!ssdp_check(HEAD_HOST, thiz->host, HEAD_HOST_LEN)
+                || !ssdp_check(HEAD_ST, thiz->st, HEAD_ST_LEN)
+                || !ssdp_check(HEAD_MAN, thiz->man, HEAD_MAN_LEN))
+            {
+                break;
+            }
+
+            if (thiz->mx < 0)
+            {
+                LOG_D(TAG, "NOT FOUND: %s", HEAD_MX);
+                break;
+            }
+        }
+        else
+        {
+            thiz->type = SSDP_MSEARCH_RESPONSE;
+
+            if (!ssdp_check(HEAD_CACHE_CONTROL, thiz->cache_control, HEAD_CACHE_CONTROL_LEN)
+                || !ssdp_check(HEAD_LOCATION, thiz->location, HEAD_LOCATION_LEN)
+                || !ssdp_check(HEAD_ST, thiz->st, HEAD_ST_LEN)
+                || !ssdp_check(HEAD_USN, thiz->usn, HEAD_USN_LEN))
+            {
+                break;
+            }
+        }
+
+        ret = TINY_RET_OK;
+    } while (0);
+
+    if (RET_FAILED(ret))
+    {
+        thiz->type = SSDP_INVALID;
+    }
+
+    return ret;
+}
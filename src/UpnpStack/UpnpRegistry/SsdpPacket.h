@@ -0,0 +1,55 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   SsdpPacket.h
+*
+* @remark
+*
+*/
+
+#ifndef __SSDP_PACKET_H__
+#define __SSDP_PACKET_H__
+
+#include "tiny_base.h"
+#include "SsdpMessage.h"
+
+TINY_BEGIN_DECLS
+
+
+/**
+ * Received SSDP datagram.
+ * Header values point into the datagram buffer, which is NUL-patched in place
+ * while tokenizing, so nothing is copied. Absent headers are NULL.
+ * Values are only valid as long as the buffer is.
+ */
+typedef struct _SsdpPacket
+{
+    SsdpMessageType             type;
+    const char                * localIp;
+    const char                * remoteIp;
+    uint16_t                    remotePort;
+
+    const char                * host;
+    const char                * cache_control;
+    const char                * location;
+    const char                * st;
+    const char                * man;
+    const char                * nt;
+    const char                * nts;
+    const char                * server;
+    const char                * usn;
+    int                         mx;
+} SsdpPacket;
+
+/**
+ * buf must hold len + 1 bytes, it is modified in place.
+ */
+TinyRet SsdpPacket_Parse(SsdpPacket *thiz, const char *localIp, const char *remoteIp, uint16_t remotePort, char *buf, uint32_t len);
+
+
+TINY_END_DECLS
+
+#endif /* __SSDP_PACKET_H__ */
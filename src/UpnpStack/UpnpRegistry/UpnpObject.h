@@ -34,6 +34,7 @@ typedef struct _UpnpObject
     char usn[UPNP_USN_LEN];
     uint64_t max_age;
     uint64_t next_notify;
+    uint32_t heap_index;
 } UpnpObject;
 
 UPNP_API UpnpObject * UpnpObject_New(void);
@@ -15,7 +15,7 @@
 
 #define TAG         "UpnpObjectFactory"
 
-UpnpObject * UpnpObjectFactory_CreateByAlive(SsdpAlive *alive, const char *ip, UpnpValidator *validator)
+UpnpObject * UpnpObjectFactory_CreateByAlive(SsdpPacket *alive, UpnpValidator *validator)
 {
     UpnpObject *obj = NULL;
 
@@ -36,7 +36,7 @@ UpnpObject * UpnpObjectFactory_CreateByAlive(SsdpAlive *alive, const char *ip, U
         UpnpObject_SetNt(obj, alive->nt, validator->strictedUuid);
         UpnpObject_SetCacheControl(obj, alive->cache_control);
         UpnpObject_SetUsn(obj, alive->usn);
-        UpnpObject_SetIp(obj, ip);
+        UpnpObject_SetIp(obj, alive->remoteIp);
         UpnpObject_SetLocation(obj, alive->location);
         UpnpObject_SetStackInfo(obj, alive->server);
         UpnpObject_UpdateNextNotify(obj);
@@ -45,7 +45,7 @@ UpnpObject * UpnpObjectFactory_CreateByAlive(SsdpAlive *alive, const char *ip, U
     return obj;
 }
 
-UpnpObject * UpnpObjectFactory_CreateByResponse(SsdpResponse *response, const char *ip, UpnpValidator *validator)
+UpnpObject * UpnpObjectFactory_CreateByResponse(SsdpPacket *response, UpnpValidator *validator)
 {
     UpnpObject *obj = NULL;
 
@@ -66,7 +66,7 @@ UpnpObject * UpnpObjectFactory_CreateByResponse(SsdpResponse *response, const ch
         UpnpObject_SetNt(obj, response->st, validator->strictedUuid);
         UpnpObject_SetCacheControl(obj, response->cache_control);
         UpnpObject_SetUsn(obj, response->usn);
-        UpnpObject_SetIp(obj, ip);
+        UpnpObject_SetIp(obj, response->remoteIp);
         UpnpObject_SetLocation(obj, response->location);
         UpnpObject_SetStackInfo(obj, response->server);
         UpnpObject_UpdateNextNotify(obj);
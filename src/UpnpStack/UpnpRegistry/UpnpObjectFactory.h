@@ -15,14 +15,14 @@
 
 #include "tiny_base.h"
 #include "UpnpObject.h"
-#include "SsdpMessage.h"
+#include "SsdpPacket.h"
 #include "UpnpValidator.h"
 
 TINY_BEGIN_DECLS
 
 
-UpnpObject * UpnpObjectFactory_CreateByAlive(SsdpAlive *alive, const char *ip, UpnpValidator *validator);
-UpnpObject * UpnpObjectFactory_CreateByResponse(SsdpResponse *response, const char *ip, UpnpValidator *validator);
+UpnpObject * UpnpObjectFactory_CreateByAlive(SsdpPacket *alive, UpnpValidator *validator);
+UpnpObject * UpnpObjectFactory_CreateByResponse(SsdpPacket *response, UpnpValidator *validator);
 
 
 TINY_END_DECLS
@@ -14,6 +14,9 @@
 
 #include "UpnpObjectList.h"
 #include "tiny_memory.h"
+#include "tiny_str_hash.h"
+
+#define HEAP_INIT_CAPACITY      32
 
 static void object_delete_listener(void * data, void *ctx)
 {
@@ -21,6 +24,108 @@ static void object_delete_listener(void * data, void *ctx)
     UpnpObject_Delete(object);
 }
 
+/**
+ * per shard min-heap of found objects, ordered by next_notify
+ */
+static void heap_swap(UpnpObjectShard *thiz, uint32_t a, uint32_t b)
+{
+    UpnpObject *tmp = thiz->heap[a];
+    thiz->heap[a] = thiz->heap[b];
+    thiz->heap[b] = tmp;
+    thiz->heap[a]->heap_index = a;
+    thiz->heap[b]->heap_index = b;
+}
+
+static void heap_sift_up(UpnpObjectShard *thiz, uint32_t i)
+{
+    while (i > 0)
+    {
+        uint32_t parent = (i - 1) / 2;
+        if (thiz->heap[parent]->next_notify <= thiz->heap[i]->next_notify)
+        {
+            break;
+        }
+
+        heap_swap(thiz, i, parent);
+        i = parent;
+    }
+}
+
+static void heap_sift_down(UpnpObjectShard *thiz, uint32_t i)
+{
+    while (true)
+    {
+        uint32_t left = 2 * i + 1;
+        uint32_t right = left + 1;
+        uint32_t min = i;
+
+        if (left < thiz->heap_size && thiz->heap[left]->next_notify < thiz->heap[min]->next_notify)
+        {
+            min = left;
+        }
+
+        if (right < thiz->heap_size && thiz->heap[right]->next_notify < thiz->heap[min]->next_notify)
+        {
+            min = right;
+        }
+
+        if (min == i)
+        {
+            break;
+        }
+
+        heap_swap(thiz, i, min);
+        i = min;
+    }
+}
+
+static TinyRet heap_push(UpnpObjectShard *thiz, UpnpObject *object)
+{
+    if (thiz->heap_size == thiz->heap_capacity)
+    {
+        uint32_t capacity = (thiz->heap_capacity == 0) ? HEAP_INIT_CAPACITY : thiz->heap_capacity * 2;
+        UpnpObject **heap = (UpnpObject **)tiny_realloc(thiz->heap, capacity * sizeof(UpnpObject *));
+        if (heap == NULL)
+        {
+            return TINY_RET_E_OUT_OF_MEMORY;
+        }
+
+        thiz->heap = heap;
+        thiz->heap_capacity = capacity;
+    }
+
+    object->heap_index = thiz->heap_size;
+    thiz->heap[thiz->heap_size++] = object;
+    heap_sift_up(thiz, object->heap_index);
+
+    return TINY_RET_OK;
+}
+
+static void heap_remove(UpnpObjectShard *thiz, UpnpObject *object)
+{
+    uint32_t i = object->heap_index;
+    uint32_t last = 0;
+
+    if (i >= thiz->heap_size || thiz->heap[i] != object)
+    {
+        return;
+    }
+
+    last = thiz->heap_size - 1;
+    if (i != last)
+    {
+        heap_swap(thiz, i, last);
+    }
+
+    thiz->heap_size--;
+
+    if (i < thiz->heap_size)
+    {
+        heap_sift_up(thiz, i);
+        heap_sift_down(thiz, i);
+    }
+}
+
 UpnpObjectList * UpnpObjectList_New(void)
 {
     UpnpObjectList *thiz = NULL;
@@ -50,22 +155,30 @@ UpnpObjectList * UpnpObjectList_New(void)
 TinyRet UpnpObjectList_Construct(UpnpObjectList *thiz)
 {
     TinyRet ret = TINY_RET_OK;
+    uint32_t i = 0;
 
     do
     {
-        ret = TinyMutex_Construct(&thiz->mutex);
-        if (RET_FAILED(ret))
-        {
-            break;
-        }
+        memset(thiz, 0, sizeof(UpnpObjectList));
 
-        ret = TinyMap_Construct(&thiz->objects);
-        if (RET_FAILED(ret))
+        for (i = 0; i < UPNP_OBJECT_LIST_SHARDS; ++i)
         {
-            break;
-        }
+            UpnpObjectShard *shard = &thiz->shards[i];
+
+            ret = TinyMutex_Construct(&shard->mutex);
+            if (RET_FAILED(ret))
+            {
+                break;
+            }
 
-        TinyMap_SetDeleteListener(&thiz->objects, object_delete_listener, NULL);
+            ret = TinyMap_Construct(&shard->objects);
+            if (RET_FAILED(ret))
+            {
+                break;
+            }
+
+            TinyMap_SetDeleteListener(&shard->objects, object_delete_listener, NULL);
+        }
     } while (0);
 
     return ret;
@@ -73,10 +186,23 @@ TinyRet UpnpObjectList_Construct(UpnpObjectList *thiz)
 
 TinyRet UpnpObjectList_Dispose(UpnpObjectList *thiz)
 {
+    uint32_t i = 0;
+
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
 
-    TinyMutex_Dispose(&thiz->mutex);
-    TinyMap_Dispose(&thiz->objects);
+    for (i = 0; i < UPNP_OBJECT_LIST_SHARDS; ++i)
+    {
+        UpnpObjectShard *shard = &thiz->shards[i];
+
+        TinyMutex_Dispose(&shard->mutex);
+        TinyMap_Dispose(&shard->objects);
+
+        if (shard->heap != NULL)
+        {
+            tiny_free(shard->heap);
+            shard->heap = NULL;
+        }
+    }
 
     return TINY_RET_OK;
 }
@@ -89,41 +215,227 @@ void UpnpObjectList_Delete(UpnpObjectList *thiz)
     tiny_free(thiz);
 }
 
-void UpnpObjectList_Lock(UpnpObjectList *thiz)
+static UpnpObjectShard * UpnpObjectList_GetShard(UpnpObjectList *thiz, const char *usn)
 {
-    TinyMutex_Lock(&thiz->mutex);
+    return &thiz->shards[str_hash(usn) % UPNP_OBJECT_LIST_SHARDS];
 }
 
-void UpnpObjectList_Unlock(UpnpObjectList *thiz)
+void UpnpObjectList_Clear(UpnpObjectList *thiz)
 {
-    TinyMutex_Unlock(&thiz->mutex);
+    uint32_t i = 0;
+
+    RETURN_IF_FAIL(thiz);
+
+    for (i = 0; i < UPNP_OBJECT_LIST_SHARDS; ++i)
+    {
+        UpnpObjectShard *shard = &thiz->shards[i];
+
+        TinyMutex_Lock(&shard->mutex);
+        shard->heap_size = 0;
+        TinyMap_Clear(&shard->objects);
+        TinyMutex_Unlock(&shard->mutex);
+    }
 }
 
-void UpnpObjectList_Clear(UpnpObjectList *thiz)
+uint32_t UpnpObjectList_GetCount(UpnpObjectList *thiz)
 {
-    TinyMap_Clear(&thiz->objects);
+    uint32_t count = 0;
+    uint32_t i = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, 0);
+
+    for (i = 0; i < UPNP_OBJECT_LIST_SHARDS; ++i)
+    {
+        UpnpObjectShard *shard = &thiz->shards[i];
+
+        TinyMutex_Lock(&shard->mutex);
+        count += TinyMap_GetCount(&shard->objects);
+        TinyMutex_Unlock(&shard->mutex);
+    }
+
+    return count;
 }
 
-UpnpObject * UpnpObjectList_GetObject(UpnpObjectList *thiz, const char *usn)
+TinyRet UpnpObjectList_GetObject(UpnpObjectList *thiz, const char *usn, UpnpObject *copy)
 {
-    RETURN_VAL_IF_FAIL(thiz, NULL);
-    RETURN_VAL_IF_FAIL(usn, NULL);
+    TinyRet ret = TINY_RET_OK;
+    UpnpObjectShard *shard = NULL;
+    UpnpObject *object = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(usn, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(copy, TINY_RET_E_ARG_NULL);
+
+    shard = UpnpObjectList_GetShard(thiz, usn);
+
+    TinyMutex_Lock(&shard->mutex);
 
-    return (UpnpObject *)TinyMap_GetValue(&thiz->objects, usn);
+    object = (UpnpObject *)TinyMap_GetValue(&shard->objects, usn);
+    if (object == NULL)
+    {
+        ret = TINY_RET_E_NOT_FOUND;
+    }
+    else
+    {
+        UpnpObject_Copy(copy, object);
+    }
+
+    TinyMutex_Unlock(&shard->mutex);
+
+    return ret;
 }
 
-void UpnpObjectList_AddObject(UpnpObjectList *thiz, UpnpObject *object)
+void UpnpObjectList_Foreach(UpnpObjectList *thiz, UpnpObjectVisitor visitor, void *ctx)
 {
+    uint32_t i = 0;
+
     RETURN_IF_FAIL(thiz);
-    RETURN_IF_FAIL(object);
+    RETURN_IF_FAIL(visitor);
+
+    /**
+     * only one shard is locked at a time
+     */
+    for (i = 0; i < UPNP_OBJECT_LIST_SHARDS; ++i)
+    {
+        UpnpObjectShard *shard = &thiz->shards[i];
+        uint32_t count = 0;
+        uint32_t j = 0;
+
+        TinyMutex_Lock(&shard->mutex);
+
+        count = TinyMap_GetCount(&shard->objects);
+        for (j = 0; j < count; ++j)
+        {
+            visitor((UpnpObject *)TinyMap_GetValueAt(&shard->objects, j), ctx);
+        }
 
-    TinyMap_Insert(&thiz->objects, UpnpObject_GetUsn(object), object);
+        TinyMutex_Unlock(&shard->mutex);
+    }
 }
 
-void UpnpObjectList_RemoveObject(UpnpObjectList *thiz, const char *usn)
+TinyRet UpnpObjectList_AddObject(UpnpObjectList *thiz, UpnpObject *object)
 {
-    RETURN_IF_FAIL(thiz);
-    RETURN_IF_FAIL(usn);
+    TinyRet ret = TINY_RET_OK;
+    UpnpObjectShard *shard = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(object, TINY_RET_E_ARG_NULL);
+
+    shard = UpnpObjectList_GetShard(thiz, UpnpObject_GetUsn(object));
+
+    TinyMutex_Lock(&shard->mutex);
+
+    do
+    {
+        ret = TinyMap_Insert(&shard->objects, UpnpObject_GetUsn(object), object);
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+
+        if (RET_FAILED(heap_push(shard, object)))
+        {
+            /* not expirable, but still reachable by byebye */
+            object->heap_index = shard->heap_capacity;
+        }
+    } while (0);
+
+    TinyMutex_Unlock(&shard->mutex);
+
+    return ret;
+}
+
+TinyRet UpnpObjectList_RemoveObject(UpnpObjectList *thiz, const char *usn, UpnpObject *copy)
+{
+    TinyRet ret = TINY_RET_OK;
+    UpnpObjectShard *shard = NULL;
+    UpnpObject *object = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(usn, TINY_RET_E_ARG_NULL);
+
+    shard = UpnpObjectList_GetShard(thiz, usn);
+
+    TinyMutex_Lock(&shard->mutex);
+
+    do
+    {
+        object = (UpnpObject *)TinyMap_GetValue(&shard->objects, usn);
+        if (object == NULL)
+        {
+            ret = TINY_RET_E_NOT_FOUND;
+            break;
+        }
+
+        if (copy != NULL)
+        {
+            UpnpObject_Copy(copy, object);
+        }
+
+        heap_remove(shard, object);
+        TinyMap_Erase(&shard->objects, usn);
+    } while (0);
+
+    TinyMutex_Unlock(&shard->mutex);
+
+    return ret;
+}
+
+bool UpnpObjectList_RefreshObject(UpnpObjectList *thiz, const char *usn)
+{
+    UpnpObjectShard *shard = NULL;
+    UpnpObject *object = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, false);
+    RETURN_VAL_IF_FAIL(usn, false);
+
+    shard = UpnpObjectList_GetShard(thiz, usn);
+
+    TinyMutex_Lock(&shard->mutex);
+
+    object = (UpnpObject *)TinyMap_GetValue(&shard->objects, usn);
+    if (object != NULL)
+    {
+        UpnpObject_UpdateNextNotify(object);
+
+        if (object->heap_index < shard->heap_size && shard->heap[object->heap_index] == object)
+        {
+            heap_sift_up(shard, object->heap_index);
+            heap_sift_down(shard, object->heap_index);
+        }
+    }
+
+    TinyMutex_Unlock(&shard->mutex);
+
+    return (object != NULL);
+}
+
+bool UpnpObjectList_RemoveExpiredObject(UpnpObjectList *thiz, uint64_t now, UpnpObject *copy)
+{
+    bool found = false;
+    uint32_t i = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, false);
+    RETURN_VAL_IF_FAIL(copy, false);
+
+    for (i = 0; i < UPNP_OBJECT_LIST_SHARDS && !found; ++i)
+    {
+        UpnpObjectShard *shard = &thiz->shards[i];
+
+        TinyMutex_Lock(&shard->mutex);
+
+        if (shard->heap_size > 0 && shard->heap[0]->next_notify <= now)
+        {
+            UpnpObject *object = shard->heap[0];
+
+            UpnpObject_Copy(copy, object);
+            heap_remove(shard, object);
+            TinyMap_Erase(&shard->objects, UpnpObject_GetUsn(copy));
+            found = true;
+        }
+
+        TinyMutex_Unlock(&shard->mutex);
+    }
 
-    TinyMap_Erase(&thiz->objects, usn);
+    return found;
 }
\ No newline at end of file
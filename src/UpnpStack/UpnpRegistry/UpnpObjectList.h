@@ -24,26 +24,43 @@
 TINY_BEGIN_DECLS
 
 
-typedef struct _UpnpObjectList
+#define UPNP_OBJECT_LIST_SHARDS     16
+
+typedef struct _UpnpObjectShard
 {
     TinyMutex     mutex;
     TinyMap       objects;
+    UpnpObject ** heap;
+    uint32_t      heap_size;
+    uint32_t      heap_capacity;
+} UpnpObjectShard;
+
+/**
+ * Objects are spread over shards by USN hash, each shard has its own lock.
+ * Objects never leave the list by pointer: readers get a copy.
+ */
+typedef struct _UpnpObjectList
+{
+    UpnpObjectShard shards[UPNP_OBJECT_LIST_SHARDS];
 } UpnpObjectList;
 
+typedef void(*UpnpObjectVisitor)(UpnpObject *object, void *ctx);
+
 UpnpObjectList * UpnpObjectList_New(void);
 TinyRet UpnpObjectList_Construct(UpnpObjectList *thiz);
 TinyRet UpnpObjectList_Dispose(UpnpObjectList *thiz);
 void UpnpObjectList_Delete(UpnpObjectList *thiz);
 
-void UpnpObjectList_Lock(UpnpObjectList *thiz);
-void UpnpObjectList_Unlock(UpnpObjectList *thiz);
-
 void UpnpObjectList_Clear(UpnpObjectList *thiz);
-UpnpObject * UpnpObjectList_GetObject(UpnpObjectList *thiz, const char *usn);
-void UpnpObjectList_AddObject(UpnpObjectList *thiz, UpnpObject *object);
-void UpnpObjectList_RemoveObject(UpnpObjectList *thiz, const char *usn);
+uint32_t UpnpObjectList_GetCount(UpnpObjectList *thiz);
+TinyRet UpnpObjectList_GetObject(UpnpObjectList *thiz, const char *usn, UpnpObject *copy);
+void UpnpObjectList_Foreach(UpnpObjectList *thiz, UpnpObjectVisitor visitor, void *ctx);
+TinyRet UpnpObjectList_AddObject(UpnpObjectList *thiz, UpnpObject *object);
+TinyRet UpnpObjectList_RemoveObject(UpnpObjectList *thiz, const char *usn, UpnpObject *copy);
+bool UpnpObjectList_RefreshObject(UpnpObjectList *thiz, const char *usn);
+bool UpnpObjectList_RemoveExpiredObject(UpnpObjectList *thiz, uint64_t now, UpnpObject *copy);
 
 
 TINY_END_DECLS
 
-#endif /* __UPNP_OBJECT_LIST_H__ */
\ No newline at end of file
+#endif /* __UPNP_OBJECT_LIST_H__ */
@@ -18,14 +18,23 @@
 
 #define TAG                 "UpnpRegistry"
 
+#define TIMER_INTERVAL      (1000 * 1000)
+
 /**
  * for Ssdp
  */
-static void UpnpRegistry_MessageHandler(SsdpMessage *message, void *ctx);
-static void UpnpRegistry_OnAlive(UpnpRegistry *thiz, SsdpAlive *alive, const char *ip);
-static void UpnpRegistry_OnByebye(UpnpRegistry *thiz, SsdpByebye *byebye, const char *ip);
-static void UpnpRegistry_OnRequest(UpnpRegistry *thiz, SsdpRequest *request, const char *localIp, const char *ip, uint16_t port);
-static void UpnpRegistry_OnResponse(UpnpRegistry *thiz, SsdpResponse *response, const char *ip);
+static void UpnpRegistry_MessageHandler(SsdpPacket *packet, void *ctx);
+static void UpnpRegistry_OnAlive(UpnpRegistry *thiz, SsdpPacket *alive);
+static void UpnpRegistry_OnByebye(UpnpRegistry *thiz, SsdpPacket *byebye);
+static void UpnpRegistry_OnRequest(UpnpRegistry *thiz, SsdpPacket *request);
+static void UpnpRegistry_OnResponse(UpnpRegistry *thiz, SsdpPacket *response);
+
+/**
+ * for max-age & M-SEARCH retries
+ */
+static bool UpnpRegistry_OnTimer(TinyTimer *timer, void *ctx);
+static void UpnpRegistry_RemoveExpired(UpnpRegistry *thiz);
+static TinyRet UpnpRegistry_SendSearch(UpnpRegistry *thiz);
 
 /**
  * for UpnpProvider
@@ -106,6 +115,37 @@ TinyRet UpnpRegistry_Construct(UpnpRegistry *thiz, UpnpProvider *provider)
             ret = TINY_RET_E_NEW;
             break;
         }
+
+        ret = UpnpSeenCache_Construct(&thiz->seen);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "UpnpSeenCache_Construct failed");
+            ret = TINY_RET_E_NEW;
+            break;
+        }
+
+        ret = UpnpSearch_Construct(&thiz->search);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "UpnpSearch_Construct failed");
+            ret = TINY_RET_E_NEW;
+            break;
+        }
+
+        ret = TinyTimer_Construct(&thiz->timer);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyTimer_Construct failed");
+            ret = TINY_RET_E_NEW;
+            break;
+        }
+
+        ret = TinyTimer_Initialize(&thiz->timer, TIMER_INTERVAL, 0);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyTimer_Initialize failed");
+            break;
+        }
     } while (0);
 
     return ret;
@@ -115,9 +155,12 @@ void UpnpRegistry_Dispose(UpnpRegistry *thiz)
 {
     RETURN_IF_FAIL(thiz);
 
+    TinyTimer_Dispose(&thiz->timer);
     Ssdp_Dispose(&thiz->ssdp);
     UpnpObjectList_Dispose(&thiz->foundObjects);
     UpnpValidator_Dispose(&thiz->validator);
+    UpnpSeenCache_Dispose(&thiz->seen);
+    UpnpSearch_Dispose(&thiz->search);
 }
 
 void UpnpRegistry_Delete(UpnpRegistry *thiz)
@@ -151,6 +194,13 @@ TinyRet UpnpRegistry_Start(UpnpRegistry *thiz)
             LOG_E(TAG, "UpnpProvider_AddObserver failed");
             break;
         }
+
+        ret = TinyTimer_Start(&thiz->timer, UpnpRegistry_OnTimer, thiz);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyTimer_Start failed");
+            break;
+        }
     } while (0);
 
     UpnpProvider_Unlock(thiz->provider);
@@ -168,6 +218,8 @@ TinyRet UpnpRegistry_Stop(UpnpRegistry *thiz)
 
     do
     {
+        TinyTimer_Stop(&thiz->timer);
+
         ret = UpnpProvider_RemoveObserver(thiz->provider, "Registry");
         if (RET_FAILED(ret))
         {
@@ -188,10 +240,9 @@ TinyRet UpnpRegistry_Stop(UpnpRegistry *thiz)
     return ret;
 }
 
-TinyRet UpnpRegistry_Discover(UpnpRegistry *thiz, bool strictedUuid, UpnpObjectListener listener, UpnpObjectFilter filter, void *ctx)
+TinyRet UpnpRegistry_Discover(UpnpRegistry *thiz, bool strictedUuid, const char *targets[], uint32_t count, uint32_t mx, UpnpObjectListener listener, UpnpObjectFilter filter, void *ctx)
 {
     TinyRet ret = TINY_RET_OK;
-    SsdpMessage message;
 
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(listener, TINY_RET_E_ARG_NULL);
@@ -204,15 +255,22 @@ TinyRet UpnpRegistry_Discover(UpnpRegistry *thiz, bool strictedUuid, UpnpObjectL
         thiz->listener = listener;
         thiz->ctx = ctx;
 
-        ret = SsdpMessage_ConstructRequest(&message, DEFAULT_ST);
+        UpnpSeenCache_Clear(&thiz->seen);
+
+        ret = UpnpSearch_Start(&thiz->search, targets, count, mx);
         if (RET_FAILED(ret))
         {
+            LOG_E(TAG, "UpnpSearch_Start failed");
             break;
         }
 
-        ret = Ssdp_SendMessage(&thiz->ssdp, &message);
-
-        SsdpMessage_Dispose(&message);
+        /**
+         * first round now, retries are driven by the timer
+         */
+        if (UpnpSearch_IsRoundDue(&thiz->search, tiny_getusec()))
+        {
+            ret = UpnpRegistry_SendSearch(thiz);
+        }
     } while (0);
 
     return ret;
@@ -223,30 +281,31 @@ TinyRet UpnpRegistry_StopDiscovery(UpnpRegistry *thiz)
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
 
     thiz->listener = NULL;
+    UpnpSearch_Stop(&thiz->search);
 
     return TINY_RET_OK;
 }
 
-static void UpnpRegistry_MessageHandler(SsdpMessage *message, void *ctx)
+static void UpnpRegistry_MessageHandler(SsdpPacket *packet, void *ctx)
 {
     UpnpRegistry *thiz = (UpnpRegistry *)ctx;
 
-    switch (message->type)
+    switch (packet->type)
     {
     case SSDP_ALIVE:
-        UpnpRegistry_OnAlive(thiz, &message->v.alive, message->remote.ip);
+        UpnpRegistry_OnAlive(thiz, packet);
         break;
 
     case SSDP_BYEBYE:
-        UpnpRegistry_OnByebye(thiz, &message->v.byebye, message->remote.ip);
+        UpnpRegistry_OnByebye(thiz, packet);
         break;
 
     case SSDP_MSEARCH_REQUEST:
-        UpnpRegistry_OnRequest(thiz, &message->v.request, message->local.ip, message->remote.ip, message->remote.port);
+        UpnpRegistry_OnRequest(thiz, packet);
         break;
 
     case SSDP_MSEARCH_RESPONSE:
-        UpnpRegistry_OnResponse(thiz, &message->v.response, message->remote.ip);
+        UpnpRegistry_OnResponse(thiz, packet);
         break;
 
     default:
@@ -254,57 +313,87 @@ static void UpnpRegistry_MessageHandler(SsdpMessage *message, void *ctx)
     }
 }
 
-static void UpnpRegistry_OnAlive(UpnpRegistry *thiz, SsdpAlive *alive, const char *ip)
+static void UpnpRegistry_OnAlive(UpnpRegistry *thiz, SsdpPacket *alive)
 {
     LOG_D(TAG, "OnAlive");
 
-    UpnpObjectList_Lock(&thiz->foundObjects);
-
     do
     {
+        UpnpObjectListener listener = thiz->listener;
         UpnpObject *obj = NULL;
+        UpnpObject found;
 
-        if (thiz->listener == NULL)
+        if (listener == NULL)
         {
             break;
         }
 
+        /**
+         * fast path: refresh of a known object, no parsing
+         */
+        if (UpnpSeenCache_Contains(&thiz->seen, alive->usn, alive->location))
+        {
+            if (UpnpObjectList_RefreshObject(&thiz->foundObjects, alive->usn))
+            {
+                break;
+            }
+
+            UpnpSeenCache_Remove(&thiz->seen, alive->usn);
+        }
+
         if (!UpnpValidator_ValidateUSN(&thiz->validator, alive->usn))
         {
             break;
         }
 
-        obj = UpnpObjectList_GetObject(&thiz->foundObjects, alive->usn);
-        if (obj != NULL)
+        if (UpnpObjectList_RefreshObject(&thiz->foundObjects, alive->usn))
         {
-            UpnpObject_UpdateNextNotify(obj);
+            UpnpSeenCache_Put(&thiz->seen, alive->usn, alive->location);
             break;
         }
 
-        obj = UpnpObjectFactory_CreateByAlive(alive, ip, &thiz->validator);
+        obj = UpnpObjectFactory_CreateByAlive(alive, &thiz->validator);
         if (obj == NULL)
         {
             break;
         }
 
-        UpnpObjectList_AddObject(&thiz->foundObjects, obj);
-        thiz->listener(obj, true, thiz->ctx);
-    } while (0);
+        if (RET_FAILED(UpnpObject_Construct(&found)))
+        {
+            UpnpObject_Delete(obj);
+            break;
+        }
+
+        /**
+         * the list owns obj once added, listener gets a copy outside the lock
+         */
+        UpnpObject_Copy(&found, obj);
 
-    UpnpObjectList_Unlock(&thiz->foundObjects);
+        if (RET_SUCCEEDED(UpnpObjectList_AddObject(&thiz->foundObjects, obj)))
+        {
+            UpnpSearch_OnFound(&thiz->search);
+            UpnpSeenCache_Put(&thiz->seen, alive->usn, alive->location);
+            listener(&found, true, thiz->ctx);
+        }
+        else
+        {
+            UpnpObject_Delete(obj);
+        }
+
+        UpnpObject_Dispose(&found);
+    } while (0);
 }
 
-static void UpnpRegistry_OnByebye(UpnpRegistry *thiz, SsdpByebye *byebye, const char *ip)
+static void UpnpRegistry_OnByebye(UpnpRegistry *thiz, SsdpPacket *byebye)
 {
     LOG_D(TAG, "OnByebye");
 
-    UpnpObjectList_Lock(&thiz->foundObjects);
-
     do
     {
-        UpnpObject *obj = NULL;
+        UpnpObjectListener listener = thiz->listener;
+        UpnpObject found;
 
-        if (thiz->listener == NULL)
+        if (listener == NULL)
         {
             break;
         }
@@ -314,23 +403,26 @@ static void UpnpRegistry_OnByebye(UpnpRegistry *thiz, SsdpByebye *byebye, const
             break;
         }
 
-        obj = UpnpObjectList_GetObject(&thiz->foundObjects, byebye->usn);
-        if (obj == NULL)
+        if (RET_FAILED(UpnpObject_Construct(&found)))
         {
             break;
         }
 
-        thiz->listener(obj, false, thiz->ctx);
-        UpnpObjectList_RemoveObject(&thiz->foundObjects, byebye->usn);
-    } while (0);
+        UpnpSeenCache_Remove(&thiz->seen, byebye->usn);
+
+        if (RET_SUCCEEDED(UpnpObjectList_RemoveObject(&thiz->foundObjects, byebye->usn, &found)))
+        {
+            listener(&found, false, thiz->ctx);
+        }
 
-    UpnpObjectList_Unlock(&thiz->foundObjects);
+        UpnpObject_Dispose(&found);
+    } while (0);
 }
 
 typedef struct _OnRequestContext
 {
     UpnpRegistry *registry;
-    SsdpRequest *request;
+    const char *st;
     const char *localIp;
     const char *remoteIp;
     uint16_t remotePort;
@@ -342,7 +434,7 @@ static void OnRequestDeviceVisit(UpnpDevice *device, void *ctx)
 
     LOG_D(TAG, "OnRequestDeviceVisit");
 
-    if (deviceIsMatched(device, c->request->st))
+    if (deviceIsMatched(device, c->st))
     {
 
         do
@@ -419,62 +511,161 @@ static bool deviceIsMatched(UpnpDevice *device, const char *st)
     return false;
 }
 
-static void UpnpRegistry_OnRequest(UpnpRegistry *thiz, SsdpRequest *request, const char *localIp, const char *remoteIp, uint16_t remotePort)
+static void UpnpRegistry_OnRequest(UpnpRegistry *thiz, SsdpPacket *request)
 {
     LOG_D(TAG, "OnRequest");
 
-    UpnpProvider_Lock(thiz->provider);
+    UpnpProvider_ReadLock(thiz->provider);
     {
         OnRequestContext ctx;
         ctx.registry = thiz;
-        ctx.request = request;
-        ctx.localIp = localIp;
-        ctx.remoteIp = remoteIp;
-        ctx.remotePort = remotePort;
+        ctx.st = request->st;
+        ctx.localIp = request->localIp;
+        ctx.remoteIp = request->remoteIp;
+        ctx.remotePort = request->remotePort;
 
         UpnpProvider_Foreach(thiz->provider, request->st, OnRequestDeviceVisit, &ctx);
     }
-    UpnpProvider_Unlock(thiz->provider);
+    UpnpProvider_ReadUnlock(thiz->provider);
 }
 
-static void UpnpRegistry_OnResponse(UpnpRegistry *thiz, SsdpResponse *response, const char *ip)
+static void UpnpRegistry_OnResponse(UpnpRegistry *thiz, SsdpPacket *response)
 {
     LOG_D(TAG, "OnResponse: %s", response->st);
 
-    UpnpObjectList_Lock(&thiz->foundObjects);
-
     do
     {
+        UpnpObjectListener listener = thiz->listener;
         UpnpObject *obj = NULL;
+        UpnpObject found;
 
-        if (thiz->listener == NULL)
+        if (listener == NULL)
         {
             break;
         }
 
+        /**
+         * fast path: refresh of a known object, no parsing
+         */
+        if (UpnpSeenCache_Contains(&thiz->seen, response->usn, response->location))
+        {
+            if (UpnpObjectList_RefreshObject(&thiz->foundObjects, response->usn))
+            {
+                break;
+            }
+
+            UpnpSeenCache_Remove(&thiz->seen, response->usn);
+        }
+
         if (!UpnpValidator_ValidateUSN(&thiz->validator, response->usn))
         {
             break;
         }
 
-        obj = UpnpObjectList_GetObject(&thiz->foundObjects, response->usn);
-        if (obj != NULL)
+        if (UpnpObjectList_RefreshObject(&thiz->foundObjects, response->usn))
         {
-            UpnpObject_UpdateNextNotify(obj);
+            UpnpSeenCache_Put(&thiz->seen, response->usn, response->location);
             break;
         }
 
-        obj = UpnpObjectFactory_CreateByResponse(response, ip, &thiz->validator);
+        obj = UpnpObjectFactory_CreateByResponse(response, &thiz->validator);
         if (obj == NULL)
         {
             break;
         }
 
-        UpnpObjectList_AddObject(&thiz->foundObjects, obj);
-        thiz->listener(obj, true, thiz->ctx);
+        if (RET_FAILED(UpnpObject_Construct(&found)))
+        {
+            UpnpObject_Delete(obj);
+            break;
+        }
+
+        /**
+         * the list owns obj once added, listener gets a copy outside the lock
+         */
+        UpnpObject_Copy(&found, obj);
+
+        if (RET_SUCCEEDED(UpnpObjectList_AddObject(&thiz->foundObjects, obj)))
+        {
+            UpnpSearch_OnFound(&thiz->search);
+            UpnpSeenCache_Put(&thiz->seen, response->usn, response->location);
+            listener(&found, true, thiz->ctx);
+        }
+        else
+        {
+            UpnpObject_Delete(obj);
+        }
+
+        UpnpObject_Dispose(&found);
     } while (0);
+}
+
+static bool UpnpRegistry_OnTimer(TinyTimer *timer, void *ctx)
+{
+    UpnpRegistry *thiz = (UpnpRegistry *)ctx;
+
+    UpnpRegistry_RemoveExpired(thiz);
+
+    if (UpnpSearch_IsRoundDue(&thiz->search, tiny_getusec()))
+    {
+        UpnpRegistry_SendSearch(thiz);
+    }
+
+    return true;
+}
+
+static void UpnpRegistry_RemoveExpired(UpnpRegistry *thiz)
+{
+    uint64_t now = tiny_getusec() / 1000 / 1000;
+    UpnpObject found;
+
+    if (RET_FAILED(UpnpObject_Construct(&found)))
+    {
+        return;
+    }
+
+    while (UpnpObjectList_RemoveExpiredObject(&thiz->foundObjects, now, &found))
+    {
+        UpnpObjectListener listener = thiz->listener;
+
+        LOG_D(TAG, "OnExpired: %s", UpnpObject_GetUsn(&found));
 
-    UpnpObjectList_Unlock(&thiz->foundObjects);
+        UpnpSeenCache_Remove(&thiz->seen, UpnpObject_GetUsn(&found));
+
+        if (listener != NULL)
+        {
+            listener(&found, false, thiz->ctx);
+        }
+    }
+
+    UpnpObject_Dispose(&found);
+}
+
+static TinyRet UpnpRegistry_SendSearch(UpnpRegistry *thiz)
+{
+    TinyRet ret = TINY_RET_OK;
+    uint32_t i = 0;
+
+    UpnpSearch_Lock(&thiz->search);
+
+    for (i = 0; i < UpnpSearch_GetTargetCount(&thiz->search); ++i)
+    {
+        SsdpMessage message;
+
+        ret = SsdpMessage_ConstructRequest(&message, UpnpSearch_GetTargetAt(&thiz->search, i), UpnpSearch_GetMx(&thiz->search));
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+
+        ret = Ssdp_SendMessage(&thiz->ssdp, &message);
+
+        SsdpMessage_Dispose(&message);
+    }
+
+    UpnpSearch_Unlock(&thiz->search);
+
+    return ret;
 }
 
 static void OnDeviceAdded(UpnpDevice *device, void *ctx)
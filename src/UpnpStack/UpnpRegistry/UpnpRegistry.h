@@ -20,7 +20,10 @@
 #include "UpnpObject.h"
 #include "UpnpObjectList.h"
 #include "UpnpValidator.h"
+#include "UpnpSeenCache.h"
+#include "UpnpSearch.h"
 #include "UpnpProvider.h"
+#include "TinyTimer.h"
 
 TINY_BEGIN_DECLS
 
@@ -35,6 +38,9 @@ typedef struct _UpnpRegistry
     void                      * ctx;
     UpnpValidator               validator;
     UpnpObjectList              foundObjects;
+    UpnpSeenCache               seen;
+    UpnpSearch                  search;
+    TinyTimer                   timer;
 } UpnpRegistry;
 
 UpnpRegistry * UpnpRegistry_New(UpnpProvider *provider);
@@ -43,7 +49,7 @@ void UpnpRegistry_Dispose(UpnpRegistry *thiz);
 void UpnpRegistry_Delete(UpnpRegistry *thiz);
 TinyRet UpnpRegistry_Start(UpnpRegistry *thiz);
 TinyRet UpnpRegistry_Stop(UpnpRegistry *thiz);
-TinyRet UpnpRegistry_Discover(UpnpRegistry *thiz, bool strictedUuid, UpnpObjectListener listener, UpnpObjectFilter filter, void *ctx);
+TinyRet UpnpRegistry_Discover(UpnpRegistry *thiz, bool strictedUuid, const char *targets[], uint32_t count, uint32_t mx, UpnpObjectListener listener, UpnpObjectFilter filter, void *ctx);
 TinyRet UpnpRegistry_StopDiscovery(UpnpRegistry *thiz);
 
 
@@ -0,0 +1,166 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpSearch.c
+*
+* @remark
+*
+*/
+
+#include "UpnpSearch.h"
+#include "tiny_log.h"
+
+#define TAG     "UpnpSearch"
+
+static uint64_t UpnpSearch_GetDelay(UpnpSearch *thiz)
+{
+    return ((uint64_t)(thiz->mx + 1) * 1000 * 1000) << (thiz->round - 1);
+}
+
+TinyRet UpnpSearch_Construct(UpnpSearch *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    memset(thiz, 0, sizeof(UpnpSearch));
+
+    return TinyMutex_Construct(&thiz->mutex);
+}
+
+void UpnpSearch_Dispose(UpnpSearch *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Dispose(&thiz->mutex);
+}
+
+TinyRet UpnpSearch_Start(UpnpSearch *thiz, const char *targets[], uint32_t count, uint32_t mx)
+{
+    uint32_t i = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(count <= UPNP_SEARCH_TARGET_MAX, TINY_RET_E_ARG_INVALID);
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    memset(thiz->targets, 0, sizeof(thiz->targets));
+
+    if (count == 0 || targets == NULL)
+    {
+        strncpy(thiz->targets[0], DEFAULT_ST, HEAD_ST_LEN);
+        thiz->count = 1;
+    }
+    else
+    {
+        for (i = 0; i < count; ++i)
+        {
+            strncpy(thiz->targets[i], targets[i], HEAD_ST_LEN);
+        }
+
+        thiz->count = count;
+    }
+
+    thiz->mx = (mx == 0) ? DEFAULT_MX : mx;
+    thiz->round = 0;
+    thiz->next = 0;
+    thiz->found = 0;
+    thiz->active = true;
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return TINY_RET_OK;
+}
+
+void UpnpSearch_Stop(UpnpSearch *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Lock(&thiz->mutex);
+    thiz->active = false;
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+void UpnpSearch_OnFound(UpnpSearch *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Lock(&thiz->mutex);
+    thiz->found++;
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+bool UpnpSearch_IsRoundDue(UpnpSearch *thiz, uint64_t now)
+{
+    bool due = false;
+
+    RETURN_VAL_IF_FAIL(thiz, false);
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    do
+    {
+        if (!thiz->active || now < thiz->next)
+        {
+            break;
+        }
+
+        /**
+         * the first retry is unconditional, UDP may have lost the first round
+         */
+        if (thiz->round >= 2 && thiz->found == 0)
+        {
+            LOG_D(TAG, "stable after %d rounds", thiz->round);
+            thiz->active = false;
+            break;
+        }
+
+        if (thiz->round >= UPNP_SEARCH_ROUND_MAX)
+        {
+            thiz->active = false;
+            break;
+        }
+
+        thiz->round++;
+        thiz->found = 0;
+        thiz->next = now + UpnpSearch_GetDelay(thiz);
+        due = true;
+    } while (0);
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return due;
+}
+
+void UpnpSearch_Lock(UpnpSearch *thiz)
+{
+    TinyMutex_Lock(&thiz->mutex);
+}
+
+void UpnpSearch_Unlock(UpnpSearch *thiz)
+{
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+uint32_t UpnpSearch_GetTargetCount(UpnpSearch *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, 0);
+
+    return thiz->count;
+}
+
+const char * UpnpSearch_GetTargetAt(UpnpSearch *thiz, uint32_t index)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+    RETURN_VAL_IF_FAIL(index < thiz->count, NULL);
+
+    return thiz->targets[index];
+}
+
+uint32_t UpnpSearch_GetMx(UpnpSearch *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, 0);
+
+    return thiz->mx;
+}
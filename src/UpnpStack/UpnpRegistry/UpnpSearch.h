@@ -0,0 +1,64 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpSearch.h
+*
+* @remark
+*
+*/
+
+#ifndef __UPNP_SEARCH_H__
+#define __UPNP_SEARCH_H__
+
+#include "tiny_base.h"
+#include "TinyMutex.h"
+#include "SsdpMessage.h"
+
+TINY_BEGIN_DECLS
+
+
+#define UPNP_SEARCH_TARGET_MAX      16
+#define UPNP_SEARCH_ROUND_MAX       5
+
+/**
+ * M-SEARCH schedule: one round = one request per target.
+ * Round n + 1 is sent (MX + 1) * 2^n seconds after round n,
+ * and the search stops as soon as a round finds nothing new.
+ */
+typedef struct _UpnpSearch
+{
+    TinyMutex                   mutex;
+    bool                        active;
+    char                        targets[UPNP_SEARCH_TARGET_MAX][HEAD_ST_LEN + 1];
+    uint32_t                    count;
+    uint32_t                    mx;
+    uint32_t                    round;
+    uint64_t                    next;
+    uint32_t                    found;
+} UpnpSearch;
+
+TinyRet UpnpSearch_Construct(UpnpSearch *thiz);
+void UpnpSearch_Dispose(UpnpSearch *thiz);
+
+TinyRet UpnpSearch_Start(UpnpSearch *thiz, const char *targets[], uint32_t count, uint32_t mx);
+void UpnpSearch_Stop(UpnpSearch *thiz);
+void UpnpSearch_OnFound(UpnpSearch *thiz);
+
+/**
+ * true if a round is due at 'now' (usec), the schedule is advanced.
+ */
+bool UpnpSearch_IsRoundDue(UpnpSearch *thiz, uint64_t now);
+
+void UpnpSearch_Lock(UpnpSearch *thiz);
+void UpnpSearch_Unlock(UpnpSearch *thiz);
+uint32_t UpnpSearch_GetTargetCount(UpnpSearch *thiz);
+const char * UpnpSearch_GetTargetAt(UpnpSearch *thiz, uint32_t index);
+uint32_t UpnpSearch_GetMx(UpnpSearch *thiz);
+
+
+TINY_END_DECLS
+
+#endif /* __UPNP_SEARCH_H__ */
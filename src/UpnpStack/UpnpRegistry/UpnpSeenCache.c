@@ -0,0 +1,113 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpSeenCache.c
+*
+* @remark
+*
+*/
+
+#include "UpnpSeenCache.h"
+#include "tiny_str_hash.h"
+
+TinyRet UpnpSeenCache_Construct(UpnpSeenCache *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    memset(thiz, 0, sizeof(UpnpSeenCache));
+
+    return TinyMutex_Construct(&thiz->mutex);
+}
+
+void UpnpSeenCache_Dispose(UpnpSeenCache *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Dispose(&thiz->mutex);
+}
+
+bool UpnpSeenCache_Contains(UpnpSeenCache *thiz, const char *usn, const char *location)
+{
+    bool found = false;
+    uint32_t hash = 0;
+    UpnpSeenEntry *entry = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, false);
+    RETURN_VAL_IF_FAIL(usn, false);
+    RETURN_VAL_IF_FAIL(location, false);
+
+    hash = str_hash(usn);
+    entry = &thiz->entries[hash % UPNP_SEEN_CACHE_SIZE];
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    found = (entry->hash == hash && STR_EQUAL(entry->usn, usn) && STR_EQUAL(entry->location, location));
+    if (found)
+    {
+        thiz->hits++;
+    }
+    else
+    {
+        thiz->misses++;
+    }
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return found;
+}
+
+void UpnpSeenCache_Put(UpnpSeenCache *thiz, const char *usn, const char *location)
+{
+    uint32_t hash = 0;
+    UpnpSeenEntry *entry = NULL;
+
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(usn);
+    RETURN_IF_FAIL(location);
+
+    hash = str_hash(usn);
+    entry = &thiz->entries[hash % UPNP_SEEN_CACHE_SIZE];
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    entry->hash = hash;
+    strncpy(entry->usn, usn, UPNP_USN_LEN - 1);
+    entry->usn[UPNP_USN_LEN - 1] = 0;
+    strncpy(entry->location, location, HEAD_LOCATION_LEN);
+    entry->location[HEAD_LOCATION_LEN] = 0;
+
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+void UpnpSeenCache_Remove(UpnpSeenCache *thiz, const char *usn)
+{
+    uint32_t hash = 0;
+    UpnpSeenEntry *entry = NULL;
+
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(usn);
+
+    hash = str_hash(usn);
+    entry = &thiz->entries[hash % UPNP_SEEN_CACHE_SIZE];
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    if (entry->hash == hash && STR_EQUAL(entry->usn, usn))
+    {
+        memset(entry, 0, sizeof(UpnpSeenEntry));
+    }
+
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+void UpnpSeenCache_Clear(UpnpSeenCache *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Lock(&thiz->mutex);
+    memset(thiz->entries, 0, sizeof(thiz->entries));
+    TinyMutex_Unlock(&thiz->mutex);
+}
@@ -0,0 +1,56 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpSeenCache.h
+*
+* @remark
+*
+*/
+
+#ifndef __UPNP_SEEN_CACHE_H__
+#define __UPNP_SEEN_CACHE_H__
+
+#include "tiny_base.h"
+#include "TinyMutex.h"
+#include "UpnpObject.h"
+#include "SsdpMessage.h"
+
+TINY_BEGIN_DECLS
+
+
+#define UPNP_SEEN_CACHE_SIZE        256
+
+/**
+ * Direct-mapped cache of (USN, LOCATION) pairs that already passed validation.
+ * A hit means the announcement is a refresh of a known object.
+ */
+typedef struct _UpnpSeenEntry
+{
+    uint32_t                    hash;
+    char                        usn[UPNP_USN_LEN];
+    char                        location[HEAD_LOCATION_LEN + 1];
+} UpnpSeenEntry;
+
+typedef struct _UpnpSeenCache
+{
+    TinyMutex                   mutex;
+    UpnpSeenEntry               entries[UPNP_SEEN_CACHE_SIZE];
+    uint32_t                    hits;
+    uint32_t                    misses;
+} UpnpSeenCache;
+
+TinyRet UpnpSeenCache_Construct(UpnpSeenCache *thiz);
+void UpnpSeenCache_Dispose(UpnpSeenCache *thiz);
+
+bool UpnpSeenCache_Contains(UpnpSeenCache *thiz, const char *usn, const char *location);
+void UpnpSeenCache_Put(UpnpSeenCache *thiz, const char *usn, const char *location);
+void UpnpSeenCache_Remove(UpnpSeenCache *thiz, const char *usn);
+void UpnpSeenCache_Clear(UpnpSeenCache *thiz);
+
+
+TINY_END_DECLS
+
+#endif /* __UPNP_SEEN_CACHE_H__ */
@@ -13,18 +13,249 @@
 #include "UpnpDeviceFactory.h"
 #include "UpnpDeviceParser.h"
 #include "UpnpServiceParser.h"
+#include "TinyMutex.h"
+#include "TinyThread.h"
+#include "tiny_memory.h"
 #include "tiny_log.h"
+#include "tiny_time.h"
 
 #define TAG         "UpnpDeviceFactory"
 
+typedef struct _UpnpScpdFetch
+{
+    UpnpService               * service;
+    char                        url[TINY_URL_LEN];
+    TinyRet                     result;
+    uint64_t                    elapsed;
+} UpnpScpdFetch;
+
+/**
+ * Fetchers take the next SCPD off a shared cursor; after a failure they
+ * take no new ones and the device is given up once those in flight end.
+ */
+typedef struct _UpnpScpdFetcher
+{
+    TinyMutex                   mutex;
+    UpnpScpdCache             * cache;
+    UpnpScpdFetch             * fetches;
+    uint32_t                    count;
+    uint32_t                    next;
+    bool                        failed;
+} UpnpScpdFetcher;
+
+static void fetch_loop(void *param)
+{
+    UpnpScpdFetcher *thiz = (UpnpScpdFetcher *)param;
+
+    while (true)
+    {
+        UpnpScpdFetch *fetch = NULL;
+        uint64_t start = 0;
+
+        TinyMutex_Lock(&thiz->mutex);
+
+        if (!thiz->failed && thiz->next < thiz->count)
+        {
+            fetch = &thiz->fetches[thiz->next++];
+        }
+
+        TinyMutex_Unlock(&thiz->mutex);
+
+        if (fetch == NULL)
+        {
+            break;
+        }
+
+        start = tiny_getusec();
+        fetch->result = UpnpServiceParser_Parse(fetch->url, fetch->service, thiz->cache, UPNP_TIMEOUT);
+        fetch->elapsed = tiny_getusec() - start;
+
+        if (RET_FAILED(fetch->result))
+        {
+            TinyMutex_Lock(&thiz->mutex);
+            thiz->failed = true;
+            TinyMutex_Unlock(&thiz->mutex);
+        }
+    }
+}
+
+static void UpnpDeviceFactory_SetStats(UpnpDeviceFactoryStats *stats, UpnpScpdFetcher *fetcher)
+{
+    uint32_t i = 0;
+
+    if (stats->fetches != NULL)
+    {
+        tiny_free(stats->fetches);
+        stats->count = 0;
+    }
+
+    stats->fetches = (UpnpScpdFetchStats *)tiny_malloc(sizeof(UpnpScpdFetchStats) * fetcher->count);
+    if (stats->fetches == NULL)
+    {
+        LOG_E(TAG, "OUT OF MEMORY");
+        return;
+    }
+
+    stats->count = fetcher->count;
+
+    for (i = 0; i < fetcher->count; ++i)
+    {
+        UpnpScpdFetch *fetch = &fetcher->fetches[i];
+
+        strncpy(stats->fetches[i].url, fetch->url, TINY_URL_LEN);
+        stats->fetches[i].result = fetch->result;
+        stats->fetches[i].elapsed = fetch->elapsed;
+    }
+}
+
+static TinyRet UpnpDeviceFactory_FetchServices(UpnpDevice *device, const char *urlbase, UpnpScpdCache *cache, UpnpDeviceFactoryStats *stats)
+{
+    TinyRet ret = TINY_RET_OK;
+    UpnpScpdFetcher fetcher;
+    TinyThread threads[UPNP_DEVICE_FACTORY_MAX_FETCHES - 1];
+    uint32_t threadCount = 0;
+    uint32_t i = 0;
+    uint64_t start = tiny_getusec();
+
+    memset(&fetcher, 0, sizeof(UpnpScpdFetcher));
+    fetcher.cache = cache;
+
+    fetcher.count = UpnpDevice_GetServiceCount(device);
+    if (fetcher.count == 0)
+    {
+        return TINY_RET_OK;
+    }
+
+    fetcher.fetches = (UpnpScpdFetch *)tiny_malloc(sizeof(UpnpScpdFetch) * fetcher.count);
+    if (fetcher.fetches == NULL)
+    {
+        return TINY_RET_E_OUT_OF_MEMORY;
+    }
+
+    memset(fetcher.fetches, 0, sizeof(UpnpScpdFetch) * fetcher.count);
+
+    do
+    {
+        for (i = 0; i < fetcher.count; ++i)
+        {
+            UpnpScpdFetch *fetch = &fetcher.fetches[i];
+            const char *scpdUrl = NULL;
+
+            fetch->service = UpnpDevice_GetServiceAt(device, i);
+            scpdUrl = UpnpService_GetSCPDURL(fetch->service);
+            if (scpdUrl == NULL)
+            {
+                LOG_D(TAG, "Get <SCPDURL> failed");
+                ret = TINY_RET_E_NOT_FOUND;
+                break;
+            }
+
+            tiny_snprintf(fetch->url, TINY_URL_LEN, "%s%s", urlbase, scpdUrl);
+        }
+
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+
+        ret = TinyMutex_Construct(&fetcher.mutex);
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+
+        for (i = 0; i + 1 < fetcher.count && i + 1 < UPNP_DEVICE_FACTORY_MAX_FETCHES; i++)
+        {
+            if (RET_FAILED(TinyThread_Construct(&threads[i])))
+            {
+                break;
+            }
+
+            if (RET_FAILED(TinyThread_Initialize(&threads[i], fetch_loop, &fetcher, "UpnpDeviceFactory"))
+                || !TinyThread_Start(&threads[i]))
+            {
+                TinyThread_Dispose(&threads[i]);
+                break;
+            }
+
+            threadCount++;
+        }
+
+        /**
+         * fewer threads than asked for only means fewer fetches at once
+         */
+        fetch_loop(&fetcher);
+
+        for (i = 0; i < threadCount; i++)
+        {
+            TinyThread_Join(&threads[i]);
+            TinyThread_Dispose(&threads[i]);
+        }
+
+        TinyMutex_Dispose(&fetcher.mutex);
+
+        for (i = 0; i < fetcher.count; ++i)
+        {
+            UpnpScpdFetch *fetch = &fetcher.fetches[i];
+
+            LOG_D(TAG, "SCPD %s: %s, %llu ms", fetch->url, tiny_ret_to_str(fetch->result), (unsigned long long)(fetch->elapsed / 1000));
+
+            if (RET_FAILED(fetch->result))
+            {
+                ret = fetch->result;
+            }
+        }
+
+        LOG_D(TAG, "%d SCPDs, %d fetches at once: %llu ms", fetcher.count, threadCount + 1, (unsigned long long)((tiny_getusec() - start) / 1000));
+
+        if (stats != NULL)
+        {
+            stats->fetchers = threadCount + 1;
+            stats->elapsed = tiny_getusec() - start;
+            UpnpDeviceFactory_SetStats(stats, &fetcher);
+        }
+    } while (0);
+
+    tiny_free(fetcher.fetches);
+
+    return ret;
+}
+
+void UpnpDeviceFactoryStats_Construct(UpnpDeviceFactoryStats *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    memset(thiz, 0, sizeof(UpnpDeviceFactoryStats));
+}
+
+void UpnpDeviceFactoryStats_Dispose(UpnpDeviceFactoryStats *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    if (thiz->fetches != NULL)
+    {
+        tiny_free(thiz->fetches);
+    }
+
+    memset(thiz, 0, sizeof(UpnpDeviceFactoryStats));
+}
+
 UpnpDevice * UpnpDeviceFactory_Create(UpnpDeviceSummary *summary)
+{
+    return UpnpDeviceFactory_CreateWithStats(summary, NULL, NULL);
+}
+
+UpnpDevice * UpnpDeviceFactory_CreateWithCache(UpnpDeviceSummary *summary, UpnpScpdCache *cache)
+{
+    return UpnpDeviceFactory_CreateWithStats(summary, cache, NULL);
+}
+
+UpnpDevice * UpnpDeviceFactory_CreateWithStats(UpnpDeviceSummary *summary, UpnpScpdCache *cache, UpnpDeviceFactoryStats *stats)
 {
     UpnpDevice * device = NULL;
 
     do
     {
-        uint32_t i = 0;
-        uint32_t size = 0;
         TinyRet ret = TINY_RET_OK;
         const char *urlbase = NULL;
 
@@ -55,28 +286,7 @@ UpnpDevice * UpnpDeviceFactory_Create(UpnpDeviceSummary *summary)
             break;
         }
 
-        size = UpnpDevice_GetServiceCount(device);
-        for (i = 0; i < size; ++i)
-        {
-            char url[TINY_URL_LEN];
-            UpnpService *service = UpnpDevice_GetServiceAt(device, i);
-            const char *scpdUrl = UpnpService_GetSCPDURL(service);
-            if (scpdUrl == NULL)
-            {
-                LOG_D(TAG, "Get <SCPDURL> failed");
-                ret = TINY_RET_E_NOT_FOUND;
-                break;
-            }
-
-            tiny_snprintf(url, TINY_URL_LEN, "%s%s", urlbase, scpdUrl);
-
-            ret = UpnpServiceParser_Parse(url, service, UPNP_TIMEOUT);
-            if (RET_FAILED(ret))
-            {
-                break;
-            }
-        }
-
+        ret = UpnpDeviceFactory_FetchServices(device, urlbase, cache, stats);
         if (RET_FAILED(ret))
         {
             UpnpDevice_Delete(device);
@@ -86,4 +296,4 @@ UpnpDevice * UpnpDeviceFactory_Create(UpnpDeviceSummary *summary)
     } while (0);
 
     return device;
-}
\ No newline at end of file
+}
@@ -17,12 +17,54 @@
 #include "upnp_api.h"
 #include "UpnpDevice.h"
 #include "UpnpDeviceSummary.h"
+#include "UpnpScpdCache.h"
 
 TINY_BEGIN_DECLS
 
 
+/**
+ * SCPDs of one device fetched at once, the calling thread included
+ */
+#define UPNP_DEVICE_FACTORY_MAX_FETCHES     4
+
+/**
+ * one SCPD of the device, elapsed in usec
+ */
+typedef struct _UpnpScpdFetchStats
+{
+    char                        url[TINY_URL_LEN];
+    TinyRet                     result;
+    uint64_t                    elapsed;
+} UpnpScpdFetchStats;
+
+/**
+ * how the SCPDs of a device were fetched, elapsed in usec; fetches has
+ * one entry per service, in device order, and is freed by Dispose
+ */
+typedef struct _UpnpDeviceFactoryStats
+{
+    uint32_t                    fetchers;
+    uint64_t                    elapsed;
+    uint32_t                    count;
+    UpnpScpdFetchStats        * fetches;
+} UpnpDeviceFactoryStats;
+
+UPNP_API void UpnpDeviceFactoryStats_Construct(UpnpDeviceFactoryStats *thiz);
+UPNP_API void UpnpDeviceFactoryStats_Dispose(UpnpDeviceFactoryStats *thiz);
+
 UPNP_API UpnpDevice * UpnpDeviceFactory_Create(UpnpDeviceSummary *summary);
 
+/**
+ * services whose SCPD is already in cache are copied from it, not parsed
+ */
+UPNP_API UpnpDevice * UpnpDeviceFactory_CreateWithCache(UpnpDeviceSummary *summary, UpnpScpdCache *cache);
+
+/**
+ * stats, if not NULL, is filled in once the SCPDs were fetched, whether
+ * the device was created or not
+ */
+UPNP_API UpnpDevice * UpnpDeviceFactory_CreateWithStats(UpnpDeviceSummary *summary, UpnpScpdCache *cache, UpnpDeviceFactoryStats *stats);
+
 
 TINY_END_DECLS
 
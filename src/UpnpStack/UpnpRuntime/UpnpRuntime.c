@@ -25,6 +25,8 @@
 #include "UpnpSubscription.h"
 #include "UpnpProvider.h"
 #include "UpnpHost.h"
+#include "UpnpDeviceFactory.h"
+#include "UpnpScpdCache.h"
 
 #define TAG             "UpnpRuntime"
 
@@ -42,6 +44,7 @@ struct _UpnpRuntime
     UpnpGenaClient          genaClient;
     UpnpActionInvoker       invoker;
     UpnpRegistry            registry;
+    UpnpScpdCache         * scpdCache;
     UpnpDeviceListener      deviceListener;
     UpnpDeviceFilter        deviceFilter;
     void                  * discoveryCtx;
@@ -127,6 +130,14 @@ static TinyRet UpnpRuntime_Construct(UpnpRuntime *thiz)
             LOG_E(TAG, "UpnpRegistry_Construct failed");
             break;
         }
+
+        thiz->scpdCache = UpnpScpdCache_New(UPNP_SCPD_CACHE_DEFAULT_CAPACITY);
+        if (thiz->scpdCache == NULL)
+        {
+            LOG_E(TAG, "UpnpScpdCache_New failed");
+            ret = TINY_RET_E_NEW;
+            break;
+        }
     } while (0);
 
     return ret;
@@ -136,6 +147,12 @@ static void UpnpRuntime_Dispose(UpnpRuntime *thiz)
 {
     RETURN_IF_FAIL(thiz);
 
+    if (thiz->scpdCache != NULL)
+    {
+        UpnpScpdCache_Delete(thiz->scpdCache);
+        thiz->scpdCache = NULL;
+    }
+
     UpnpRegistry_Dispose(&thiz->registry);
     UpnpGenaClient_Dispose(&thiz->genaClient);
     UpnpActionInvoker_Dispose(&thiz->invoker);
@@ -218,7 +235,7 @@ TinyRet UpnpRuntime_Stop(UpnpRuntime *thiz)
     return ret;
 }
 
-TinyRet UpnpRuntime_StartScan(UpnpRuntime *thiz, UpnpDeviceListener listener, UpnpDeviceFilter filter, void *ctx)
+TinyRet UpnpRuntime_StartScan(UpnpRuntime *thiz, const char *targets[], uint32_t count, uint32_t mx, UpnpDeviceListener listener, UpnpDeviceFilter filter, void *ctx)
 {
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(listener, TINY_RET_E_ARG_NULL);
@@ -228,7 +245,7 @@ TinyRet UpnpRuntime_StartScan(UpnpRuntime *thiz, UpnpDeviceListener listener, Up
     thiz->deviceFilter = filter;
     thiz->discoveryCtx = ctx;
 
-    return UpnpRegistry_Discover(&thiz->registry, false, object_listener, object_filter, thiz);
+    return UpnpRegistry_Discover(&thiz->registry, false, targets, count, mx, object_listener, object_filter, thiz);
 }
 
 TinyRet UpnpRuntime_StopScan(UpnpRuntime *thiz)
@@ -238,6 +255,14 @@ TinyRet UpnpRuntime_StopScan(UpnpRuntime *thiz)
     return UpnpRegistry_StopDiscovery(&thiz->registry);
 }
 
+UpnpDevice * UpnpRuntime_CreateDevice(UpnpRuntime *thiz, UpnpDeviceSummary *summary)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+    RETURN_VAL_IF_FAIL(summary, NULL);
+
+    return UpnpDeviceFactory_CreateWithCache(summary, thiz->scpdCache);
+}
+
 TinyRet UpnpRuntime_Invoke(UpnpRuntime *thiz, UpnpAction *action, UpnpError *error)
 {
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
@@ -285,19 +310,47 @@ TinyRet UpnpRuntime_Register(UpnpRuntime *thiz, UpnpDevice *device, UpnpActionHa
     return ret;
 }
 
+TinyRet UpnpRuntime_RegisterAsync(UpnpRuntime *thiz, UpnpDevice *device, UpnpAsyncActionHandler handler, void *ctx)
+{
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(device, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(handler, TINY_RET_E_ARG_NULL);
+
+    UpnpProvider_Lock(&thiz->provider); 
+    {
+        UpnpDevice_SetHttpPort(device, UpnpHttpServer_GetListeningPort(&thiz->http.server));
+
+        ret = UpnpProvider_AddAsync(&thiz->provider, device, handler, ctx);
+    }
+    UpnpProvider_Unlock(&thiz->provider);
+
+    return ret;
+}
+
 TinyRet UpnpRuntime_Unregister(UpnpRuntime *thiz, const char *deviceId)
 {
     TinyRet ret = TINY_RET_OK;
+    UpnpActionHandlerContext *context = NULL;
 
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(deviceId, TINY_RET_E_ARG_NULL);
 
     UpnpProvider_Lock(&thiz->provider);
     {
-        ret = UpnpProvider_Remove(&thiz->provider, deviceId);
+        ret = UpnpProvider_Remove(&thiz->provider, deviceId, &context);
     }
     UpnpProvider_Unlock(&thiz->provider);
 
+    /**
+     * outside the lock: requests for other devices go on meanwhile
+     */
+    if (context != NULL)
+    {
+        UpnpProvider_Drain(&thiz->provider, context);
+    }
+
     return ret;
 }
 
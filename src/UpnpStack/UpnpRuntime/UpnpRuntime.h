@@ -18,6 +18,7 @@
 #include "UpnpError.h"
 #include "UpnpAction.h"
 #include "UpnpDevice.h"
+#include "UpnpDeviceSummary.h"
 #include "UpnpListener.h"
 
 TINY_BEGIN_DECLS
@@ -34,17 +35,36 @@ UPNP_API TinyRet UpnpRuntime_Stop(UpnpRuntime *thiz);
 
 /**
  * for UpnpControlPoint
+ *
+ * targets: search targets (ST), one M-SEARCH each. NULL or count 0 means "ssdp:all".
+ * mx: maximum response delay in seconds, 0 means default.
  */
-UPNP_API TinyRet UpnpRuntime_StartScan(UpnpRuntime *thiz, UpnpDeviceListener listener, UpnpDeviceFilter filter, void *ctx);
+UPNP_API TinyRet UpnpRuntime_StartScan(UpnpRuntime *thiz, const char *targets[], uint32_t count, uint32_t mx, UpnpDeviceListener listener, UpnpDeviceFilter filter, void *ctx);
 UPNP_API TinyRet UpnpRuntime_StopScan(UpnpRuntime *thiz);
+
+/**
+ * builds the device a scan reported; SCPDs come from the runtime's
+ * cache when one with the same type and content was parsed before
+ */
+UPNP_API UpnpDevice * UpnpRuntime_CreateDevice(UpnpRuntime *thiz, UpnpDeviceSummary *summary);
 UPNP_API TinyRet UpnpRuntime_Invoke(UpnpRuntime *thiz, UpnpAction *action, UpnpError *error);
 UPNP_API TinyRet UpnpRuntime_Subscribe(UpnpRuntime *thiz, UpnpService *service, uint32_t timeout, UpnpEventListener listener, void *ctx, UpnpError *error);
 UPNP_API TinyRet UpnpRuntime_Unsubscribe(UpnpRuntime *thiz, UpnpService *service, UpnpError *error);
 
 /**
  * for UpnpDeviceHost
+ *
+ * Register: the handler works on the service's state variables, so the
+ * actions of one service run one at a time.
+ * RegisterAsync: the handler reads its arguments from its UpnpActionToken,
+ * returns at once and finishes the action later through the token, from
+ * any thread; up to the service limit of them run side by side.
+ * Unregister waits for the device's actions in flight once the device is
+ * unrouted, so other devices are served meanwhile; an action of the device
+ * itself is one of them and must not unregister it synchronously.
  */
 UPNP_API TinyRet UpnpRuntime_Register(UpnpRuntime *thiz, UpnpDevice *device, UpnpActionHandler handler, void *ctx);
+UPNP_API TinyRet UpnpRuntime_RegisterAsync(UpnpRuntime *thiz, UpnpDevice *device, UpnpAsyncActionHandler handler, void *ctx);
 UPNP_API TinyRet UpnpRuntime_Unregister(UpnpRuntime *thiz, const char *deviceId);
 
 
@@ -0,0 +1,447 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpScpdCache.c
+*
+* @remark
+*
+*/
+
+#include "UpnpScpdCache.h"
+#include "TinyMutex.h"
+#include "tiny_memory.h"
+#include "tiny_log.h"
+#include "tiny_str_hash.h"
+
+#define TAG     "UpnpScpdCache"
+
+typedef struct _UpnpScpdEntry
+{
+    struct _UpnpScpdEntry     * next;
+    struct _UpnpScpdEntry     * prev;
+    struct _UpnpScpdEntry     * nextInBucket;
+    uint32_t                    hash;
+    uint32_t                    contentHash;
+    uint32_t                    contentSize;
+    UpnpService               * definition;
+    char                        content[1];
+} UpnpScpdEntry;
+
+/**
+ * Entries are chained in buckets by key and in one list from most to
+ * least recently used. Each keeps its document, so a hash collision can
+ * not hand out the wrong definition.
+ */
+struct _UpnpScpdCache
+{
+    TinyMutex                   mutex;
+    UpnpScpdEntry            ** buckets;
+    uint32_t                    size;
+    UpnpScpdEntry             * head;
+    UpnpScpdEntry             * tail;
+    uint32_t                    capacity;
+    UpnpScpdCacheStats          stats;
+};
+
+static TinyRet UpnpScpdCache_Construct(UpnpScpdCache *thiz, uint32_t capacity);
+static void UpnpScpdCache_Dispose(UpnpScpdCache *thiz);
+
+static uint32_t scpd_hash(const char *serviceType, uint32_t contentHash)
+{
+    return str_hash(serviceType) ^ (contentHash * 0x9E3779B9U);
+}
+
+/**
+ * dst is empty; its names go into its own pool
+ */
+static TinyRet UpnpScpdCache_CopyDefinition(UpnpService *dst, UpnpService *src)
+{
+    TinyRet ret = TINY_RET_OK;
+    uint32_t count = 0;
+    uint32_t i = 0;
+
+    count = UpnpService_GetStateVariableCount(src);
+    for (i = 0; i < count && RET_SUCCEEDED(ret); i++)
+    {
+        UpnpStateVariable *s = UpnpService_GetStateVariableAt(src, i);
+        UpnpStateVariable *v = UpnpStateVariable_New();
+        if (v == NULL)
+        {
+            ret = TINY_RET_E_OUT_OF_MEMORY;
+            break;
+        }
+
+        ret = UpnpStateVariable_Copy(v, s);
+        if (RET_FAILED(ret))
+        {
+            UpnpStateVariable_Delete(v);
+            break;
+        }
+
+        v->sendEvents = s->sendEvents;
+
+        ret = UpnpService_AddStateVariable(dst, v);
+        if (RET_FAILED(ret))
+        {
+            UpnpStateVariable_Delete(v);
+        }
+    }
+
+    count = UpnpService_GetActionCount(src);
+    for (i = 0; i < count && RET_SUCCEEDED(ret); i++)
+    {
+        UpnpAction *s = UpnpService_GetActionAt(src, i);
+        UpnpAction *a = NULL;
+        uint32_t arguments = 0;
+        uint32_t j = 0;
+
+        a = UpnpAction_New();
+        if (a == NULL)
+        {
+            ret = TINY_RET_E_OUT_OF_MEMORY;
+            break;
+        }
+
+        UpnpAction_SetName(a, UpnpAction_GetName(s));
+
+        arguments = UpnpAction_GetArgumentCount(s);
+        for (j = 0; j < arguments; j++)
+        {
+            UpnpArgument *arg = UpnpAction_GetArgumentAt(s, j);
+            UpnpArgument *copy = UpnpArgument_New(UpnpArgument_GetName(arg),
+                UpnpArgument_GetDirection(arg),
+                UpnpArgument_GetRelatedStateVariable(arg));
+            if (copy == NULL)
+            {
+                ret = TINY_RET_E_OUT_OF_MEMORY;
+                break;
+            }
+
+            ret = UpnpAction_AddArgument(a, copy);
+            if (RET_FAILED(ret))
+            {
+                UpnpArgument_Delete(copy);
+                break;
+            }
+        }
+
+        if (RET_SUCCEEDED(ret))
+        {
+            ret = UpnpService_AddAction(dst, a);
+        }
+
+        if (RET_FAILED(ret))
+        {
+            UpnpAction_Delete(a);
+        }
+    }
+
+    return ret;
+}
+
+static UpnpScpdEntry * UpnpScpdCache_Get(UpnpScpdCache *thiz, const char *serviceType, const char *content, uint32_t contentHash, uint32_t contentSize)
+{
+    UpnpScpdEntry *entry = NULL;
+    uint32_t hash = scpd_hash(serviceType, contentHash);
+
+    for (entry = thiz->buckets[hash & (thiz->size - 1)]; entry != NULL; entry = entry->nextInBucket)
+    {
+        if (entry->hash == hash
+            && entry->contentHash == contentHash
+            && entry->contentSize == contentSize
+            && STR_EQUAL(UpnpService_GetServiceType(entry->definition), serviceType)
+            && memcmp(entry->content, content, contentSize) == 0)
+        {
+            break;
+        }
+    }
+
+    return entry;
+}
+
+static void UpnpScpdCache_Unlink(UpnpScpdCache *thiz, UpnpScpdEntry *entry)
+{
+    if (entry->prev != NULL)
+    {
+        entry->prev->next = entry->next;
+    }
+    else
+    {
+        thiz->head = entry->next;
+    }
+
+    if (entry->next != NULL)
+    {
+        entry->next->prev = entry->prev;
+    }
+    else
+    {
+        thiz->tail = entry->prev;
+    }
+
+    entry->prev = NULL;
+    entry->next = NULL;
+}
+
+static void UpnpScpdCache_PushFront(UpnpScpdCache *thiz, UpnpScpdEntry *entry)
+{
+    entry->prev = NULL;
+    entry->next = thiz->head;
+
+    if (thiz->head != NULL)
+    {
+        thiz->head->prev = entry;
+    }
+    else
+    {
+        thiz->tail = entry;
+    }
+
+    thiz->head = entry;
+}
+
+static void UpnpScpdCache_Evict(UpnpScpdCache *thiz, UpnpScpdEntry *entry)
+{
+    UpnpScpdEntry **link = &thiz->buckets[entry->hash & (thiz->size - 1)];
+
+    while (*link != NULL)
+    {
+        if (*link == entry)
+        {
+            *link = entry->nextInBucket;
+            break;
+        }
+
+        link = &(*link)->nextInBucket;
+    }
+
+    UpnpScpdCache_Unlink(thiz, entry);
+    UpnpService_Delete(entry->definition);
+    tiny_free(entry);
+
+    thiz->stats.entries--;
+}
+
+UpnpScpdCache * UpnpScpdCache_New(uint32_t capacity)
+{
+    UpnpScpdCache *thiz = NULL;
+
+    do
+    {
+        thiz = (UpnpScpdCache *)tiny_malloc(sizeof(UpnpScpdCache));
+        if (thiz == NULL)
+        {
+            break;
+        }
+
+        if (RET_FAILED(UpnpScpdCache_Construct(thiz, capacity)))
+        {
+            UpnpScpdCache_Delete(thiz);
+            thiz = NULL;
+            break;
+        }
+    } while (0);
+
+    return thiz;
+}
+
+void UpnpScpdCache_Delete(UpnpScpdCache *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    UpnpScpdCache_Dispose(thiz);
+    tiny_free(thiz);
+}
+
+static TinyRet UpnpScpdCache_Construct(UpnpScpdCache *thiz, uint32_t capacity)
+{
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    do
+    {
+        memset(thiz, 0, sizeof(UpnpScpdCache));
+
+        thiz->capacity = (capacity > 0) ? capacity : UPNP_SCPD_CACHE_DEFAULT_CAPACITY;
+
+        thiz->size = 16;
+        while (thiz->size < thiz->capacity)
+        {
+            thiz->size *= 2;
+        }
+
+        thiz->buckets = (UpnpScpdEntry **)tiny_malloc(sizeof(UpnpScpdEntry *) * thiz->size);
+        if (thiz->buckets == NULL)
+        {
+            ret = TINY_RET_E_OUT_OF_MEMORY;
+            break;
+        }
+
+        memset(thiz->buckets, 0, sizeof(UpnpScpdEntry *) * thiz->size);
+
+        ret = TinyMutex_Construct(&thiz->mutex);
+        if (RET_FAILED(ret))
+        {
+            LOG_E(TAG, "TinyMutex_Construct failed");
+            break;
+        }
+    } while (0);
+
+    return ret;
+}
+
+static void UpnpScpdCache_Dispose(UpnpScpdCache *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    if (thiz->buckets != NULL)
+    {
+        while (thiz->head != NULL)
+        {
+            UpnpScpdCache_Evict(thiz, thiz->head);
+        }
+
+        tiny_free(thiz->buckets);
+        thiz->buckets = NULL;
+
+        TinyMutex_Dispose(&thiz->mutex);
+    }
+}
+
+void UpnpScpdCache_GetStats(UpnpScpdCache *thiz, UpnpScpdCacheStats *stats)
+{
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(stats);
+
+    TinyMutex_Lock(&thiz->mutex);
+    memcpy(stats, &thiz->stats, sizeof(UpnpScpdCacheStats));
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+TinyRet UpnpScpdCache_Load(UpnpScpdCache *thiz, const char *content, uint32_t size, UpnpService *service)
+{
+    TinyRet ret = TINY_RET_OK;
+    const char *serviceType = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(content, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(service, TINY_RET_E_ARG_NULL);
+
+    serviceType = UpnpService_GetServiceType(service);
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    do
+    {
+        UpnpScpdEntry *entry = UpnpScpdCache_Get(thiz, serviceType, content, str_hash_n(content, size), size);
+        if (entry == NULL)
+        {
+            thiz->stats.misses++;
+            ret = TINY_RET_E_NOT_FOUND;
+            break;
+        }
+
+        thiz->stats.hits++;
+
+        if (entry != thiz->head)
+        {
+            UpnpScpdCache_Unlink(thiz, entry);
+            UpnpScpdCache_PushFront(thiz, entry);
+        }
+
+        /**
+         * under the lock: the definition may otherwise be evicted meanwhile
+         */
+        ret = UpnpScpdCache_CopyDefinition(service, entry->definition);
+    } while (0);
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return ret;
+}
+
+TinyRet UpnpScpdCache_Store(UpnpScpdCache *thiz, const char *content, uint32_t size, UpnpService *service)
+{
+    TinyRet ret = TINY_RET_OK;
+    UpnpScpdEntry *entry = NULL;
+    uint32_t contentHash = 0;
+    const char *serviceType = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(content, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(service, TINY_RET_E_ARG_NULL);
+
+    serviceType = UpnpService_GetServiceType(service);
+    contentHash = str_hash_n(content, size);
+
+    /**
+     * copied outside the lock, a service fetched twice at once is dropped below
+     */
+    entry = (UpnpScpdEntry *)tiny_malloc(sizeof(UpnpScpdEntry) + size);
+    if (entry == NULL)
+    {
+        return TINY_RET_E_OUT_OF_MEMORY;
+    }
+
+    memset(entry, 0, sizeof(UpnpScpdEntry));
+    entry->hash = scpd_hash(serviceType, contentHash);
+    entry->contentHash = contentHash;
+    entry->contentSize = size;
+    memcpy(entry->content, content, size);
+
+    do
+    {
+        entry->definition = UpnpService_New();
+        if (entry->definition == NULL)
+        {
+            ret = TINY_RET_E_OUT_OF_MEMORY;
+            break;
+        }
+
+        UpnpService_SetServiceType(entry->definition, serviceType);
+
+        ret = UpnpScpdCache_CopyDefinition(entry->definition, service);
+    } while (0);
+
+    if (RET_FAILED(ret))
+    {
+        if (entry->definition != NULL)
+        {
+            UpnpService_Delete(entry->definition);
+        }
+
+        tiny_free(entry);
+        return ret;
+    }
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    if (UpnpScpdCache_Get(thiz, serviceType, content, contentHash, size) != NULL)
+    {
+        UpnpService_Delete(entry->definition);
+        tiny_free(entry);
+    }
+    else
+    {
+        uint32_t index = entry->hash & (thiz->size - 1);
+
+        while (thiz->stats.entries >= thiz->capacity && thiz->tail != NULL)
+        {
+            UpnpScpdCache_Evict(thiz, thiz->tail);
+            thiz->stats.evictions++;
+        }
+
+        entry->nextInBucket = thiz->buckets[index];
+        thiz->buckets[index] = entry;
+        UpnpScpdCache_PushFront(thiz, entry);
+        thiz->stats.entries++;
+    }
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return ret;
+}
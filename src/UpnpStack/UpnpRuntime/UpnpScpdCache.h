@@ -0,0 +1,55 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpScpdCache.h
+*
+* @remark
+*
+*/
+
+#ifndef __UPNP_SCPD_CACHE_H__
+#define __UPNP_SCPD_CACHE_H__
+
+#include "tiny_base.h"
+#include "upnp_api.h"
+#include "UpnpService.h"
+
+TINY_BEGIN_DECLS
+
+
+#define UPNP_SCPD_CACHE_DEFAULT_CAPACITY    64
+
+typedef struct _UpnpScpdCacheStats
+{
+    uint32_t                    entries;
+    uint32_t                    hits;
+    uint32_t                    misses;
+    uint32_t                    evictions;
+} UpnpScpdCacheStats;
+
+/**
+ * Parsed SCPDs keyed by service type and a hash of the document, shared
+ * by every device of a control point. The least recently used one goes
+ * once capacity is reached.
+ */
+struct _UpnpScpdCache;
+typedef struct _UpnpScpdCache UpnpScpdCache;
+
+UPNP_API UpnpScpdCache * UpnpScpdCache_New(uint32_t capacity);
+UPNP_API void UpnpScpdCache_Delete(UpnpScpdCache *thiz);
+UPNP_API void UpnpScpdCache_GetStats(UpnpScpdCache *thiz, UpnpScpdCacheStats *stats);
+
+/**
+ * Load fills an empty service with the actions and state variables
+ * cached for this document, TINY_RET_E_NOT_FOUND on a miss.
+ */
+TinyRet UpnpScpdCache_Load(UpnpScpdCache *thiz, const char *content, uint32_t size, UpnpService *service);
+TinyRet UpnpScpdCache_Store(UpnpScpdCache *thiz, const char *content, uint32_t size, UpnpService *service);
+
+
+TINY_END_DECLS
+
+#endif /* __UPNP_SCPD_CACHE_H__ */
@@ -47,6 +47,8 @@
 #define SDD_STATE_SENDEVENTS                                    "sendEvents"
 #define SDD_STATE_NAME                                          "name"
 #define SDD_STATE_DATATYPE                                      "dataType"
+#define SDD_STATE_MAXIMUMRATE                                   "maximumRate"
+#define SDD_STATE_MINIMUMDELTA                                  "minimumDelta"
 #if 0
 #define SDD_ALLOWEDVALUELIST                                    "allowedValueList"
 #define SDD_ALLOWEDVALUE                                        "allowedValue"
@@ -66,7 +68,7 @@ static TinyRet SDD_LoadServiceStateTable(UpnpService *thiz, TinyXmlNode *root);
 static uint32_t UpnpServiceParser_ActionToXml(UpnpAction *action, char *xml, uint32_t len);
 static uint32_t UpnpServiceParser_StateToXml(UpnpStateVariable *state, char *xml, uint32_t len);
 
-TinyRet UpnpServiceParser_Parse(const char *url, UpnpService *service, uint32_t timeout)
+TinyRet UpnpServiceParser_Parse(const char *url, UpnpService *service, UpnpScpdCache *cache, uint32_t timeout)
 {
     LOG_TIME_BEGIN(TAG, UpnpService_Parse);
     TinyRet ret = TINY_RET_OK;
@@ -105,6 +107,8 @@ TinyRet UpnpServiceParser_Parse(const char *url, UpnpService *service, uint32_t
         do
         {
             TinyXml * xml = NULL;
+            const char *content = NULL;
+            uint32_t size = 0;
 
             ret = HttpMessage_SetRequest(request, "GET", url);
             if (RET_FAILED(ret))
@@ -126,6 +130,20 @@ TinyRet UpnpServiceParser_Parse(const char *url, UpnpService *service, uint32_t
                 break;
             }
 
+            content = HttpMessage_GetContentObject(response);
+            size = HttpMessage_GetContentSize(response);
+
+            if (cache != NULL)
+            {
+                ret = UpnpScpdCache_Load(cache, content, size, service);
+                if (ret != TINY_RET_E_NOT_FOUND)
+                {
+                    break;
+                }
+
+                ret = TINY_RET_OK;
+            }
+
             xml = TinyXml_New();
             if (xml == NULL)
             {
@@ -136,7 +154,7 @@ TinyRet UpnpServiceParser_Parse(const char *url, UpnpService *service, uint32_t
 
             do
             {
-                ret = TinyXml_Parse(xml, HttpMessage_GetContentObject(response), HttpMessage_GetContentSize(response));
+                ret = TinyXml_Parse(xml, content, size);
                 if (RET_FAILED(ret))
                 {
                     LOG_D(TAG, "TinyXml_Parse failed: %s", tiny_ret_to_str(ret));
@@ -149,6 +167,11 @@ TinyRet UpnpServiceParser_Parse(const char *url, UpnpService *service, uint32_t
                     LOG_D(TAG, "SDD_ParseXml failed: %s", tiny_ret_to_str(ret));
                     break;
                 }
+
+                if (cache != NULL && RET_FAILED(UpnpScpdCache_Store(cache, content, size, service)))
+                {
+                    LOG_D(TAG, "UpnpScpdCache_Store failed");
+                }
             } while (0);
 
             TinyXml_Delete(xml);
@@ -291,6 +314,8 @@ static TinyRet SDD_LoadServiceStateTable(UpnpService *thiz, TinyXmlNode *root)
             TinyXmlAttr *attr_sendEvents = NULL;
             const char *name = NULL;
             const char *dataType = NULL;
+            const char *maximumRate = NULL;
+            const char *minimumDelta = NULL;
 
             node_state = TinyXmlNode_GetChildAt(actionList, i);
             if (!str_equal(TinyXmlNode_GetName(node_state), SDD_STATE, true))
@@ -324,8 +349,36 @@ static TinyRet SDD_LoadServiceStateTable(UpnpService *thiz, TinyXmlNode *root)
                 break;
             }
 
-            UpnpStateVariable_Initialize(stateVariable, name, dataType, NULL, attr_sendEvents->value);
-            UpnpService_AddStateVariable(thiz, stateVariable);
+            ret = UpnpStateVariable_Initialize(stateVariable, name, dataType, NULL, attr_sendEvents->value);
+            if (RET_FAILED(ret))
+            {
+                LOG_E(TAG, "UpnpStateVariable_Initialize failed: %s", tiny_ret_to_str(ret));
+                UpnpStateVariable_Delete(stateVariable);
+                break;
+            }
+
+            /**
+             * maximumRate is in seconds, fractions allowed
+             */
+            maximumRate = TinyXmlNode_GetChildContent(node_state, SDD_STATE_MAXIMUMRATE);
+            if (maximumRate != NULL && atof(maximumRate) > 0)
+            {
+                stateVariable->definition.maximumRate = (uint32_t)(atof(maximumRate) * 1000);
+            }
+
+            minimumDelta = TinyXmlNode_GetChildContent(node_state, SDD_STATE_MINIMUMDELTA);
+            if (minimumDelta != NULL && atof(minimumDelta) > 0)
+            {
+                stateVariable->definition.minimumDelta = atof(minimumDelta);
+            }
+
+            ret = UpnpService_AddStateVariable(thiz, stateVariable);
+            if (RET_FAILED(ret))
+            {
+                LOG_E(TAG, "UpnpService_AddStateVariable failed: %s", tiny_ret_to_str(ret));
+                UpnpStateVariable_Delete(stateVariable);
+                break;
+            }
         }
     } while (0);
 
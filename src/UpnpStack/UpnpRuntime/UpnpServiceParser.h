@@ -17,11 +17,15 @@
 
 #include "tiny_base.h"
 #include "UpnpService.h"
+#include "UpnpScpdCache.h"
 
 TINY_BEGIN_DECLS
 
 
-TinyRet UpnpServiceParser_Parse(const char *url, UpnpService *service, uint32_t timeout);
+/**
+ * cache may be NULL; a document already in it is not parsed again
+ */
+TinyRet UpnpServiceParser_Parse(const char *url, UpnpService *service, UpnpScpdCache *cache, uint32_t timeout);
 uint32_t UpnpServiceParser_ToXml(UpnpService *service, char *xml, uint32_t len);
 
 
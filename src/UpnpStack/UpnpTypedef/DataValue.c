@@ -12,9 +12,91 @@
 
 #include "DataValue.h"
 #include "DataType.h"
+#include "tiny_log.h"
 
 #define TAG     "DataValue"
 
+/**
+ * below this, every integer part is exact in a double
+ */
+#define FORMAT_DOUBLE_MAX       1000000000000000.0
+#define FORMAT_DOUBLE_SCALE     1000000
+#define FORMAT_DOUBLE_DIGITS    6
+#define FORMAT_DOUBLE_SPLIT     134217729.0
+
+static bool is_space(char c)
+{
+    return (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+}
+
+static char to_lower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+static uint32_t format_unsigned(uint64_t value, char *bytes)
+{
+    char digits[20];
+    uint32_t count = 0;
+    uint32_t i = 0;
+
+    do
+    {
+        digits[count++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value > 0);
+
+    for (i = 0; i < count; ++i)
+    {
+        bytes[i] = digits[count - 1 - i];
+    }
+
+    return count;
+}
+
+/**
+ * Dekker's product: a * b is exactly *product + *error, as long as
+ * nothing overflows and doubles round to nearest
+ */
+static void two_product(double a, double b, double *product, double *error)
+{
+    double c = FORMAT_DOUBLE_SPLIT * a;
+    double ah = c - (c - a);
+    double al = a - ah;
+    double bh = 0;
+    double bl = 0;
+
+    c = FORMAT_DOUBLE_SPLIT * b;
+    bh = c - (c - b);
+    bl = b - bh;
+
+    *product = a * b;
+    *error = ((ah * bh - *product) + ah * bl + al * bh) + al * bl;
+}
+
+/**
+ * word must end the token: "no" matches "no " but not "none"
+ */
+static uint32_t match_word(const char *bytes, const char *word)
+{
+    uint32_t i = 0;
+
+    for (i = 0; word[i] != 0; ++i)
+    {
+        if (to_lower(bytes[i]) != word[i])
+        {
+            return 0;
+        }
+    }
+
+    if (bytes[i] != 0 && !is_space(bytes[i]))
+    {
+        return 0;
+    }
+
+    return i;
+}
+
 
 void DataValue_Construct(DataValue *thiz)
 {
@@ -60,58 +142,252 @@ void DataValue_Copy(DataValue *dst, DataValue *src)
         {
             if (src->internalValue.stringValue != NULL)
             {
-                src->internalValue.stringValue = tiny_strdup(src->internalValue.stringValue);
+                dst->internalValue.stringValue = tiny_strdup(src->internalValue.stringValue);
             }
         }
     }
 }
 
-TinyRet DataValue_GetValue(DataValue *thiz, char *value, uint32_t len)
+uint32_t DataValue_FormatInteger(int64_t value, char *bytes)
 {
-    TinyRet ret = TINY_RET_OK;
+    uint32_t length = 0;
 
-    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
-    RETURN_VAL_IF_FAIL(value, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(bytes, 0);
 
-    switch (thiz->internalType)
+    if (value < 0)
     {
-    case INTERNAL_UNDEFINED:
-        break;
+        bytes[length++] = '-';
+    }
+
+    length += format_unsigned((value < 0) ? (uint64_t)0 - (uint64_t)value : (uint64_t)value, bytes + length);
+    bytes[length] = 0;
+
+    return length;
+}
+
+/**
+ * The text of "%f": six decimals, rounded from the exact binary value with
+ * ties to even, as printf does. Values beyond FORMAT_DOUBLE_MAX,
+ * infinities and NaN go through tiny_snprintf.
+ */
+uint32_t DataValue_FormatDouble(double value, char *bytes)
+{
+    uint64_t integer = 0;
+    uint64_t fraction = 0;
+    uint32_t length = 0;
+    uint32_t i = 0;
+    double magnitude = (value < 0) ? -value : value;
+    double scaled = 0;
+    double error = 0;
+    double half = 0;
+
+    RETURN_VAL_IF_FAIL(bytes, 0);
+
+    if (!(magnitude < FORMAT_DOUBLE_MAX))
+    {
+        tiny_snprintf(bytes, DATA_VALUE_FORMAT_LEN, "%f", value);
+        bytes[DATA_VALUE_FORMAT_LEN - 1] = 0;
+        return strlen(bytes);
+    }
+
+    if (value < 0)
+    {
+        bytes[length++] = '-';
+    }
+
+    /**
+     * The integer part and what is left of it are both exact, and so is
+     * scaled + error. half compares the remainder past the sixth decimal
+     * with one half: its sign is exact, being that of a difference the
+     * rounding cannot flip.
+     */
+    integer = (uint64_t)magnitude;
+    two_product(magnitude - (double)integer, FORMAT_DOUBLE_SCALE, &scaled, &error);
+    fraction = (uint64_t)scaled;
+    half = ((scaled - (double)fraction) - 0.5) + error;
+    if (half > 0 || (half == 0 && (fraction & 1) != 0))
+    {
+        fraction++;
+    }
+
+    if (fraction >= FORMAT_DOUBLE_SCALE)
+    {
+        fraction -= FORMAT_DOUBLE_SCALE;
+        integer++;
+    }
 
+    length += format_unsigned(integer, bytes + length);
+    bytes[length++] = '.';
+
+    for (i = FORMAT_DOUBLE_DIGITS; i > 0; --i)
+    {
+        bytes[length + i - 1] = (char)('0' + (fraction % 10));
+        fraction /= 10;
+    }
+
+    length += FORMAT_DOUBLE_DIGITS;
+    bytes[length] = 0;
+
+    return length;
+}
+
+uint32_t DataValue_Format(DataValue *thiz, char *bytes)
+{
+    uint32_t length = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, 0);
+    RETURN_VAL_IF_FAIL(bytes, 0);
+
+    switch (thiz->internalType)
+    {
     case INTERNAL_BYTE:
-        tiny_snprintf(value, len, "%d", thiz->internalValue.byteValue);
+        length = DataValue_FormatInteger(thiz->internalValue.byteValue, bytes);
         break;
 
     case INTERNAL_WORD:
-        tiny_snprintf(value, len, "%d", thiz->internalValue.wordValue);
+        length = DataValue_FormatInteger(thiz->internalValue.wordValue, bytes);
         break;
 
     case INTERNAL_INTEGER:
-        tiny_snprintf(value, len, "%d", thiz->internalValue.integerValue);
+        length = DataValue_FormatInteger(thiz->internalValue.integerValue, bytes);
         break;
 
     case INTERNAL_LONG:
-#if (defined _WIN32) || (defined __MAC_OSX__)
-        tiny_snprintf(value, len, "%lld", thiz->internalValue.longValue);
-#else
-        tiny_snprintf(value, len, "%ld", thiz->internalValue.longValue);
-#endif
+        length = DataValue_FormatInteger(thiz->internalValue.longValue, bytes);
         break;
 
     case INTERNAL_FLOAT:
-        tiny_snprintf(value, len, "%f", thiz->internalValue.floatValue);
-        break;
+        return DataValue_FormatDouble(thiz->internalValue.floatValue, bytes);
 
     case INTERNAL_DOUBLE:
-        tiny_snprintf(value, len, "%f", thiz->internalValue.doubleValue);
-        break;
+        return DataValue_FormatDouble(thiz->internalValue.doubleValue, bytes);
 
     case INTERNAL_BOOLEAN:
-        tiny_snprintf(value, len, "%s", DataType_BooleanToString(thiz->internalValue.boolValue));
+        bytes[length++] = thiz->internalValue.boolValue ? '1' : '0';
         break;
 
     case INTERNAL_CHAR:
-        tiny_snprintf(value, len, "%c", thiz->internalValue.charValue);
+        bytes[length++] = thiz->internalValue.charValue;
+        break;
+
+    default:
+        break;
+    }
+
+    bytes[length] = 0;
+
+    return length;
+}
+
+uint32_t DataValue_ParseInteger(const char *bytes, int64_t *value)
+{
+    const char *p = bytes;
+    uint64_t magnitude = 0;
+    bool negative = false;
+    const char *digits = NULL;
+
+    RETURN_VAL_IF_FAIL(bytes, 0);
+    RETURN_VAL_IF_FAIL(value, 0);
+
+    while (is_space(*p))
+    {
+        p++;
+    }
+
+    if (*p == '-' || *p == '+')
+    {
+        negative = (*p == '-');
+        p++;
+    }
+
+    digits = p;
+    while (*p >= '0' && *p <= '9')
+    {
+        magnitude = magnitude * 10 + (uint64_t)(*p - '0');
+        p++;
+    }
+
+    if (p == digits)
+    {
+        return 0;
+    }
+
+    *value = negative ? (int64_t)((uint64_t)0 - magnitude) : (int64_t)magnitude;
+
+    return (uint32_t)(p - bytes);
+}
+
+/**
+ * strtod keeps full precision and allocates nothing
+ */
+uint32_t DataValue_ParseDouble(const char *bytes, double *value)
+{
+    char *end = NULL;
+    double v = 0;
+
+    RETURN_VAL_IF_FAIL(bytes, 0);
+    RETURN_VAL_IF_FAIL(value, 0);
+
+    v = strtod(bytes, &end);
+    if (end == bytes)
+    {
+        return 0;
+    }
+
+    *value = v;
+
+    return (uint32_t)(end - bytes);
+}
+
+/**
+ * 1/0, yes/no, true/false, in any case
+ */
+uint32_t DataValue_ParseBool(const char *bytes, bool *value)
+{
+    static const char *trueWords[] = { "1", "yes", "true" };
+    static const char *falseWords[] = { "0", "no", "false" };
+    const char *p = bytes;
+    uint32_t length = 0;
+    uint32_t i = 0;
+
+    RETURN_VAL_IF_FAIL(bytes, 0);
+    RETURN_VAL_IF_FAIL(value, 0);
+
+    while (is_space(*p))
+    {
+        p++;
+    }
+
+    for (i = 0; i < 3; ++i)
+    {
+        length = match_word(p, trueWords[i]);
+        if (length > 0)
+        {
+            *value = true;
+            return (uint32_t)(p - bytes) + length;
+        }
+
+        length = match_word(p, falseWords[i]);
+        if (length > 0)
+        {
+            *value = false;
+            return (uint32_t)(p - bytes) + length;
+        }
+    }
+
+    return 0;
+}
+
+TinyRet DataValue_GetValue(DataValue *thiz, char *value, uint32_t len)
+{
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(value, TINY_RET_E_ARG_NULL);
+
+    switch (thiz->internalType)
+    {
+    case INTERNAL_UNDEFINED:
         break;
 
     case INTERNAL_STRING:
@@ -124,14 +400,41 @@ TinyRet DataValue_GetValue(DataValue *thiz, char *value, uint32_t len)
             ret = TINY_RET_E_ARG_INVALID;
         }
         break;
+
+    default:
+        if (len >= DATA_VALUE_FORMAT_LEN)
+        {
+            DataValue_Format(thiz, value);
+        }
+        else
+        {
+            char buffer[DATA_VALUE_FORMAT_LEN];
+            uint32_t length = DataValue_Format(thiz, buffer);
+
+            if (length < len)
+            {
+                memcpy(value, buffer, length + 1);
+            }
+            else
+            {
+                ret = TINY_RET_E_ARG_INVALID;
+            }
+        }
+        break;
     }
 
     return ret;
 }
 
+/**
+ * Unparsable numbers read as 0, as atoi did.
+ */
 TinyRet DataValue_SetValue(DataValue *thiz, const char *value)
 {
     TinyRet ret = TINY_RET_OK;
+    int64_t integer = 0;
+    double real = 0;
+    bool boolean = false;
 
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
 
@@ -142,32 +445,41 @@ TinyRet DataValue_SetValue(DataValue *thiz, const char *value)
         break;
 
     case INTERNAL_BYTE:
-        DataValue_SetByte(thiz, (int8_t)(atoi(value)));
+        DataValue_ParseInteger(value, &integer);
+        DataValue_SetByte(thiz, (int8_t)integer);
         break;
 
     case INTERNAL_WORD:
-        DataValue_SetWord(thiz, (int16_t)atoi(value));
+        DataValue_ParseInteger(value, &integer);
+        DataValue_SetWord(thiz, (int16_t)integer);
         break;
 
     case INTERNAL_INTEGER:
-        DataValue_SetInteger(thiz, atoi(value));
+        DataValue_ParseInteger(value, &integer);
+        DataValue_SetInteger(thiz, (int32_t)integer);
         break;
 
     case INTERNAL_LONG:
-        DataValue_SetLong(thiz, atol(value));
+        DataValue_ParseInteger(value, &integer);
+        DataValue_SetLong(thiz, integer);
         break;
 
     case INTERNAL_FLOAT:
-        // BUG !!!
-        DataValue_SetFloat(thiz, (float)atof(value));
+        DataValue_ParseDouble(value, &real);
+        DataValue_SetFloat(thiz, (float)real);
         break;
 
     case INTERNAL_DOUBLE:
-        DataValue_SetDouble(thiz, atof(value));
+        DataValue_ParseDouble(value, &real);
+        DataValue_SetDouble(thiz, real);
         break;
 
     case INTERNAL_BOOLEAN:
-        DataValue_SetBool(thiz, DataType_StringToBoolean(value));
+        if (DataValue_ParseBool(value, &boolean) == 0)
+        {
+            LOG_W(TAG, "invalid boolean value: %s", value);
+        }
+        DataValue_SetBool(thiz, boolean);
         break;
 
     case INTERNAL_CHAR:
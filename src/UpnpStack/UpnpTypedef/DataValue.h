@@ -33,6 +33,25 @@ UPNP_API void DataValue_Copy(DataValue *dst, DataValue *src);
 UPNP_API TinyRet DataValue_GetValue(DataValue *thiz, char *value, uint32_t len);
 UPNP_API TinyRet DataValue_SetValue(DataValue *thiz, const char *value);
 
+/**
+ * Formatters write the text and its terminator into bytes, which must
+ * hold DATA_VALUE_FORMAT_LEN, and return the length without terminator.
+ * DataValue_Format leaves strings to the caller and writes "" for them.
+ */
+#define DATA_VALUE_FORMAT_LEN   32
+
+UPNP_API uint32_t DataValue_Format(DataValue *thiz, char *bytes);
+UPNP_API uint32_t DataValue_FormatInteger(int64_t value, char *bytes);
+UPNP_API uint32_t DataValue_FormatDouble(double value, char *bytes);
+
+/**
+ * Parsers return how many bytes they consumed, leading blanks included,
+ * and 0 if bytes does not start with a value.
+ */
+UPNP_API uint32_t DataValue_ParseInteger(const char *bytes, int64_t *value);
+UPNP_API uint32_t DataValue_ParseDouble(const char *bytes, double *value);
+UPNP_API uint32_t DataValue_ParseBool(const char *bytes, bool *value);
+
 UPNP_API void DataValue_SetByte(DataValue *thiz, int8_t value);
 UPNP_API void DataValue_SetWord(DataValue *thiz, int16_t value);
 UPNP_API void DataValue_SetInteger(DataValue *thiz, int32_t value);
@@ -19,23 +19,16 @@
 TINY_BEGIN_DECLS
 
 
-#define PROPERTY_NAME_LEN       128
-#define PROPERTY_VALUE_LEN      256
-
-
+/**
+ * name and value live in the arena of the PropertyList holding them and
+ * stay valid until the list is deleted.
+ */
 typedef struct _Property
 {
-    char name[PROPERTY_NAME_LEN];
-    char value[PROPERTY_VALUE_LEN];
+    const char * name;
+    const char * value;
 } Property;
 
-UPNP_API Property * Property_New();
-UPNP_API void Property_Delete(Property *thiz);
-UPNP_API TinyRet Property_Construct(Property *thiz);
-UPNP_API void Property_Dispose(Property *thiz);
-
-UPNP_API void Property_Copy(Property *dst, Property *src);
-
 
 TINY_END_DECLS
 
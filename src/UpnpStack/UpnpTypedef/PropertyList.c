@@ -11,20 +11,49 @@
  */
 
 #include "PropertyList.h"
-#include "TinyList.h"
 #include "tiny_memory.h"
 #include "tiny_log.h"
+#include "tiny_str_hash.h"
 
-#define TAG             "PropertyList"
+#define TAG                     "PropertyList"
+
+#define PROPERTY_LIST_INIT_SIZE 8
+#define PROPERTY_INDEX_MIN      8
+#define PROPERTY_CHUNK_SIZE     1024
 
 
 static TinyRet PropertyList_Construct(PropertyList *thiz);
 static void PropertyList_Dispose(PropertyList *thiz);
-static void PropertyDeleteListener(void * data, void *ctx);
 
+typedef struct _PropertyEntry
+{
+    Property                    property;
+    uint32_t                    hash;
+} PropertyEntry;
+
+/**
+ * names and values are copied back to back into chunks, freed together
+ */
+typedef struct _PropertyChunk
+{
+    struct _PropertyChunk     * next;
+    uint32_t                    size;
+    uint32_t                    used;
+} PropertyChunk;
+
+/**
+ * Properties sit in one array in insertion order. Short lists are
+ * searched by hash; longer ones also keep an open-addressing index of
+ * positions + 1, at most half full.
+ */
 struct _PropertyList
 {
-    TinyList      properties;
+    PropertyEntry             * entries;
+    uint32_t                    count;
+    uint32_t                    size;
+    uint32_t                  * index;
+    uint32_t                    indexSize;
+    PropertyChunk             * chunks;
 };
 
 PropertyList * PropertyList_New(void)
@@ -55,31 +84,47 @@ PropertyList * PropertyList_New(void)
 
 static TinyRet PropertyList_Construct(PropertyList *thiz)
 {
-    TinyRet ret = TINY_RET_OK;
-
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
 
-    do
-    {
-        memset(thiz, 0, sizeof(PropertyList));
+    memset(thiz, 0, sizeof(PropertyList));
 
-        ret = TinyList_Construct(&thiz->properties);
-        if (RET_FAILED(ret))
-        {
-            break;
-        }
+    return TINY_RET_OK;
+}
 
-        TinyList_SetDeleteListener(&thiz->properties, PropertyDeleteListener, thiz);
-    } while (0);
+static void PropertyList_Clear(PropertyList *thiz)
+{
+    while (thiz->chunks != NULL)
+    {
+        PropertyChunk *chunk = thiz->chunks;
+        thiz->chunks = chunk->next;
+        tiny_free(chunk);
+    }
 
-    return ret;
+    if (thiz->index != NULL)
+    {
+        memset(thiz->index, 0, sizeof(uint32_t) * thiz->indexSize);
+    }
+
+    thiz->count = 0;
 }
 
 static void PropertyList_Dispose(PropertyList *thiz)
 {
     RETURN_IF_FAIL(thiz);
 
-    TinyList_Dispose(&thiz->properties);
+    PropertyList_Clear(thiz);
+
+    if (thiz->entries != NULL)
+    {
+        tiny_free(thiz->entries);
+    }
+
+    if (thiz->index != NULL)
+    {
+        tiny_free(thiz->index);
+    }
+
+    memset(thiz, 0, sizeof(PropertyList));
 }
 
 void PropertyList_Delete(PropertyList * thiz)
@@ -98,142 +143,231 @@ void PropertyList_Copy(PropertyList * dst, PropertyList * src)
     if (dst != src)
     {
         uint32_t i = 0;
-        uint32_t count = PropertyList_GetSize(src);
 
-        PropertyList_Dispose(dst);
+        PropertyList_Clear(dst);
 
-        for (i = 0; i < count; i++)
+        for (i = 0; i < src->count; i++)
         {
-            TinyRet ret = TINY_RET_OK;
-            Property *pSrc = PropertyList_GetPropertyAt(src, i);
+            Property *p = &src->entries[i].property;
 
-            Property *pDst = Property_New();
-            if (pDst == NULL)
+            if (RET_FAILED(PropertyList_Add(dst, p->name, p->value)))
             {
-                LOG_E(TAG, "Property_New failed");
+                LOG_E(TAG, "PropertyList_Add failed");
                 break;
             }
-            Property_Copy(pDst, pSrc);
+        }
+    }
+}
 
-            ret = TinyList_AddTail(&dst->properties, pDst);
-            if (RET_FAILED(ret))
-            {
-                Property_Delete(pDst);
-                LOG_E(TAG, "TinyList_AddTail failed");
-                break;
-            }
+static char * PropertyList_Store(PropertyList *thiz, const char *name, uint32_t nameLength, const char *value, uint32_t valueLength)
+{
+    PropertyChunk *chunk = thiz->chunks;
+    uint32_t length = nameLength + valueLength + 2;
+    char *data = NULL;
+
+    if (chunk == NULL || chunk->size - chunk->used < length)
+    {
+        uint32_t size = (length > PROPERTY_CHUNK_SIZE) ? length : PROPERTY_CHUNK_SIZE;
+
+        chunk = (PropertyChunk *)tiny_malloc(sizeof(PropertyChunk) + size);
+        if (chunk == NULL)
+        {
+            return NULL;
         }
+
+        chunk->size = size;
+        chunk->used = 0;
+        chunk->next = thiz->chunks;
+        thiz->chunks = chunk;
     }
+
+    data = (char *)(chunk + 1) + chunk->used;
+    memcpy(data, name, nameLength + 1);
+    memcpy(data + nameLength + 1, value, valueLength + 1);
+    chunk->used += length;
+
+    return data;
 }
 
-static void PropertyDeleteListener(void * data, void *ctx)
+static void PropertyList_Index(uint32_t *index, uint32_t size, uint32_t hash, uint32_t position)
 {
-    Property *p = (Property *)data;
-    tiny_free(p);
+    uint32_t i = hash & (size - 1);
+
+    while (index[i] != 0)
+    {
+        i = (i + 1) & (size - 1);
+    }
+
+    index[i] = position + 1;
 }
 
-TinyRet PropertyList_Add(PropertyList *thiz, const char *name, const char *value)
+static TinyRet PropertyList_RebuildIndex(PropertyList *thiz, uint32_t size)
 {
-    TinyRet ret = TINY_RET_OK;
+    uint32_t *index = NULL;
+    uint32_t i = 0;
 
-    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
-    RETURN_VAL_IF_FAIL(name, TINY_RET_E_ARG_NULL);
-    RETURN_VAL_IF_FAIL(value, TINY_RET_E_ARG_NULL);
+    index = (uint32_t *)tiny_malloc(sizeof(uint32_t) * size);
+    if (index == NULL)
+    {
+        return TINY_RET_E_OUT_OF_MEMORY;
+    }
 
-    do
+    memset(index, 0, sizeof(uint32_t) * size);
+
+    for (i = 0; i < thiz->count; i++)
+    {
+        PropertyList_Index(index, size, thiz->entries[i].hash, i);
+    }
+
+    if (thiz->index != NULL)
     {
-        Property *p = Property_New();
-        if (p == NULL)
+        tiny_free(thiz->index);
+    }
+
+    thiz->index = index;
+    thiz->indexSize = size;
+
+    return TINY_RET_OK;
+}
+
+static PropertyEntry * PropertyList_Find(PropertyList *thiz, const char *name, uint32_t hash)
+{
+    uint32_t i = 0;
+
+    if (thiz->count > PROPERTY_INDEX_MIN && thiz->index != NULL)
+    {
+        for (i = hash & (thiz->indexSize - 1); thiz->index[i] != 0; i = (i + 1) & (thiz->indexSize - 1))
         {
-            ret = TINY_RET_E_NEW;
-            break;
+            PropertyEntry *entry = &thiz->entries[thiz->index[i] - 1];
+            if (entry->hash == hash && STR_EQUAL(entry->property.name, name))
+            {
+                return entry;
+            }
         }
 
-        strncpy(p->name, name, PROPERTY_NAME_LEN);
-        strncpy(p->value, value, PROPERTY_VALUE_LEN);
+        return NULL;
+    }
 
-        ret = PropertyList_AddProperty(thiz, p);
-        if (RET_FAILED(ret))
+    for (i = 0; i < thiz->count; i++)
+    {
+        PropertyEntry *entry = &thiz->entries[i];
+        if (entry->hash == hash && STR_EQUAL(entry->property.name, name))
         {
-            Property_Delete(p);
-            break;
+            return entry;
         }
-    } while (0);
+    }
 
-    return ret;
+    return NULL;
 }
 
-TinyRet PropertyList_AddProperty(PropertyList *thiz, Property *property)
+TinyRet PropertyList_Add(PropertyList *thiz, const char *name, const char *value)
 {
     TinyRet ret = TINY_RET_OK;
 
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
-    RETURN_VAL_IF_FAIL(property, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(name, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(value, TINY_RET_E_ARG_NULL);
 
     do
     {
-        bool found = false;
-        uint32_t i = 0;
-        uint32_t count = 0;
+        PropertyEntry *entry = NULL;
+        uint32_t hash = str_hash(name);
+        uint32_t nameLength = 0;
+        char *data = NULL;
+
+        if (PropertyList_Find(thiz, name, hash) != NULL)
+        {
+            ret = TINY_RET_E_ITEM_EXIST;
+            break;
+        }
 
-        count = TinyList_GetCount(&thiz->properties);
+        if (thiz->count == thiz->size)
+        {
+            uint32_t size = (thiz->size > 0) ? thiz->size * 2 : PROPERTY_LIST_INIT_SIZE;
+            PropertyEntry *entries = (PropertyEntry *)tiny_realloc(thiz->entries, sizeof(PropertyEntry) * size);
+            if (entries == NULL)
+            {
+                ret = TINY_RET_E_OUT_OF_MEMORY;
+                break;
+            }
 
-        for (i = 0; i < count; ++i)
+            thiz->entries = entries;
+            thiz->size = size;
+        }
+
+        /**
+         * past PROPERTY_INDEX_MIN the index must cover every entry
+         */
+        if (thiz->count + 1 > PROPERTY_INDEX_MIN && (thiz->count + 1) * 2 > thiz->indexSize)
         {
-            Property *p = TinyList_GetAt(&thiz->properties, i);
-            if (STR_EQUAL(p->name, property->name))
+            ret = PropertyList_RebuildIndex(thiz, (thiz->indexSize > 0) ? thiz->indexSize * 2 : PROPERTY_INDEX_MIN * 4);
+            if (RET_FAILED(ret))
             {
-                found = true;
                 break;
             }
         }
 
-        if (found)
+        nameLength = strlen(name);
+        data = PropertyList_Store(thiz, name, nameLength, value, strlen(value));
+        if (data == NULL)
         {
-            ret = TINY_RET_E_ITEM_EXIST;
+            ret = TINY_RET_E_OUT_OF_MEMORY;
             break;
         }
 
-        ret = TinyList_AddTail(&thiz->properties, property);
+        entry = &thiz->entries[thiz->count];
+        entry->property.name = data;
+        entry->property.value = data + nameLength + 1;
+        entry->hash = hash;
+
+        if (thiz->index != NULL)
+        {
+            PropertyList_Index(thiz->index, thiz->indexSize, hash, thiz->count);
+        }
+
+        thiz->count++;
     } while (0);
 
     return ret;
 }
 
+TinyRet PropertyList_AddProperty(PropertyList *thiz, Property *property)
+{
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(property, TINY_RET_E_ARG_NULL);
+
+    return PropertyList_Add(thiz, property->name, property->value);
+}
+
 uint32_t PropertyList_GetSize(PropertyList *thiz)
 {
     RETURN_VAL_IF_FAIL(thiz, 0);
 
-    return TinyList_GetSize(&thiz->properties);
+    return thiz->count;
 }
 
 Property * PropertyList_GetPropertyAt(PropertyList *thiz, uint32_t index)
 {
     RETURN_VAL_IF_FAIL(thiz, NULL);
-    
-    return (Property *)TinyList_GetAt(&thiz->properties, index);
+
+    if (index >= thiz->count)
+    {
+        return NULL;
+    }
+
+    return &thiz->entries[index].property;
 }
 
 Property * PropertyList_GetProperty(PropertyList *thiz, const char *name)
 {
-    uint32_t i = 0;
-    uint32_t count = 0;
+    PropertyEntry *entry = NULL;
 
     RETURN_VAL_IF_FAIL(thiz, NULL);
     RETURN_VAL_IF_FAIL(name, NULL);
 
-    count = TinyList_GetCount(&thiz->properties);
+    entry = PropertyList_Find(thiz, name, str_hash(name));
 
-    for (i = 0; i < count; ++i)
-    {
-        Property *p = TinyList_GetAt(&thiz->properties, i);
-        if (STR_EQUAL(p->name, name))
-        {
-            return p;
-        }
-    }
-
-    return NULL;
+    return (entry != NULL) ? &entry->property : NULL;
 }
 
 const char * PropertyList_GetPropertyValue(PropertyList *thiz, const char *name)
@@ -245,4 +379,4 @@ const char * PropertyList_GetPropertyValue(PropertyList *thiz, const char *name)
     }
 
     return NULL;
-}
\ No newline at end of file
+}
@@ -30,6 +30,9 @@ UPNP_API void PropertyList_Copy(PropertyList * dst, PropertyList * src);
 UPNP_API TinyRet PropertyList_Add(PropertyList *thiz, const char *name, const char *value);
 UPNP_API TinyRet PropertyList_AddProperty(PropertyList *thiz, Property *property);
 
+/**
+ * a Property returned here is valid until the next Add to the list
+ */
 UPNP_API uint32_t PropertyList_GetSize(PropertyList *thiz);
 UPNP_API Property * PropertyList_GetPropertyAt(PropertyList *thiz, uint32_t index);
 UPNP_API Property * PropertyList_GetProperty(PropertyList *thiz, const char *name);
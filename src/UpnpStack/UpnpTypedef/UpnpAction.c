@@ -11,6 +11,7 @@
 */
 
 #include "UpnpAction.h"
+#include "UpnpService.h"
 #include "tiny_memory.h"
 #include "TinyList.h"
 
@@ -30,6 +31,7 @@ struct _UpnpAction
     void * service;
     char name[NAME_LEN];
     TinyList argumentList;
+    void * responseTemplate;
 };
 
 UpnpAction * UpnpAction_New(void)
@@ -94,6 +96,12 @@ static void UpnpAction_Dispose(UpnpAction *thiz)
     RETURN_IF_FAIL(thiz);
 
     TinyList_Dispose(&thiz->argumentList);
+
+    if (thiz->responseTemplate != NULL)
+    {
+        tiny_free(thiz->responseTemplate);
+        thiz->responseTemplate = NULL;
+    }
 }
 
 void UpnpAction_SetParentService(UpnpAction *thiz, void *service)
@@ -133,6 +141,15 @@ TinyRet UpnpAction_AddArgument(UpnpAction *thiz, UpnpArgument *argument)
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(argument, TINY_RET_E_ARG_NULL);
 
+    if (thiz->service != NULL)
+    {
+        TinyRet ret = UpnpArgument_Intern(argument, UpnpService_GetNamePool((UpnpService *)thiz->service));
+        if (RET_FAILED(ret))
+        {
+            return ret;
+        }
+    }
+
     return TinyList_AddTail(&thiz->argumentList, argument);
 }
 
@@ -186,4 +203,23 @@ const char * UpnpAction_GetArgumentRelatedStateVariable(UpnpAction *thiz, const
     }
 
     return NULL;
-}
\ No newline at end of file
+}
+
+void UpnpAction_SetResponseTemplate(UpnpAction *thiz, void *data)
+{
+    RETURN_IF_FAIL(thiz);
+
+    if (thiz->responseTemplate != NULL)
+    {
+        tiny_free(thiz->responseTemplate);
+    }
+
+    thiz->responseTemplate = data;
+}
+
+void * UpnpAction_GetResponseTemplate(UpnpAction *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+
+    return thiz->responseTemplate;
+}
@@ -38,6 +38,12 @@ UPNP_API UpnpArgument * UpnpAction_GetArgumentAt(UpnpAction *thiz, uint32_t inde
 UPNP_API UpnpArgument * UpnpAction_GetArgument(UpnpAction *thiz, const char *argumentName);
 UPNP_API const char * UpnpAction_GetArgumentRelatedStateVariable(UpnpAction *thiz, const char *argumentName);
 
+/**
+ * pre-rendered response envelope, owned by the action (freed with tiny_free)
+ */
+void UpnpAction_SetResponseTemplate(UpnpAction *thiz, void *data);
+void * UpnpAction_GetResponseTemplate(UpnpAction *thiz);
+
 
 TINY_END_DECLS
 
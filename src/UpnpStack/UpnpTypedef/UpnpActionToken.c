@@ -0,0 +1,265 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpActionToken.c
+*
+* @remark
+*
+*/
+
+#include "UpnpActionToken.h"
+#include "UpnpError.h"
+#include "TinyMutex.h"
+#include "tiny_memory.h"
+#include "tiny_log.h"
+
+#define TAG             "UpnpActionToken"
+
+struct _UpnpActionToken
+{
+    uint32_t            ref;
+    TinyMutex           mutex;
+    bool                completed;
+    bool                handlerDone;
+    UpnpCode            code;
+    char                description[UPNP_ERR_DESCRIPTION_LEN];
+    PropertyList      * arguments;
+    PropertyList      * results;
+    UpnpActionTokenListener listener;
+    void              * listenerCtx;
+};
+
+static bool UpnpActionToken_SetResult(UpnpActionToken *thiz, UpnpCode code, const char *description);
+static void UpnpActionToken_Finish(UpnpActionToken *thiz, UpnpCode code, const char *description);
+
+UpnpActionToken * UpnpActionToken_New(void)
+{
+    UpnpActionToken *thiz = NULL;
+
+    do
+    {
+        thiz = (UpnpActionToken *)tiny_malloc(sizeof(UpnpActionToken));
+        if (thiz == NULL)
+        {
+            break;
+        }
+
+        memset(thiz, 0, sizeof(UpnpActionToken));
+        thiz->ref = 1;
+        thiz->code = UPNP_SUCCESS;
+
+        if (RET_FAILED(TinyMutex_Construct(&thiz->mutex)))
+        {
+            LOG_E(TAG, "TinyMutex_Construct failed");
+            tiny_free(thiz);
+            thiz = NULL;
+            break;
+        }
+
+        thiz->arguments = PropertyList_New();
+        if (thiz->arguments == NULL)
+        {
+            LOG_E(TAG, "PropertyList_New failed");
+            TinyMutex_Dispose(&thiz->mutex);
+            tiny_free(thiz);
+            thiz = NULL;
+            break;
+        }
+
+        thiz->results = PropertyList_New();
+        if (thiz->results == NULL)
+        {
+            LOG_E(TAG, "PropertyList_New failed");
+            PropertyList_Delete(thiz->arguments);
+            TinyMutex_Dispose(&thiz->mutex);
+            tiny_free(thiz);
+            thiz = NULL;
+            break;
+        }
+    } while (0);
+
+    return thiz;
+}
+
+void UpnpActionToken_Retain(UpnpActionToken *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Lock(&thiz->mutex);
+    thiz->ref++;
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+void UpnpActionToken_Release(UpnpActionToken *thiz)
+{
+    uint32_t ref = 0;
+
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Lock(&thiz->mutex);
+    ref = --thiz->ref;
+    TinyMutex_Unlock(&thiz->mutex);
+
+    if (ref > 0)
+    {
+        return;
+    }
+
+    PropertyList_Delete(thiz->arguments);
+    PropertyList_Delete(thiz->results);
+    TinyMutex_Dispose(&thiz->mutex);
+    tiny_free(thiz);
+}
+
+void UpnpActionToken_SetListener(UpnpActionToken *thiz, UpnpActionTokenListener listener, void *ctx)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Lock(&thiz->mutex);
+    thiz->listener = listener;
+    thiz->listenerCtx = ctx;
+    TinyMutex_Unlock(&thiz->mutex);
+}
+
+bool UpnpActionToken_Cancel(UpnpActionToken *thiz, UpnpCode code, const char *description)
+{
+    RETURN_VAL_IF_FAIL(thiz, false);
+    RETURN_VAL_IF_FAIL(description, false);
+
+    return UpnpActionToken_SetResult(thiz, code, description);
+}
+
+UpnpCode UpnpActionToken_GetCode(UpnpActionToken *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, UPNP_ERR_ACTION_FAILED);
+
+    return thiz->code;
+}
+
+const char * UpnpActionToken_GetDescription(UpnpActionToken *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+
+    return thiz->description;
+}
+
+PropertyList * UpnpActionToken_GetArguments(UpnpActionToken *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+
+    return thiz->arguments;
+}
+
+const char * UpnpActionToken_GetArgument(UpnpActionToken *thiz, const char *name)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+    RETURN_VAL_IF_FAIL(name, NULL);
+
+    return PropertyList_GetPropertyValue(thiz->arguments, name);
+}
+
+PropertyList * UpnpActionToken_GetResults(UpnpActionToken *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+
+    return thiz->results;
+}
+
+TinyRet UpnpActionToken_SetArgument(UpnpActionToken *thiz, const char *name, const char *value)
+{
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(name, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(value, TINY_RET_E_ARG_NULL);
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    if (thiz->completed)
+    {
+        ret = TINY_RET_E_STOPPED;
+    }
+    else
+    {
+        ret = PropertyList_Add(thiz->results, name, value);
+    }
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    return ret;
+}
+
+void UpnpActionToken_Complete(UpnpActionToken *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    UpnpActionToken_Finish(thiz, UPNP_SUCCESS, "OK");
+}
+
+void UpnpActionToken_Fail(UpnpActionToken *thiz, UpnpCode code, const char *description)
+{
+    RETURN_IF_FAIL(thiz);
+
+    UpnpActionToken_Finish(thiz, code, (description != NULL) ? description : "ACTION Execute failed");
+}
+
+/**
+ * the first result wins and goes to the listener, outside the lock
+ */
+static bool UpnpActionToken_SetResult(UpnpActionToken *thiz, UpnpCode code, const char *description)
+{
+    bool first = false;
+    UpnpActionTokenListener listener = NULL;
+    void *ctx = NULL;
+
+    TinyMutex_Lock(&thiz->mutex);
+
+    if (!thiz->completed)
+    {
+        first = true;
+        thiz->completed = true;
+        thiz->code = code;
+        strncpy(thiz->description, description, UPNP_ERR_DESCRIPTION_LEN - 1);
+        listener = thiz->listener;
+        ctx = thiz->listenerCtx;
+    }
+
+    TinyMutex_Unlock(&thiz->mutex);
+
+    if (listener != NULL)
+    {
+        listener(thiz, ctx);
+    }
+
+    return first;
+}
+
+/**
+ * drops the handler's reference. A result that comes after a cancel is
+ * dropped too: the request was answered already.
+ */
+static void UpnpActionToken_Finish(UpnpActionToken *thiz, UpnpCode code, const char *description)
+{
+    bool twice = false;
+
+    TinyMutex_Lock(&thiz->mutex);
+    twice = thiz->handlerDone;
+    thiz->handlerDone = true;
+    TinyMutex_Unlock(&thiz->mutex);
+
+    if (twice)
+    {
+        LOG_E(TAG, "token completed twice");
+        return;
+    }
+
+    if (!UpnpActionToken_SetResult(thiz, code, description))
+    {
+        LOG_D(TAG, "late result dropped: %s", thiz->description);
+    }
+
+    UpnpActionToken_Release(thiz);
+}
@@ -0,0 +1,61 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpActionToken.h
+*
+* @remark
+*
+*/
+
+#ifndef __UPNP_ACTION_TOKEN_H__
+#define __UPNP_ACTION_TOKEN_H__
+
+#include "tiny_base.h"
+#include "upnp_api.h"
+#include "UpnpCode.h"
+#include "PropertyList.h"
+
+TINY_BEGIN_DECLS
+
+
+/**
+ * Completion token of a deferred action. The handler gets it with the
+ * input arguments already decoded into it (GetArgument), may keep it past
+ * its return, and finishes it exactly once, from any thread, with
+ * Complete or Fail. The token must not be touched after that.
+ * The in and out arguments live in the token, not in the service's
+ * state variables, so deferred actions of one service run side by side.
+ * An action not finished within UPNP_ACTION_TIMEOUT is answered with
+ * a 501 fault, and its late result is dropped.
+ */
+struct _UpnpActionToken;
+typedef struct _UpnpActionToken UpnpActionToken;
+
+/**
+ * called once, with the first result: Complete, Fail or Cancel
+ */
+typedef void (*UpnpActionTokenListener)(UpnpActionToken *token, void *ctx);
+
+UpnpActionToken * UpnpActionToken_New(void);
+void UpnpActionToken_Retain(UpnpActionToken *thiz);
+void UpnpActionToken_Release(UpnpActionToken *thiz);
+
+void UpnpActionToken_SetListener(UpnpActionToken *thiz, UpnpActionTokenListener listener, void *ctx);
+bool UpnpActionToken_Cancel(UpnpActionToken *thiz, UpnpCode code, const char *description);
+UpnpCode UpnpActionToken_GetCode(UpnpActionToken *thiz);
+const char * UpnpActionToken_GetDescription(UpnpActionToken *thiz);
+PropertyList * UpnpActionToken_GetArguments(UpnpActionToken *thiz);
+PropertyList * UpnpActionToken_GetResults(UpnpActionToken *thiz);
+
+UPNP_API const char * UpnpActionToken_GetArgument(UpnpActionToken *thiz, const char *name);
+UPNP_API TinyRet UpnpActionToken_SetArgument(UpnpActionToken *thiz, const char *name, const char *value);
+UPNP_API void UpnpActionToken_Complete(UpnpActionToken *thiz);
+UPNP_API void UpnpActionToken_Fail(UpnpActionToken *thiz, UpnpCode code, const char *description);
+
+
+TINY_END_DECLS
+
+#endif /* __UPNP_ACTION_TOKEN_H__ */
@@ -16,16 +16,45 @@
 static TinyRet UpnpArgument_Construct(UpnpArgument *thiz, const char *name, UpnpArgumentDirection direction, const char *relatedStateVariable);
 static void UpnpArgument_Dispose(UpnpArgument *thiz);
 
-#define UpnpArgument_NAME_LEN   128
-#define VARIABLE_NAME_LEN   128
-
+/**
+ * name and relatedStateVariable point into owned until the argument joins
+ * a service, then into the service's name pool.
+ */
 struct _UpnpArgument
 {
-    char name[UpnpArgument_NAME_LEN];
+    const char * name;
     UpnpArgumentDirection direction;
-    char relatedStateVariable[VARIABLE_NAME_LEN];
+    const char * relatedStateVariable;
+    char * owned;
 };
 
+static TinyRet UpnpArgument_SetNames(UpnpArgument *thiz, const char *name, const char *relatedStateVariable)
+{
+    char *owned = NULL;
+    size_t nameLength = strlen(name);
+    size_t variableLength = strlen(relatedStateVariable);
+
+    owned = (char *)tiny_malloc(nameLength + variableLength + 2);
+    if (owned == NULL)
+    {
+        return TINY_RET_E_OUT_OF_MEMORY;
+    }
+
+    memcpy(owned, name, nameLength + 1);
+    memcpy(owned + nameLength + 1, relatedStateVariable, variableLength + 1);
+
+    if (thiz->owned != NULL)
+    {
+        tiny_free(thiz->owned);
+    }
+
+    thiz->owned = owned;
+    thiz->name = owned;
+    thiz->relatedStateVariable = owned + nameLength + 1;
+
+    return TINY_RET_OK;
+}
+
 UpnpArgument * UpnpArgument_New(const char *name, UpnpArgumentDirection direction, const char *relatedStateVariable)
 {
     UpnpArgument *thiz = NULL;
@@ -59,9 +88,14 @@ static TinyRet UpnpArgument_Construct(UpnpArgument *thiz, const char *name, Upnp
     {
         memset(thiz, 0, sizeof(UpnpArgument));
 
+        if (name == NULL || relatedStateVariable == NULL)
+        {
+            ret = TINY_RET_E_ARG_NULL;
+            break;
+        }
+
         thiz->direction = direction;
-        strncpy(thiz->name, name, UpnpArgument_NAME_LEN);
-        strncpy(thiz->relatedStateVariable, relatedStateVariable, VARIABLE_NAME_LEN);
+        ret = UpnpArgument_SetNames(thiz, name, relatedStateVariable);
     } while (0);
 
     return ret;
@@ -70,6 +104,12 @@ static TinyRet UpnpArgument_Construct(UpnpArgument *thiz, const char *name, Upnp
 static void UpnpArgument_Dispose(UpnpArgument *thiz)
 {
     RETURN_IF_FAIL(thiz);
+
+    if (thiz->owned != NULL)
+    {
+        tiny_free(thiz->owned);
+        thiz->owned = NULL;
+    }
 }
 
 void UpnpArgument_Delete(UpnpArgument *thiz)
@@ -80,16 +120,41 @@ void UpnpArgument_Delete(UpnpArgument *thiz)
     tiny_free(thiz);
 }
 
-TinyRet UpnpArgument_SetName(UpnpArgument *thiz, const char *name)
+TinyRet UpnpArgument_Intern(UpnpArgument *thiz, UpnpNamePool *pool)
 {
+    const char *name = NULL;
+    const char *relatedStateVariable = NULL;
+
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
-    RETURN_VAL_IF_FAIL(name, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(pool, TINY_RET_E_ARG_NULL);
 
-    strncpy(thiz->name, name, UpnpArgument_NAME_LEN);
+    name = UpnpNamePool_Intern(pool, thiz->name);
+    relatedStateVariable = UpnpNamePool_Intern(pool, thiz->relatedStateVariable);
+    if (name == NULL || relatedStateVariable == NULL)
+    {
+        return TINY_RET_E_OUT_OF_MEMORY;
+    }
+
+    thiz->name = name;
+    thiz->relatedStateVariable = relatedStateVariable;
+
+    if (thiz->owned != NULL)
+    {
+        tiny_free(thiz->owned);
+        thiz->owned = NULL;
+    }
 
     return TINY_RET_OK;
 }
 
+TinyRet UpnpArgument_SetName(UpnpArgument *thiz, const char *name)
+{
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(name, TINY_RET_E_ARG_NULL);
+
+    return UpnpArgument_SetNames(thiz, name, thiz->relatedStateVariable);
+}
+
 TinyRet UpnpArgument_SetDirection(UpnpArgument *thiz, UpnpArgumentDirection direction)
 {
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
@@ -104,9 +169,7 @@ TinyRet UpnpArgument_SetRelatedStateVariable(UpnpArgument *thiz, const char *rel
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(relatedStateVariable, TINY_RET_E_ARG_NULL);
 
-    strncpy(thiz->relatedStateVariable, relatedStateVariable, VARIABLE_NAME_LEN);
-
-    return TINY_RET_OK;
+    return UpnpArgument_SetNames(thiz, thiz->name, relatedStateVariable);
 }
 
 const char * UpnpArgument_GetName(UpnpArgument *thiz)
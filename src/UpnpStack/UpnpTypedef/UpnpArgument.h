@@ -16,6 +16,7 @@
 #include "tiny_base.h"
 #include "upnp_api.h"
 #include "UpnpArgumentDirection.h"
+#include "UpnpNamePool.h"
 
 TINY_BEGIN_DECLS
 
@@ -34,6 +35,11 @@ UPNP_API const char * UpnpArgument_GetName(UpnpArgument *thiz);
 UPNP_API UpnpArgumentDirection UpnpArgument_GetDirection(UpnpArgument *thiz);
 UPNP_API const char * UpnpArgument_GetRelatedStateVariable(UpnpArgument *thiz);
 
+/**
+ * move both names into the pool of the service the argument joined
+ */
+TinyRet UpnpArgument_Intern(UpnpArgument *thiz, UpnpNamePool *pool);
+
 
 TINY_END_DECLS
 
@@ -15,6 +15,7 @@
 #include "tiny_memory.h"
 #include "tiny_log.h"
 #include "PropertyList.h"
+#include "message/EventBody.h"
 
 #define TAG         "UpnpEvent"
 
@@ -246,6 +247,13 @@ const char * UpnpEvent_GetArgumentValue(UpnpEvent *thiz, const char *argumentNam
     return PropertyList_GetPropertyValue(thiz->argumentList, argumentName);
 }
 
+PropertyList * UpnpEvent_GetArgumentList(UpnpEvent *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+
+    return thiz->argumentList;
+}
+
 /*
 NOTIFY /upnphost/udhisapi.dll?event=uuid:9ba32c90-9923-4ec6-81d0-335100229b91+urn:upnp-org:serviceId:RenderingControl HTTP/1.1
 Cache-Control: no-cache
@@ -318,55 +326,38 @@ InstanceID&gt;&lt;/Event&gt;
 */
 uint32_t UpnpEvent_ToString(UpnpEvent *thiz, char *bytes, uint32_t len)
 {
-    uint32_t unused = len;
-    const char *head = "<?xml version=\"1.0\"?>"
-        "<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">"
-        "<e:property>";
-    const char *tail = "</e:property></e:propertyset>";
-
-    do
-    {
-        uint32_t i = 0;
-        uint32_t count = 0;
-
-        if (unused < strlen(head))
-        {
-            break;
-        }
-
-        strcat(bytes, head);
-        unused -= strlen(head);
-
-        count = PropertyList_GetSize(thiz->argumentList);
-        for (i = 0; i < count; ++i)
-        {
-#define EVENT_MAX_VALUE (1024 * 20)
-            char buf[EVENT_MAX_VALUE];
+    UpnpEventBody *body = NULL;
+    uint32_t length = 0;
 
-            Property *p = (Property *)PropertyList_GetPropertyAt(thiz->argumentList, i);
-
-            memset(buf, 0, EVENT_MAX_VALUE);
-            tiny_snprintf(buf, EVENT_MAX_VALUE, "<%s>%s</%s>", p->name, p->value, p->name);
-
-            if (unused < strlen(buf))
-            {
-                break;
-            }
+    RETURN_VAL_IF_FAIL(thiz, 0);
+    RETURN_VAL_IF_FAIL(bytes, 0);
 
-            strcat(bytes, buf);
-            unused -= strlen(buf);
-        }
+    body = UpnpEventBody_FromList(thiz->argumentList);
+    if (body == NULL)
+    {
+        LOG_E(TAG, "UpnpEventBody_FromList failed");
+        return 0;
+    }
 
-        if (unused < strlen(tail))
-        {
-            break;
-        }
+    /**
+     * a body that does not fit is refused whole instead of being cut
+     * after some property
+     */
+    length = UpnpEventBody_GetLength(body);
+    if (length >= len)
+    {
+        LOG_E(TAG, "UpnpEvent_ToString: %d bytes needed, %d available", length + 1, len);
+        length = 0;
+    }
+    else
+    {
+        memcpy(bytes, UpnpEventBody_GetData(body), length);
+        bytes[length] = 0;
+    }
 
-        strcat(bytes, tail);
-        unused -= strlen(tail);
-    } while (0);
+    UpnpEventBody_Release(body);
 
-    return strlen(bytes);
+    return length;
 }
 
 static TinyRet load_content(UpnpEvent *thiz, const char *bytes, uint32_t len)
@@ -15,6 +15,7 @@
 
 #include "tiny_base.h"
 #include "upnp_api.h"
+#include "PropertyList.h"
 
 TINY_BEGIN_DECLS
 
@@ -45,6 +46,7 @@ UPNP_API const char * UpnpEvent_GetSeq(UpnpEvent *thiz);
 UPNP_API TinyRet UpnpEvent_SetArgumentValue(UpnpEvent *thiz, const char *argumentName, const char *value);
 UPNP_API uint32_t UpnpEvent_GetArgumentCount(UpnpEvent *thiz);
 UPNP_API const char * UpnpEvent_GetArgumentValue(UpnpEvent *thiz, const char *argumentName);
+PropertyList * UpnpEvent_GetArgumentList(UpnpEvent *thiz);
 
 
 UPNP_API TinyRet UpnpEvent_Parse(UpnpEvent *thiz,
@@ -55,6 +57,10 @@ UPNP_API TinyRet UpnpEvent_Parse(UpnpEvent *thiz,
     const char *content,
     uint32_t contentLength);
 
+/**
+ * Writes the e:propertyset, serialized as for a NOTIFY, into bytes and
+ * returns its length, or 0 if it does not fit in len with its terminator.
+ */
 UPNP_API uint32_t UpnpEvent_ToString(UpnpEvent *thiz, char *bytes, uint32_t len);
 
 
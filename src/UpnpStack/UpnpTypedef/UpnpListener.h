@@ -20,6 +20,7 @@
 #include "UpnpUri.h"
 #include "UpnpEvent.h"
 #include "UpnpCode.h"
+#include "UpnpActionToken.h"
 
 TINY_BEGIN_DECLS
 
@@ -28,6 +29,7 @@ typedef void(*UpnpDeviceListener)(UpnpDeviceSummary *deviceSummary, bool alive,
 typedef bool(*UpnpDeviceFilter)(UpnpUri *uri, void *ctx);
 typedef void(*UpnpEventListener)(UpnpEvent *event, void *ctx);
 typedef UpnpCode (*UpnpActionHandler)(UpnpAction *action, void *ctx);
+typedef void (*UpnpAsyncActionHandler)(UpnpAction *action, UpnpActionToken *token, void *ctx);
 
 
 TINY_END_DECLS
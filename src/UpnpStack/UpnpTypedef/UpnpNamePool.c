@@ -0,0 +1,164 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpNamePool.c
+*
+* @remark
+*
+*/
+
+#include "UpnpNamePool.h"
+#include "tiny_memory.h"
+#include "tiny_log.h"
+#include "tiny_str_hash.h"
+
+#define TAG                     "UpnpNamePool"
+
+#define NAME_POOL_INIT_SIZE     32
+
+static TinyRet UpnpNamePool_Resize(UpnpNamePool *thiz, uint32_t size)
+{
+    UpnpName **buckets = NULL;
+    uint32_t i = 0;
+
+    buckets = (UpnpName **)tiny_malloc(sizeof(UpnpName *) * size);
+    if (buckets == NULL)
+    {
+        return TINY_RET_E_OUT_OF_MEMORY;
+    }
+
+    memset(buckets, 0, sizeof(UpnpName *) * size);
+
+    for (i = 0; i < thiz->size; i++)
+    {
+        UpnpName *name = thiz->buckets[i];
+        while (name != NULL)
+        {
+            UpnpName *next = name->next;
+            uint32_t index = name->hash & (size - 1);
+
+            name->next = buckets[index];
+            buckets[index] = name;
+            name = next;
+        }
+    }
+
+    if (thiz->buckets != NULL)
+    {
+        tiny_free(thiz->buckets);
+    }
+
+    thiz->buckets = buckets;
+    thiz->size = size;
+
+    return TINY_RET_OK;
+}
+
+static UpnpName * UpnpNamePool_Get(UpnpNamePool *thiz, const char *name, uint32_t hash)
+{
+    UpnpName *n = NULL;
+
+    for (n = thiz->buckets[hash & (thiz->size - 1)]; n != NULL; n = n->next)
+    {
+        if (n->hash == hash && STR_EQUAL(n->name, name))
+        {
+            break;
+        }
+    }
+
+    return n;
+}
+
+TinyRet UpnpNamePool_Construct(UpnpNamePool *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+
+    memset(thiz, 0, sizeof(UpnpNamePool));
+
+    return UpnpNamePool_Resize(thiz, NAME_POOL_INIT_SIZE);
+}
+
+void UpnpNamePool_Dispose(UpnpNamePool *thiz)
+{
+    uint32_t i = 0;
+
+    RETURN_IF_FAIL(thiz);
+
+    for (i = 0; i < thiz->size; i++)
+    {
+        UpnpName *name = thiz->buckets[i];
+        while (name != NULL)
+        {
+            UpnpName *next = name->next;
+            tiny_free(name);
+            name = next;
+        }
+    }
+
+    if (thiz->buckets != NULL)
+    {
+        tiny_free(thiz->buckets);
+    }
+
+    memset(thiz, 0, sizeof(UpnpNamePool));
+}
+
+const char * UpnpNamePool_Intern(UpnpNamePool *thiz, const char *name)
+{
+    UpnpName *n = NULL;
+    uint32_t hash = 0;
+    uint32_t length = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+    RETURN_VAL_IF_FAIL(name, NULL);
+
+    hash = str_hash(name);
+
+    n = UpnpNamePool_Get(thiz, name, hash);
+    if (n != NULL)
+    {
+        return n->name;
+    }
+
+    if (thiz->count >= thiz->size)
+    {
+        if (RET_FAILED(UpnpNamePool_Resize(thiz, thiz->size * 2)))
+        {
+            LOG_E(TAG, "UpnpNamePool_Resize failed");
+            return NULL;
+        }
+    }
+
+    length = strlen(name);
+    n = (UpnpName *)tiny_malloc(sizeof(UpnpName) + length);
+    if (n == NULL)
+    {
+        LOG_E(TAG, "tiny_malloc failed");
+        return NULL;
+    }
+
+    n->hash = hash;
+    n->variable = 0;
+    memcpy(n->name, name, length + 1);
+    n->next = thiz->buckets[hash & (thiz->size - 1)];
+    thiz->buckets[hash & (thiz->size - 1)] = n;
+    thiz->count++;
+
+    return n->name;
+}
+
+UpnpName * UpnpNamePool_Find(UpnpNamePool *thiz, const char *name)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+    RETURN_VAL_IF_FAIL(name, NULL);
+
+    if (thiz->size == 0)
+    {
+        return NULL;
+    }
+
+    return UpnpNamePool_Get(thiz, name, str_hash(name));
+}
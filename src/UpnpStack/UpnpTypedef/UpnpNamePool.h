@@ -0,0 +1,58 @@
+/*
+* Copyright (C) 2013-2015
+*
+* @author jxfengzi@gmail.com
+* @date   2013-11-19
+*
+* @file   UpnpNamePool.h
+*
+* @remark
+*
+*/
+
+#ifndef __UPNP_NAME_POOL_H__
+#define __UPNP_NAME_POOL_H__
+
+#include "tiny_base.h"
+
+TINY_BEGIN_DECLS
+
+
+/**
+ * variable is the index + 1 of the service's state variable of that
+ * name, 0 if there is none
+ */
+typedef struct _UpnpName
+{
+    struct _UpnpName          * next;
+    uint32_t                    hash;
+    uint32_t                    variable;
+    char                        name[1];
+} UpnpName;
+
+/**
+ * One copy of each distinct argument and state variable name of a
+ * service, so equal names share a pointer. Names live as long as the
+ * pool; it is filled while the service is built and only read after.
+ */
+typedef struct _UpnpNamePool
+{
+    UpnpName                 ** buckets;
+    uint32_t                    size;
+    uint32_t                    count;
+} UpnpNamePool;
+
+TinyRet UpnpNamePool_Construct(UpnpNamePool *thiz);
+void UpnpNamePool_Dispose(UpnpNamePool *thiz);
+
+const char * UpnpNamePool_Intern(UpnpNamePool *thiz, const char *name);
+
+/**
+ * the entry of name, NULL if it was never interned
+ */
+UpnpName * UpnpNamePool_Find(UpnpNamePool *thiz, const char *name);
+
+
+TINY_END_DECLS
+
+#endif /* __UPNP_NAME_POOL_H__ */
@@ -12,7 +12,9 @@
 
 #include "UpnpService.h"
 #include "TinyList.h"
+#include "TinyMutex.h"
 #include "tiny_memory.h"
+#include "tiny_str_hash.h"
 
 static TinyRet UpnpService_Construct(UpnpService *thiz);
 static void UpnpService_Dispose(UpnpService *thiz);
@@ -29,15 +31,27 @@ static void UpnpStateVariableDeleteListener(void * data, void *ctx)
     UpnpStateVariable_Delete(v);
 }
 
-static void SubscriberDeleteListener(void * data, void *ctx)
-{
-    UpnpSubscriber * s = (UpnpSubscriber *)data;
-    UpnpSubscriber_Delete(s);
-}
-
 #define SERVICE_TYPE_LEN    128
 #define SERVICE_ID_LEN      128
 
+#define SUBSCRIBER_INIT_SIZE    16
+
+#define DIRTY_WORDS(n)          (((n) + 31) / 32)
+#define DIRTY_LOCAL_WORDS       8
+
+/**
+ * One subscriber, chained in both indexes and placed at subscribers[index].
+ */
+typedef struct _UpnpSubscriberEntry
+{
+    struct _UpnpSubscriberEntry   * nextBySid;
+    struct _UpnpSubscriberEntry   * nextByCallback;
+    uint32_t                        sidHash;
+    uint32_t                        callbackHash;
+    uint32_t                        index;
+    UpnpSubscriber                * subscriber;
+} UpnpSubscriberEntry;
+
 struct _UpnpService
 {
     char serviceType[SERVICE_TYPE_LEN];
@@ -48,12 +62,25 @@ struct _UpnpService
     char callbackURI[TINY_URI_LEN];
 
     void * device;
+    TinyMutex mutex;
+    UpnpNamePool names;
     TinyList actionList;
+    UpnpAction ** actionIndex;
+    uint32_t actionIndexSize;
     TinyList stateVariableTable;
+    UpnpStateVariable ** variables;
+    uint32_t variableSize;
+    TinyMutex dirtyMutex;
+    uint32_t * dirty;
     UpnpServiceChangedListener changedListener;
     void * changedCtx;
 
-    TinyList subscriberList;
+    UpnpSubscriberEntry ** subscribers;
+    uint32_t subscriberCount;
+    uint32_t subscriberSize;
+    UpnpSubscriberEntry ** bySid;
+    UpnpSubscriberEntry ** byCallback;
+    uint32_t bucketSize;
 };
 
 UpnpService * UpnpService_New(void)
@@ -103,32 +130,41 @@ static TinyRet UpnpService_Construct(UpnpService *thiz)
         thiz->changedListener = NULL;
         thiz->changedCtx = NULL;
 
-        ret = TinyList_Construct(&thiz->actionList);
+        ret = TinyMutex_Construct(&thiz->mutex);
         if (RET_FAILED(ret))
         {
-            ret = TINY_RET_E_NEW;
             break;
         }
 
-        TinyList_SetDeleteListener(&thiz->actionList, ActionDeleteListener, thiz);
+        ret = TinyMutex_Construct(&thiz->dirtyMutex);
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
 
-        ret = TinyList_Construct(&thiz->stateVariableTable);
+        ret = UpnpNamePool_Construct(&thiz->names);
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+
+        ret = TinyList_Construct(&thiz->actionList);
         if (RET_FAILED(ret))
         {
             ret = TINY_RET_E_NEW;
             break;
         }
 
-        TinyList_SetDeleteListener(&thiz->stateVariableTable, UpnpStateVariableDeleteListener, thiz);
+        TinyList_SetDeleteListener(&thiz->actionList, ActionDeleteListener, thiz);
 
-        ret = TinyList_Construct(&thiz->subscriberList);
+        ret = TinyList_Construct(&thiz->stateVariableTable);
         if (RET_FAILED(ret))
         {
             ret = TINY_RET_E_NEW;
             break;
         }
 
-        TinyList_SetDeleteListener(&thiz->subscriberList, SubscriberDeleteListener, thiz);
+        TinyList_SetDeleteListener(&thiz->stateVariableTable, UpnpStateVariableDeleteListener, thiz);
     } while (0);
 
     return ret;
@@ -138,9 +174,68 @@ static void UpnpService_Dispose(UpnpService *thiz)
 {
     RETURN_IF_FAIL(thiz);
 
-    TinyList_Dispose(&thiz->subscriberList);
+    if (thiz->actionIndex != NULL)
+    {
+        tiny_free(thiz->actionIndex);
+        thiz->actionIndex = NULL;
+    }
+
+    while (thiz->subscriberCount > 0)
+    {
+        UpnpSubscriberEntry *entry = thiz->subscribers[--thiz->subscriberCount];
+        UpnpSubscriber_Delete(entry->subscriber);
+        tiny_free(entry);
+    }
+
+    if (thiz->subscribers != NULL)
+    {
+        tiny_free(thiz->subscribers);
+        thiz->subscribers = NULL;
+    }
+
+    if (thiz->bySid != NULL)
+    {
+        tiny_free(thiz->bySid);
+        thiz->bySid = NULL;
+    }
+
+    if (thiz->byCallback != NULL)
+    {
+        tiny_free(thiz->byCallback);
+        thiz->byCallback = NULL;
+    }
+
+    if (thiz->variables != NULL)
+    {
+        tiny_free(thiz->variables);
+        thiz->variables = NULL;
+    }
+
+    if (thiz->dirty != NULL)
+    {
+        tiny_free(thiz->dirty);
+        thiz->dirty = NULL;
+    }
+
     TinyList_Dispose(&thiz->stateVariableTable);
     TinyList_Dispose(&thiz->actionList);
+    UpnpNamePool_Dispose(&thiz->names);
+    TinyMutex_Dispose(&thiz->dirtyMutex);
+    TinyMutex_Dispose(&thiz->mutex);
+}
+
+void UpnpService_Lock(UpnpService *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Lock(&thiz->mutex);
+}
+
+void UpnpService_Unlock(UpnpService *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    TinyMutex_Unlock(&thiz->mutex);
 }
 
 void UpnpService_SetParentDevice(UpnpService *thiz, void *device)
@@ -166,6 +261,25 @@ void UpnpService_SetChangedListener(UpnpService *thiz, UpnpServiceChangedListene
     thiz->changedCtx = ctx;
 }
 
+/**
+ * dirtyMutex held
+ */
+static bool UpnpService_HasChanged(UpnpService *thiz)
+{
+    uint32_t words = DIRTY_WORDS(TinyList_GetCount(&thiz->stateVariableTable));
+    uint32_t i = 0;
+
+    for (i = 0; i < words; ++i)
+    {
+        if (thiz->dirty[i] != 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 TinyRet UpnpService_SendEvents(UpnpService *thiz)
 {
     TinyRet ret = TINY_RET_OK;
@@ -175,22 +289,15 @@ TinyRet UpnpService_SendEvents(UpnpService *thiz)
     do
     {
         bool isChanged = false;
-        int i = 0;
 
         if (thiz->changedListener == NULL)
         {
             break;
         }
 
-        for (i = 0; i < TinyList_GetCount(&thiz->stateVariableTable); ++i)
-        {
-            UpnpStateVariable *v = (UpnpStateVariable *)TinyList_GetAt(&thiz->stateVariableTable, i);
-            if (v->sendEvents && v->isChanged)
-            {
-                isChanged = true;
-                break;
-            }
-        }
+        TinyMutex_Lock(&thiz->dirtyMutex);
+        isChanged = UpnpService_HasChanged(thiz);
+        TinyMutex_Unlock(&thiz->dirtyMutex);
 
         if (isChanged)
         {
@@ -201,6 +308,78 @@ TinyRet UpnpService_SendEvents(UpnpService *thiz)
     return ret;
 }
 
+void UpnpService_SetChanged(UpnpService *thiz, UpnpStateVariable *stateVariable)
+{
+    RETURN_IF_FAIL(thiz);
+    RETURN_IF_FAIL(stateVariable);
+
+    TinyMutex_Lock(&thiz->dirtyMutex);
+    thiz->dirty[stateVariable->index / 32] |= 1U << (stateVariable->index % 32);
+    TinyMutex_Unlock(&thiz->dirtyMutex);
+}
+
+/**
+ * The bitmap is copied and cleared under dirtyMutex, then visited
+ * outside of it, so the visitor may mark variables again.
+ */
+uint32_t UpnpService_TakeChanged(UpnpService *thiz, UpnpStateVariableVisitor visit, void *ctx)
+{
+    uint32_t local[DIRTY_LOCAL_WORDS];
+    uint32_t *taken = local;
+    uint32_t words = 0;
+    uint32_t visited = 0;
+    uint32_t i = 0;
+
+    RETURN_VAL_IF_FAIL(thiz, 0);
+    RETURN_VAL_IF_FAIL(visit, 0);
+
+    TinyMutex_Lock(&thiz->dirtyMutex);
+
+    words = DIRTY_WORDS(TinyList_GetCount(&thiz->stateVariableTable));
+    if (words > DIRTY_LOCAL_WORDS)
+    {
+        taken = (uint32_t *)tiny_malloc(sizeof(uint32_t) * words);
+    }
+
+    if (taken != NULL)
+    {
+        for (i = 0; i < words; ++i)
+        {
+            taken[i] = thiz->dirty[i];
+            thiz->dirty[i] = 0;
+        }
+    }
+
+    TinyMutex_Unlock(&thiz->dirtyMutex);
+
+    if (taken == NULL)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < words; ++i)
+    {
+        uint32_t bits = taken[i];
+        uint32_t j = 0;
+
+        for (j = 0; j < 32 && (bits >> j) != 0; ++j)
+        {
+            if (bits & (1U << j))
+            {
+                visit(thiz->variables[i * 32 + j], ctx);
+                visited++;
+            }
+        }
+    }
+
+    if (taken != local)
+    {
+        tiny_free(taken);
+    }
+
+    return visited;
+}
+
 TinyRet UpnpService_SetServiceType(UpnpService *thiz, const char *serviceType)
 {
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
@@ -303,14 +482,92 @@ const char * UpnpService_GetCallbackURI(UpnpService *thiz)
     return thiz->callbackURI;
 }
 
+/**
+ * actionIndex: open addressing by name hash, at most half full.
+ * NULL means "not indexed", lookups then scan actionList.
+ */
+static void UpnpService_IndexAction(UpnpAction **index, uint32_t size, UpnpAction *action)
+{
+    uint32_t i = str_hash(UpnpAction_GetName(action)) & (size - 1);
+
+    while (index[i] != NULL)
+    {
+        i = (i + 1) & (size - 1);
+    }
+
+    index[i] = action;
+}
+
+static void UpnpService_RebuildActionIndex(UpnpService *thiz, uint32_t size)
+{
+    uint32_t count = TinyList_GetCount(&thiz->actionList);
+    uint32_t i = 0;
+
+    if (thiz->actionIndex != NULL)
+    {
+        tiny_free(thiz->actionIndex);
+    }
+
+    thiz->actionIndexSize = 0;
+    thiz->actionIndex = (UpnpAction **)tiny_malloc(sizeof(UpnpAction *) * size);
+    if (thiz->actionIndex == NULL)
+    {
+        return;
+    }
+
+    memset(thiz->actionIndex, 0, sizeof(UpnpAction *) * size);
+    thiz->actionIndexSize = size;
+
+    for (i = 0; i < count; ++i)
+    {
+        UpnpService_IndexAction(thiz->actionIndex, size, (UpnpAction *)TinyList_GetAt(&thiz->actionList, i));
+    }
+}
+
+UpnpNamePool * UpnpService_GetNamePool(UpnpService *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+
+    return &thiz->names;
+}
+
 TinyRet UpnpService_AddAction(UpnpService *thiz, UpnpAction *action)
 {
+    TinyRet ret = TINY_RET_OK;
+    uint32_t count = 0;
+    uint32_t i = 0;
+
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(action, TINY_RET_E_ARG_NULL);
 
+    for (i = 0; i < UpnpAction_GetArgumentCount(action); i++)
+    {
+        ret = UpnpArgument_Intern(UpnpAction_GetArgumentAt(action, i), &thiz->names);
+        if (RET_FAILED(ret))
+        {
+            return ret;
+        }
+    }
+
     UpnpAction_SetParentService(action, thiz);
 
-    return TinyList_AddTail(&thiz->actionList, action);
+    ret = TinyList_AddTail(&thiz->actionList, action);
+    if (RET_FAILED(ret))
+    {
+        return ret;
+    }
+
+    count = TinyList_GetCount(&thiz->actionList);
+    if (thiz->actionIndex == NULL || count * 2 > thiz->actionIndexSize)
+    {
+        UpnpService_RebuildActionIndex(thiz, (thiz->actionIndexSize > 0) ? thiz->actionIndexSize * 2 : 16);
+    }
+    else
+    {
+        UpnpService_IndexAction(thiz->actionIndex, thiz->actionIndexSize, action);
+    }
+
+    return ret;
 }
 
 uint32_t UpnpService_GetActionCount(UpnpService *thiz)
@@ -335,6 +592,23 @@ UpnpAction * UpnpService_GetAction(UpnpService *thiz, const char *actionName)
     RETURN_VAL_IF_FAIL(thiz, NULL);
     RETURN_VAL_IF_FAIL(actionName, NULL);
 
+    if (thiz->actionIndex != NULL)
+    {
+        i = str_hash(actionName) & (thiz->actionIndexSize - 1);
+
+        while (thiz->actionIndex[i] != NULL)
+        {
+            if (STR_EQUAL(UpnpAction_GetName(thiz->actionIndex[i]), actionName))
+            {
+                return thiz->actionIndex[i];
+            }
+
+            i = (i + 1) & (thiz->actionIndexSize - 1);
+        }
+
+        return NULL;
+    }
+
     count = TinyList_GetCount(&thiz->actionList);
 
     for (i = 0; i < count; ++i)
@@ -351,12 +625,77 @@ UpnpAction * UpnpService_GetAction(UpnpService *thiz, const char *actionName)
 
 TinyRet UpnpService_AddStateVariable(UpnpService *thiz, UpnpStateVariable *stateVariable)
 {
+    TinyRet ret = TINY_RET_OK;
+    uint32_t count = 0;
+
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(stateVariable, TINY_RET_E_ARG_NULL);
 
-    stateVariable->service = thiz;
+    TinyMutex_Lock(&thiz->dirtyMutex);
+
+    do
+    {
+        ret = UpnpStateVariableDefinition_Intern(&stateVariable->definition, &thiz->names);
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+
+        count = TinyList_GetCount(&thiz->stateVariableTable);
+
+        if (count == thiz->variableSize)
+        {
+            uint32_t size = (thiz->variableSize > 0) ? thiz->variableSize * 2 : 32;
+            UpnpStateVariable **variables = NULL;
+            uint32_t *dirty = NULL;
+
+            variables = (UpnpStateVariable **)tiny_realloc(thiz->variables, sizeof(UpnpStateVariable *) * size);
+            if (variables == NULL)
+            {
+                ret = TINY_RET_E_OUT_OF_MEMORY;
+                break;
+            }
+
+            thiz->variables = variables;
+
+            dirty = (uint32_t *)tiny_realloc(thiz->dirty, sizeof(uint32_t) * DIRTY_WORDS(size));
+            if (dirty == NULL)
+            {
+                ret = TINY_RET_E_OUT_OF_MEMORY;
+                break;
+            }
+
+            memset(dirty + DIRTY_WORDS(thiz->variableSize), 0, sizeof(uint32_t) * (DIRTY_WORDS(size) - DIRTY_WORDS(thiz->variableSize)));
+            thiz->dirty = dirty;
+            thiz->variableSize = size;
+        }
+
+        ret = TinyList_AddTail(&thiz->stateVariableTable, stateVariable);
+        if (RET_FAILED(ret))
+        {
+            break;
+        }
+
+        stateVariable->service = thiz;
+        stateVariable->index = count;
+        thiz->variables[count] = stateVariable;
 
-    return TinyList_AddTail(&thiz->stateVariableTable, stateVariable);
+        /**
+         * the first variable of a name is the one looked up
+         */
+        do
+        {
+            UpnpName *name = UpnpNamePool_Find(&thiz->names, stateVariable->definition.name);
+            if (name != NULL && name->variable == 0)
+            {
+                name->variable = count + 1;
+            }
+        } while (0);
+    } while (0);
+
+    TinyMutex_Unlock(&thiz->dirtyMutex);
+
+    return ret;
 }
 
 uint32_t UpnpService_GetStateVariableCount(UpnpService *thiz)
@@ -370,93 +709,259 @@ UpnpStateVariable * UpnpService_GetStateVariableAt(UpnpService *thiz, uint32_t i
 {
     RETURN_VAL_IF_FAIL(thiz, NULL);
 
-    return (UpnpStateVariable *)TinyList_GetAt(&thiz->stateVariableTable, index);
+    if (index >= TinyList_GetCount(&thiz->stateVariableTable))
+    {
+        return NULL;
+    }
+
+    return thiz->variables[index];
 }
 
 UpnpStateVariable * UpnpService_GetStateVariable(UpnpService *thiz, const char *stateName)
 {
-    uint32_t i = 0;
-    uint32_t count = 0;
+    UpnpName *name = NULL;
 
     RETURN_VAL_IF_FAIL(thiz, NULL);
     RETURN_VAL_IF_FAIL(stateName, NULL);
 
-    count = TinyList_GetCount(&thiz->stateVariableTable);
+    /**
+     * names of attached variables are pooled with their index: one hash
+     */
+    name = UpnpNamePool_Find(&thiz->names, stateName);
+    if (name == NULL || name->variable == 0)
+    {
+        return NULL;
+    }
 
-    for (i = 0; i < count; ++i)
+    return thiz->variables[name->variable - 1];
+}
+
+/**
+ * Subscribers sit in an array for iteration, in no particular order, and
+ * are chained by SID and by callback in two bucket arrays of the same
+ * size, grown once they are full. SID and callback must not change while
+ * a subscriber is added.
+ */
+static TinyRet UpnpService_ResizeSubscribers(UpnpService *thiz, uint32_t size)
+{
+    UpnpSubscriberEntry **subscribers = NULL;
+    UpnpSubscriberEntry **bySid = NULL;
+    UpnpSubscriberEntry **byCallback = NULL;
+    uint32_t i = 0;
+
+    bySid = (UpnpSubscriberEntry **)tiny_malloc(sizeof(UpnpSubscriberEntry *) * size);
+    byCallback = (UpnpSubscriberEntry **)tiny_malloc(sizeof(UpnpSubscriberEntry *) * size);
+    if (bySid != NULL && byCallback != NULL)
     {
-        UpnpStateVariable *state = (UpnpStateVariable *)TinyList_GetAt(&thiz->stateVariableTable, i);
-        if (STR_EQUAL(state->definition.name, stateName))
+        subscribers = (UpnpSubscriberEntry **)tiny_realloc(thiz->subscribers, sizeof(UpnpSubscriberEntry *) * size);
+    }
+
+    if (subscribers == NULL)
+    {
+        if (bySid != NULL)
         {
-            return state;
+            tiny_free(bySid);
         }
+
+        if (byCallback != NULL)
+        {
+            tiny_free(byCallback);
+        }
+
+        return TINY_RET_E_OUT_OF_MEMORY;
     }
 
-    return NULL;
+    thiz->subscribers = subscribers;
+    thiz->subscriberSize = size;
+
+    memset(bySid, 0, sizeof(UpnpSubscriberEntry *) * size);
+    memset(byCallback, 0, sizeof(UpnpSubscriberEntry *) * size);
+
+    for (i = 0; i < thiz->subscriberCount; i++)
+    {
+        UpnpSubscriberEntry *entry = thiz->subscribers[i];
+
+        entry->nextBySid = bySid[entry->sidHash & (size - 1)];
+        bySid[entry->sidHash & (size - 1)] = entry;
+        entry->nextByCallback = byCallback[entry->callbackHash & (size - 1)];
+        byCallback[entry->callbackHash & (size - 1)] = entry;
+    }
+
+    if (thiz->bySid != NULL)
+    {
+        tiny_free(thiz->bySid);
+    }
+
+    if (thiz->byCallback != NULL)
+    {
+        tiny_free(thiz->byCallback);
+    }
+
+    thiz->bySid = bySid;
+    thiz->byCallback = byCallback;
+    thiz->bucketSize = size;
+
+    return TINY_RET_OK;
+}
+
+static UpnpSubscriberEntry * UpnpService_FindSubscriberEntry(UpnpService *thiz, const char *sid)
+{
+    UpnpSubscriberEntry *entry = NULL;
+    uint32_t hash = 0;
+
+    if (thiz->bucketSize == 0)
+    {
+        return NULL;
+    }
+
+    hash = str_hash(sid);
+
+    for (entry = thiz->bySid[hash & (thiz->bucketSize - 1)]; entry != NULL; entry = entry->nextBySid)
+    {
+        if (entry->sidHash == hash && STR_EQUAL(UpnpSubscriber_GetSid(entry->subscriber), sid))
+        {
+            break;
+        }
+    }
+
+    return entry;
 }
 
 TinyRet UpnpService_AddSubscriber(UpnpService *thiz, UpnpSubscriber *subscriber)
 {
+    UpnpSubscriberEntry *entry = NULL;
+    uint32_t mask = 0;
+
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(subscriber, TINY_RET_E_ARG_NULL);
 
-    return TinyList_AddTail(&thiz->subscriberList, subscriber);
+    if (thiz->subscriberCount >= thiz->subscriberSize)
+    {
+        TinyRet ret = UpnpService_ResizeSubscribers(thiz, (thiz->subscriberSize > 0) ? thiz->subscriberSize * 2 : SUBSCRIBER_INIT_SIZE);
+        if (RET_FAILED(ret))
+        {
+            return ret;
+        }
+    }
+
+    entry = (UpnpSubscriberEntry *)tiny_malloc(sizeof(UpnpSubscriberEntry));
+    if (entry == NULL)
+    {
+        return TINY_RET_E_OUT_OF_MEMORY;
+    }
+
+    mask = thiz->bucketSize - 1;
+    entry->subscriber = subscriber;
+    entry->sidHash = str_hash(UpnpSubscriber_GetSid(subscriber));
+    entry->callbackHash = str_hash(UpnpSubscriber_GetCallback(subscriber));
+    entry->nextBySid = thiz->bySid[entry->sidHash & mask];
+    thiz->bySid[entry->sidHash & mask] = entry;
+    entry->nextByCallback = thiz->byCallback[entry->callbackHash & mask];
+    thiz->byCallback[entry->callbackHash & mask] = entry;
+    entry->index = thiz->subscriberCount;
+    thiz->subscribers[thiz->subscriberCount++] = entry;
+
+    return TINY_RET_OK;
 }
 
+/**
+ * The last subscriber takes the place of the removed one.
+ */
 TinyRet UpnpService_RemoveSubscriber(UpnpService *thiz, const char *sid)
 {
-    uint32_t i = 0;
-    uint32_t count = 0;
+    UpnpSubscriberEntry *entry = NULL;
+    UpnpSubscriberEntry **link = NULL;
+    uint32_t mask = 0;
 
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
     RETURN_VAL_IF_FAIL(sid, TINY_RET_E_ARG_NULL);
 
-    count = TinyList_GetCount(&thiz->subscriberList);
+    entry = UpnpService_FindSubscriberEntry(thiz, sid);
+    if (entry == NULL)
+    {
+        return TINY_RET_E_NOT_FOUND;
+    }
 
-    for (i = 0; i < count; ++i)
+    mask = thiz->bucketSize - 1;
+
+    for (link = &thiz->bySid[entry->sidHash & mask]; *link != entry; link = &(*link)->nextBySid)
     {
-        UpnpSubscriber *s = (UpnpSubscriber *)TinyList_GetAt(&thiz->subscriberList, i);
-        if (STR_EQUAL(UpnpSubscriber_GetSid(s), sid))
-        {
-            return TinyList_RemoveAt(&thiz->subscriberList, i);
-        }
     }
 
-    return TINY_RET_E_NOT_FOUND;
+    *link = entry->nextBySid;
+
+    for (link = &thiz->byCallback[entry->callbackHash & mask]; *link != entry; link = &(*link)->nextByCallback)
+    {
+    }
+
+    *link = entry->nextByCallback;
+
+    thiz->subscriberCount--;
+    if (entry->index < thiz->subscriberCount)
+    {
+        thiz->subscribers[entry->index] = thiz->subscribers[thiz->subscriberCount];
+        thiz->subscribers[entry->index]->index = entry->index;
+    }
+
+    UpnpSubscriber_Delete(entry->subscriber);
+    tiny_free(entry);
+
+    return TINY_RET_OK;
 }
 
 uint32_t UpnpService_GetSubscriberCount(UpnpService *thiz)
 {
     RETURN_VAL_IF_FAIL(thiz, 0);
 
-    return TinyList_GetCount(&thiz->subscriberList);
+    return thiz->subscriberCount;
 }
 
 UpnpSubscriber * UpnpService_GetSubscriberAt(UpnpService *thiz, uint32_t index)
 {
     RETURN_VAL_IF_FAIL(thiz, NULL);
 
-    return (UpnpSubscriber *)TinyList_GetAt(&thiz->subscriberList, index);
+    if (index >= thiz->subscriberCount)
+    {
+        return NULL;
+    }
+
+    return thiz->subscribers[index]->subscriber;
 }
 
 UpnpSubscriber * UpnpService_GetSubscriber(UpnpService *thiz, const char *callback)
 {
-    uint32_t i = 0;
-    uint32_t count = 0;
+    UpnpSubscriberEntry *entry = NULL;
+    uint32_t hash = 0;
 
     RETURN_VAL_IF_FAIL(thiz, NULL);
     RETURN_VAL_IF_FAIL(callback, NULL);
 
-    count = TinyList_GetCount(&thiz->subscriberList);
+    if (thiz->bucketSize == 0)
+    {
+        return NULL;
+    }
+
+    hash = str_hash(callback);
 
-    for (i = 0; i < count; ++i)
+    for (entry = thiz->byCallback[hash & (thiz->bucketSize - 1)]; entry != NULL; entry = entry->nextByCallback)
     {
-        UpnpSubscriber *s = (UpnpSubscriber *)TinyList_GetAt(&thiz->subscriberList, i);
-        if (STR_EQUAL(UpnpSubscriber_GetCallback(s), callback))
+        if (entry->callbackHash == hash && STR_EQUAL(UpnpSubscriber_GetCallback(entry->subscriber), callback))
         {
-            return s;
+            return entry->subscriber;
         }
     }
 
     return NULL;
 }
+
+UpnpSubscriber * UpnpService_GetSubscriberBySid(UpnpService *thiz, const char *sid)
+{
+    UpnpSubscriberEntry *entry = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+    RETURN_VAL_IF_FAIL(sid, NULL);
+
+    entry = UpnpService_FindSubscriberEntry(thiz, sid);
+
+    return (entry != NULL) ? entry->subscriber : NULL;
+}
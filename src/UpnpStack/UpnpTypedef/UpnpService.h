@@ -31,10 +31,30 @@ UPNP_API void UpnpService_Delete(UpnpService *thiz);
 UPNP_API void UpnpService_SetParentDevice(UpnpService *thiz, void *device);
 UPNP_API void * UpnpService_GetParentDevice(UpnpService *thiz);
 
+/**
+ * Serializes requests that touch the service's state (actions, subscriptions).
+ */
+UPNP_API void UpnpService_Lock(UpnpService *thiz);
+UPNP_API void UpnpService_Unlock(UpnpService *thiz);
+
 typedef void(*UpnpServiceChangedListener)(UpnpService *service, void *ctx);
 UPNP_API void UpnpService_SetChangedListener(UpnpService *thiz, UpnpServiceChangedListener listener, void *ctx);
+
+/**
+ * The changed values are read right away: call it with the service lock
+ * held, as action handlers are, when actions may write them meanwhile.
+ */
 UPNP_API TinyRet UpnpService_SendEvents(UpnpService *thiz);
 
+/**
+ * Changed variables are kept in a per-service bitmap: SetChanged marks
+ * one after its value was written, and is the only way to get it evented;
+ * TakeChanged hands each marked one to visit and clears them in one step.
+ */
+typedef void(*UpnpStateVariableVisitor)(UpnpStateVariable *stateVariable, void *ctx);
+UPNP_API void UpnpService_SetChanged(UpnpService *thiz, UpnpStateVariable *stateVariable);
+uint32_t UpnpService_TakeChanged(UpnpService *thiz, UpnpStateVariableVisitor visit, void *ctx);
+
 UPNP_API TinyRet UpnpService_SetServiceType(UpnpService *thiz, const char *serviceType);
 UPNP_API TinyRet UpnpService_SetServiceId(UpnpService *thiz, const char *serviceId);
 UPNP_API TinyRet UpnpService_SetControlURL(UpnpService *thiz, const char *controlURL);
@@ -49,6 +69,12 @@ UPNP_API const char * UpnpService_GetEventSubURL(UpnpService *thiz);
 UPNP_API const char * UpnpService_GetSCPDURL(UpnpService *thiz);
 UPNP_API const char * UpnpService_GetCallbackURI(UpnpService *thiz);
 
+/**
+ * argument and state variable names move into this pool as they are
+ * added; fill a service before it is published.
+ */
+UpnpNamePool * UpnpService_GetNamePool(UpnpService *thiz);
+
 UPNP_API TinyRet UpnpService_AddAction(UpnpService *thiz, UpnpAction *action);
 UPNP_API uint32_t UpnpService_GetActionCount(UpnpService *thiz);
 UPNP_API UpnpAction * UpnpService_GetActionAt(UpnpService *thiz, uint32_t index);
@@ -64,6 +90,7 @@ UPNP_API TinyRet UpnpService_RemoveSubscriber(UpnpService *thiz, const char *sid
 UPNP_API uint32_t UpnpService_GetSubscriberCount(UpnpService *thiz);
 UPNP_API UpnpSubscriber * UpnpService_GetSubscriberAt(UpnpService *thiz, uint32_t index);
 UPNP_API UpnpSubscriber * UpnpService_GetSubscriber(UpnpService *thiz, const char *callback);
+UPNP_API UpnpSubscriber * UpnpService_GetSubscriberBySid(UpnpService *thiz, const char *sid);
 
 
 
@@ -42,6 +42,9 @@ TinyRet UpnpStateVariable_Construct(UpnpStateVariable *thiz)
 
     UpnpStateVariableDefinition_Construct(&thiz->definition);
     DataValue_Construct(&thiz->value);
+    thiz->index = 0;
+    thiz->eventedAt = 0;
+    thiz->eventedValue = 0;
 
     return TINY_RET_OK;
 }
@@ -62,18 +65,25 @@ void UpnpStateVariable_Delete(UpnpStateVariable *thiz)
     tiny_free(thiz);
 }
 
-void UpnpStateVariable_Copy(UpnpStateVariable *dst, UpnpStateVariable *src)
+TinyRet UpnpStateVariable_Copy(UpnpStateVariable *dst, UpnpStateVariable *src)
 {
-    RETURN_IF_FAIL(dst);
-    RETURN_IF_FAIL(src);
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(dst, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(src, TINY_RET_E_ARG_NULL);
 
     if (dst != src)
     {
         UpnpStateVariable_Dispose(dst);
 
-        UpnpStateVariableDefinition_Copy(&dst->definition, &src->definition);
-        DataValue_Copy(&dst->value, &src->value);
+        ret = UpnpStateVariableDefinition_Copy(&dst->definition, &src->definition);
+        if (RET_SUCCEEDED(ret))
+        {
+            DataValue_Copy(&dst->value, &src->value);
+        }
     }
+
+    return ret;
 }
 
 TinyRet UpnpStateVariable_Initialize(UpnpStateVariable *thiz, const char *name, const char *dataType, const char *defaultValue, const char *sendEvents)
@@ -100,7 +110,11 @@ TinyRet UpnpStateVariable_Initialize(UpnpStateVariable *thiz, const char *name,
                 DataValue_SetValue(&value, defaultValue);
             }
 
-            UpnpStateVariableDefinition_Initialize(&thiz->definition, name, &type);
+            ret = UpnpStateVariableDefinition_Initialize(&thiz->definition, name, &type);
+            if (RET_FAILED(ret))
+            {
+                break;
+            }
 
             thiz->sendEvents = DataType_StringToBoolean(sendEvents);
 
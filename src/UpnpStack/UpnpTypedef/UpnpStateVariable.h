@@ -24,10 +24,16 @@ TINY_BEGIN_DECLS
 typedef struct _UpnpStateVariable
 {
     void *service;
+    uint32_t index;
     bool sendEvents;
-    bool isChanged;
     UpnpStateVariableDefinition definition;
     DataValue value;
+
+    /**
+     * when and with which value it was last evented, for moderation
+     */
+    uint64_t eventedAt;
+    double eventedValue;
 } UpnpStateVariable;
 
 UPNP_API UpnpStateVariable * UpnpStateVariable_New();
@@ -36,7 +42,7 @@ UPNP_API void UpnpStateVariable_Delete(UpnpStateVariable *thiz);
 UPNP_API TinyRet UpnpStateVariable_Construct(UpnpStateVariable *thiz);
 UPNP_API void UpnpStateVariable_Dispose(UpnpStateVariable *thiz);
 
-UPNP_API void UpnpStateVariable_Copy(UpnpStateVariable *dst, UpnpStateVariable *src);
+UPNP_API TinyRet UpnpStateVariable_Copy(UpnpStateVariable *dst, UpnpStateVariable *src);
 UPNP_API TinyRet UpnpStateVariable_Initialize(UpnpStateVariable *thiz, const char *name, const char *dataType, const char *defaultValue, const char *sendEvents);
 
 
@@ -11,9 +11,34 @@
 */
 
 #include "UpnpStateVariableDefinition.h"
+#include "tiny_memory.h"
 
 #define TAG     "UpnpStateVariableDefinition"
 
+static TinyRet UpnpStateVariableDefinition_SetName(UpnpStateVariableDefinition *thiz, const char *name)
+{
+    char *owned = NULL;
+    size_t length = strlen(name);
+
+    owned = (char *)tiny_malloc(length + 1);
+    if (owned == NULL)
+    {
+        return TINY_RET_E_OUT_OF_MEMORY;
+    }
+
+    memcpy(owned, name, length + 1);
+
+    if (thiz->ownedName != NULL)
+    {
+        tiny_free(thiz->ownedName);
+    }
+
+    thiz->ownedName = owned;
+    thiz->name = owned;
+
+    return TINY_RET_OK;
+}
+
 void UpnpStateVariableDefinition_Construct(UpnpStateVariableDefinition *thiz)
 {
     RETURN_IF_FAIL(thiz);
@@ -25,28 +50,69 @@ void UpnpStateVariableDefinition_Dispose(UpnpStateVariableDefinition *thiz)
 {
     RETURN_IF_FAIL(thiz);
 
+    if (thiz->ownedName != NULL)
+    {
+        tiny_free(thiz->ownedName);
+    }
+
     memset(thiz, 0, sizeof(UpnpStateVariableDefinition));
 }
 
-void UpnpStateVariableDefinition_Copy(UpnpStateVariableDefinition *dst, UpnpStateVariableDefinition *src)
+TinyRet UpnpStateVariableDefinition_Copy(UpnpStateVariableDefinition *dst, UpnpStateVariableDefinition *src)
 {
-    RETURN_IF_FAIL(dst);
-    RETURN_IF_FAIL(src);
+    TinyRet ret = TINY_RET_OK;
+
+    RETURN_VAL_IF_FAIL(dst, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(src, TINY_RET_E_ARG_NULL);
 
     if (dst != src)
     {
         UpnpStateVariableDefinition_Dispose(dst);
 
         DataType_Copy(&dst->dataType, &src->dataType);
-        strncpy(dst->name, src->name, STATE_VARIABLE_NAME_LEN);
+        if (src->name != NULL)
+        {
+            ret = UpnpStateVariableDefinition_SetName(dst, src->name);
+        }
+
+        dst->maximumRate = src->maximumRate;
+        dst->minimumDelta = src->minimumDelta;
     }
+
+    return ret;
 }
 
-void UpnpStateVariableDefinition_Initialize(UpnpStateVariableDefinition *thiz, const char *name, DataType *type)
+TinyRet UpnpStateVariableDefinition_Initialize(UpnpStateVariableDefinition *thiz, const char *name, DataType *type)
 {
-    RETURN_IF_FAIL(thiz);
-    RETURN_IF_FAIL(name);
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(name, TINY_RET_E_ARG_NULL);
 
     DataType_Copy(&thiz->dataType, type);
-    strncpy(thiz->name, name, STATE_VARIABLE_NAME_LEN);
+
+    return UpnpStateVariableDefinition_SetName(thiz, name);
+}
+
+TinyRet UpnpStateVariableDefinition_Intern(UpnpStateVariableDefinition *thiz, UpnpNamePool *pool)
+{
+    const char *name = NULL;
+
+    RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(thiz->name, TINY_RET_E_ARG_NULL);
+    RETURN_VAL_IF_FAIL(pool, TINY_RET_E_ARG_NULL);
+
+    name = UpnpNamePool_Intern(pool, thiz->name);
+    if (name == NULL)
+    {
+        return TINY_RET_E_OUT_OF_MEMORY;
+    }
+
+    thiz->name = name;
+
+    if (thiz->ownedName != NULL)
+    {
+        tiny_free(thiz->ownedName);
+        thiz->ownedName = NULL;
+    }
+
+    return TINY_RET_OK;
 }
\ No newline at end of file
@@ -16,17 +16,29 @@
 #include "tiny_base.h"
 #include "upnp_api.h"
 #include "DataType.h"
+#include "UpnpNamePool.h"
 
 TINY_BEGIN_DECLS
 
 
-#define STATE_VARIABLE_NAME_LEN     128
-
+/**
+ * name points at ownedName until the variable joins a service, then into
+ * the service's name pool, so variables of one service compare names by
+ * pointer.
+ */
 typedef struct _UpnpStateVariableDefinition
 {
-    char name[STATE_VARIABLE_NAME_LEN];
+    const char * name;
+    char * ownedName;
     DataType dataType;
 
+    /**
+     * event moderation: at most one event per maximumRate msec, and
+     * numeric values only once they moved by minimumDelta. 0: unmoderated.
+     */
+    uint32_t maximumRate;
+    double minimumDelta;
+
 #if 0
     AllowedValueList allowedValueList;
     AllowedValueRange allowedValueRange;
@@ -35,8 +47,9 @@ typedef struct _UpnpStateVariableDefinition
 
 UPNP_API void UpnpStateVariableDefinition_Construct(UpnpStateVariableDefinition *thiz);
 UPNP_API void UpnpStateVariableDefinition_Dispose(UpnpStateVariableDefinition *thiz);
-UPNP_API void UpnpStateVariableDefinition_Copy(UpnpStateVariableDefinition *dst, UpnpStateVariableDefinition *src);
-UPNP_API void UpnpStateVariableDefinition_Initialize(UpnpStateVariableDefinition *thiz, const char *name, DataType *type);
+UPNP_API TinyRet UpnpStateVariableDefinition_Copy(UpnpStateVariableDefinition *dst, UpnpStateVariableDefinition *src);
+UPNP_API TinyRet UpnpStateVariableDefinition_Initialize(UpnpStateVariableDefinition *thiz, const char *name, DataType *type);
+TinyRet UpnpStateVariableDefinition_Intern(UpnpStateVariableDefinition *thiz, UpnpNamePool *pool);
 
 
 TINY_END_DECLS
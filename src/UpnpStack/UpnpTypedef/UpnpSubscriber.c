@@ -17,6 +17,8 @@
 struct _UpnpSubscriber
 {
     uint32_t timeout;
+    uint64_t expireAt;
+    void *queue;
     char sid[UPNP_UUID_LEN];
     char callback[TINY_URL_LEN];
 } ;
@@ -124,4 +126,32 @@ const char * UpnpSubscriber_GetSid(UpnpSubscriber *thiz)
     RETURN_VAL_IF_FAIL(thiz, NULL);
 
     return thiz->sid;
-}
\ No newline at end of file
+}
+
+void UpnpSubscriber_SetQueue(UpnpSubscriber *thiz, void *queue)
+{
+    RETURN_IF_FAIL(thiz);
+
+    thiz->queue = queue;
+}
+
+void * UpnpSubscriber_GetQueue(UpnpSubscriber *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, NULL);
+
+    return thiz->queue;
+}
+
+void UpnpSubscriber_SetExpireAt(UpnpSubscriber *thiz, uint64_t expireAt)
+{
+    RETURN_IF_FAIL(thiz);
+
+    thiz->expireAt = expireAt;
+}
+
+uint64_t UpnpSubscriber_GetExpireAt(UpnpSubscriber *thiz)
+{
+    RETURN_VAL_IF_FAIL(thiz, 0);
+
+    return thiz->expireAt;
+}
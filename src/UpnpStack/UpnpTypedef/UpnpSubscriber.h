@@ -37,6 +37,18 @@ UPNP_API uint32_t UpnpSubscriber_GetTimeout(UpnpSubscriber *thiz);
 UPNP_API TinyRet UpnpSubscriber_SetSid(UpnpSubscriber *thiz, const char *sid);
 UPNP_API const char * UpnpSubscriber_GetSid(UpnpSubscriber *thiz);
 
+/**
+ * Delivery queue of this subscriber, owned by the GENA server
+ */
+UPNP_API void UpnpSubscriber_SetQueue(UpnpSubscriber *thiz, void *queue);
+UPNP_API void * UpnpSubscriber_GetQueue(UpnpSubscriber *thiz);
+
+/**
+ * Absolute end of the lease, in usec (tiny_getusec)
+ */
+UPNP_API void UpnpSubscriber_SetExpireAt(UpnpSubscriber *thiz, uint64_t expireAt);
+UPNP_API uint64_t UpnpSubscriber_GetExpireAt(UpnpSubscriber *thiz);
+
 
 TINY_END_DECLS
 
@@ -0,0 +1,399 @@
+#include <stdio.h>
+#include <string.h>
+#include "tiny_memory.h"
+#include "tiny_time.h"
+#include "UpnpEvent.h"
+#include "DataValue.h"
+#include "UpnpService.h"
+
+#define EVENT_BENCH_LEN     (1024 * 64)
+#define VALUE_BENCH_ROUNDS  1000000
+#define VALUE_RANDOM_COUNT  1000000
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do { \
+        if (!(x)) { \
+            printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while (0)
+
+static UpnpEvent * new_event(uint32_t properties)
+{
+    UpnpEvent *event = UpnpEvent_New();
+    uint32_t i = 0;
+
+    for (i = 0; i < properties && event != NULL; ++i)
+    {
+        char name[32];
+        char value[64];
+
+        tiny_snprintf(name, 32, "Variable%u", i);
+        tiny_snprintf(value, 64, "value <%u> & more", i);
+        UpnpEvent_SetArgumentValue(event, name, value);
+    }
+
+    return event;
+}
+
+static void test_event(void)
+{
+    UpnpEvent *event = new_event(2);
+    char bytes[512];
+    uint32_t length = 0;
+
+    CHECK(event != NULL);
+
+    length = UpnpEvent_ToString(event, bytes, sizeof(bytes));
+    CHECK(length == strlen(bytes));
+    CHECK(strstr(bytes, "<e:propertyset xmlns:e=\"urn:schemas-upnp-org:event-1-0\">") != NULL);
+    CHECK(strstr(bytes, "<Variable0>value &lt;0&gt; &amp; more</Variable0>") != NULL);
+    CHECK(strstr(bytes, "<Variable1>value &lt;1&gt; &amp; more</Variable1>") != NULL);
+
+    /**
+     * refused whole, never cut
+     */
+    CHECK(UpnpEvent_ToString(event, bytes, length) == 0);
+    CHECK(UpnpEvent_ToString(event, bytes, length + 1) == length);
+
+    UpnpEvent_Delete(event);
+}
+
+static void test_state_variable_lookup(void)
+{
+    UpnpService *service = UpnpService_New();
+    const char *names[] = { "Status", "Target", "Level" };
+    uint32_t i = 0;
+
+    CHECK(service != NULL);
+
+    for (i = 0; i < 3; ++i)
+    {
+        UpnpStateVariable *state = UpnpStateVariable_New();
+        CHECK(state != NULL);
+        CHECK(RET_SUCCEEDED(UpnpStateVariable_Initialize(state, names[i], "boolean", NULL, "yes")));
+        CHECK(RET_SUCCEEDED(UpnpService_AddStateVariable(service, state)));
+    }
+
+    for (i = 0; i < 3; ++i)
+    {
+        CHECK(UpnpService_GetStateVariable(service, names[i]) == UpnpService_GetStateVariableAt(service, i));
+    }
+
+    CHECK(UpnpService_GetStateVariable(service, "Missing") == NULL);
+
+    UpnpService_Delete(service);
+}
+
+static void bench_event(void)
+{
+    static const uint32_t sizes[] = { 1, 10, 50, 100, 500 };
+    char *bytes = (char *)tiny_malloc(EVENT_BENCH_LEN);
+    uint32_t i = 0;
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        UpnpEvent *event = new_event(sizes[i]);
+        uint32_t rounds = 100000 / sizes[i];
+        uint32_t length = 0;
+        uint32_t j = 0;
+        uint64_t begin = tiny_getusec();
+
+        for (j = 0; j < rounds; ++j)
+        {
+            length = UpnpEvent_ToString(event, bytes, EVENT_BENCH_LEN);
+        }
+
+        CHECK(length > 0);
+        printf("UpnpEvent_ToString %4u properties: %6u bytes, %8.2f us\n",
+            sizes[i], length, (double)(tiny_getusec() - begin) / rounds);
+
+        UpnpEvent_Delete(event);
+    }
+
+    tiny_free(bytes);
+}
+
+static uint64_t random_state = 88172645463325252ULL;
+
+static uint64_t next_random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    return random_state;
+}
+
+/**
+ * a double of any sign and any magnitude DataValue_FormatDouble formats
+ * itself, with all 53 bits of mantissa in use
+ */
+static double next_double(void)
+{
+    double value = (double)(next_random() >> 11) / 9007199254740992.0;
+    uint32_t scale = (uint32_t)(next_random() % 16);
+
+    while (scale-- > 0)
+    {
+        value *= 10;
+    }
+
+    return (next_random() & 1) ? -value : value;
+}
+
+static bool same_format(double value)
+{
+    char expected[DATA_VALUE_FORMAT_LEN];
+    char bytes[DATA_VALUE_FORMAT_LEN];
+
+    tiny_snprintf(expected, DATA_VALUE_FORMAT_LEN, "%f", value);
+    DataValue_FormatDouble(value, bytes);
+
+    if (strcmp(expected, bytes) != 0)
+    {
+        printf("DataValue_FormatDouble(%.17g): %s, printf: %s\n", value, bytes, expected);
+        return false;
+    }
+
+    return true;
+}
+
+static void test_format_double(void)
+{
+    static const double values[] = {
+        0, 1, -1, 0.5, 0.0000005, 0.0000015, 0.0078125, -0.0078125, 0.1015625,
+        1.0000005, 2.5000005, 123.4567895, 0.9999995, 0.99999949999999999,
+        99999999999999.9, 999999999999999.0, 4503599627370495.5, 1e300, -1e-300
+    };
+    uint32_t mismatches = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+    {
+        CHECK(same_format(values[i]));
+    }
+
+    for (i = 0; i < VALUE_RANDOM_COUNT; ++i)
+    {
+        if (!same_format(next_double()) && ++mismatches > 10)
+        {
+            break;
+        }
+    }
+
+    CHECK(mismatches == 0);
+}
+
+/**
+ * a copy owns its own string, the source keeps the one it had
+ */
+static void test_copy(void)
+{
+    DataValue src;
+    DataValue dst;
+    const char *string = NULL;
+
+    DataValue_Construct(&src);
+    DataValue_Construct(&dst);
+
+    DataValue_SetString(&src, "value");
+    string = src.internalValue.stringValue;
+
+    DataValue_Copy(&dst, &src);
+    CHECK(src.internalValue.stringValue == string);
+    CHECK(dst.internalValue.stringValue != string);
+    CHECK(strcmp(dst.internalValue.stringValue, "value") == 0);
+
+    DataValue_Dispose(&dst);
+    DataValue_Dispose(&src);
+}
+
+/**
+ * Formatted, then parsed into a value of the same type, a value reads the
+ * same; doubles keep their six decimals.
+ */
+static bool round_trip(DataValue *value)
+{
+    char bytes[DATA_VALUE_FORMAT_LEN];
+    char again[DATA_VALUE_FORMAT_LEN];
+    DataValue parsed;
+    bool same = false;
+
+    DataValue_Construct(&parsed);
+    parsed.internalType = value->internalType;
+
+    DataValue_GetValue(value, bytes, DATA_VALUE_FORMAT_LEN);
+    DataValue_SetValue(&parsed, bytes);
+    DataValue_GetValue(&parsed, again, DATA_VALUE_FORMAT_LEN);
+
+    switch (value->internalType)
+    {
+    case INTERNAL_FLOAT:
+        same = ((double)parsed.internalValue.floatValue - (double)value->internalValue.floatValue < 0.000001)
+            && ((double)value->internalValue.floatValue - (double)parsed.internalValue.floatValue < 0.000001);
+        break;
+
+    case INTERNAL_DOUBLE:
+        same = (strcmp(bytes, again) == 0);
+        break;
+
+    default:
+        same = (strcmp(bytes, again) == 0) && (memcmp(&parsed.internalValue, &value->internalValue, sizeof(InternalValue)) == 0);
+        break;
+    }
+
+    if (!same)
+    {
+        printf("round trip failed: %s -> %s\n", bytes, again);
+    }
+
+    DataValue_Dispose(&parsed);
+
+    return same;
+}
+
+static void set_random(DataValue *value, InternalType type)
+{
+    uint64_t r = next_random();
+
+    memset(&value->internalValue, 0, sizeof(InternalValue));
+
+    switch (type)
+    {
+    case INTERNAL_BYTE:
+        DataValue_SetByte(value, (int8_t)r);
+        break;
+
+    case INTERNAL_WORD:
+        DataValue_SetWord(value, (int16_t)r);
+        break;
+
+    case INTERNAL_INTEGER:
+        DataValue_SetInteger(value, (int32_t)r);
+        break;
+
+    case INTERNAL_LONG:
+        DataValue_SetLong(value, (int64_t)r);
+        break;
+
+    case INTERNAL_FLOAT:
+        DataValue_SetFloat(value, (float)((double)(int32_t)r / 65536.0));
+        break;
+
+    case INTERNAL_DOUBLE:
+        DataValue_SetDouble(value, next_double());
+        break;
+
+    case INTERNAL_BOOLEAN:
+        DataValue_SetBool(value, (r & 1) != 0);
+        break;
+
+    case INTERNAL_CHAR:
+        DataValue_SetChar(value, (char)('!' + r % 94));
+        break;
+
+    default:
+        break;
+    }
+}
+
+typedef struct _ValueType
+{
+    InternalType type;
+    const char *name;
+} ValueType;
+
+static const ValueType value_types[] = {
+    { INTERNAL_BYTE, "i1" },
+    { INTERNAL_WORD, "i2" },
+    { INTERNAL_INTEGER, "i4" },
+    { INTERNAL_LONG, "i8" },
+    { INTERNAL_FLOAT, "r4" },
+    { INTERNAL_DOUBLE, "r8" },
+    { INTERNAL_BOOLEAN, "boolean" },
+    { INTERNAL_CHAR, "char" },
+};
+
+#define VALUE_TYPE_COUNT    (sizeof(value_types) / sizeof(value_types[0]))
+
+static void test_round_trip(void)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < VALUE_TYPE_COUNT; ++i)
+    {
+        uint32_t failed = 0;
+        uint32_t j = 0;
+
+        for (j = 0; j < 100000 && failed < 10; ++j)
+        {
+            DataValue value;
+
+            DataValue_Construct(&value);
+            set_random(&value, value_types[i].type);
+            if (!round_trip(&value))
+            {
+                failed++;
+            }
+            DataValue_Dispose(&value);
+        }
+
+        CHECK(failed == 0);
+    }
+}
+
+static void bench_data_value(void)
+{
+    char bytes[DATA_VALUE_FORMAT_LEN];
+    uint32_t i = 0;
+
+    for (i = 0; i < VALUE_TYPE_COUNT; ++i)
+    {
+        DataValue value;
+        uint64_t formatUsec = 0;
+        uint64_t parseUsec = 0;
+        uint64_t begin = 0;
+        uint32_t j = 0;
+
+        DataValue_Construct(&value);
+        set_random(&value, value_types[i].type);
+
+        begin = tiny_getusec();
+        for (j = 0; j < VALUE_BENCH_ROUNDS; ++j)
+        {
+            DataValue_Format(&value, bytes);
+        }
+        formatUsec = tiny_getusec() - begin;
+
+        begin = tiny_getusec();
+        for (j = 0; j < VALUE_BENCH_ROUNDS; ++j)
+        {
+            DataValue_SetValue(&value, bytes);
+        }
+        parseUsec = tiny_getusec() - begin;
+
+        printf("DataValue %-8s %-24s format %6.1f ns, parse %6.1f ns\n",
+            value_types[i].name, bytes,
+            (double)formatUsec * 1000 / VALUE_BENCH_ROUNDS,
+            (double)parseUsec * 1000 / VALUE_BENCH_ROUNDS);
+
+        DataValue_Dispose(&value);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    test_event();
+    test_format_double();
+    test_round_trip();
+    test_copy();
+    test_state_variable_lookup();
+    bench_event();
+    bench_data_value();
+
+    printf("%s\n", (failures == 0) ? "OK" : "FAILED");
+
+    return (failures == 0) ? 0 : 1;
+}
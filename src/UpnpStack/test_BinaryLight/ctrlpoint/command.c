@@ -15,7 +15,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include "UpnpDevice.h"
-#include "UpnpDeviceFactory.h"
 #include "BinaryLight.h"
 #include "SwitchPower.h"
 #include "UpnpCode.h"
@@ -89,7 +88,7 @@ static void device_listener(UpnpDeviceSummary *deviceSummary, bool alive, void *
             device = NULL;
         }
 
-        device = UpnpDeviceFactory_Create(deviceSummary);
+        device = UpnpRuntime_CreateDevice(gRuntime, deviceSummary);
         if (device != NULL)
         {
             // print_device(device);
@@ -132,7 +131,7 @@ static void cmd_stop(void)
 
 static void cmd_discover(void)
 {
-    LOG("UpnpRuntime_StartScan", UpnpRuntime_StartScan(gRuntime, device_listener, device_filter, NULL));
+    LOG("UpnpRuntime_StartScan", UpnpRuntime_StartScan(gRuntime, NULL, 0, 0, device_listener, device_filter, NULL));
 }
 
 static void cmd_stopDiscovery(void)
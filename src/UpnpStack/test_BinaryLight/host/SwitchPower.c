@@ -423,6 +423,20 @@ UpnpCode SwitchPower_OnAction(SwitchPower *thiz, UpnpAction *action)
     return UPNP_ERR_ACTION_FAILED;
 }
 
+void SwitchPower_Lock(SwitchPower *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    UpnpService_Lock(thiz->service);
+}
+
+void SwitchPower_Unlock(SwitchPower *thiz)
+{
+    RETURN_IF_FAIL(thiz);
+
+    UpnpService_Unlock(thiz->service);
+}
+
 TinyRet SwitchPower_SendEvents(SwitchPower *thiz)
 {
     RETURN_VAL_IF_FAIL(thiz, TINY_RET_E_ARG_NULL);
@@ -449,7 +463,7 @@ TinyRet SwitchPower_SetStatus(SwitchPower *thiz, bool theStatus)
         if (_Status->value.internalValue.boolValue != theStatus)
         {
             _Status->value.internalValue.boolValue = theStatus;
-            _Status->isChanged = true;
+            UpnpService_SetChanged(thiz->service, _Status);
         }
     } while (0);
 
@@ -475,7 +489,7 @@ TinyRet SwitchPower_SetTarget(SwitchPower *thiz, bool theTarget)
         if (_Target->value.internalValue.boolValue != theTarget)
         {
             _Target->value.internalValue.boolValue = theTarget;
-            _Target->isChanged = true;
+            UpnpService_SetChanged(thiz->service, _Target);
         }
     } while (0);
 
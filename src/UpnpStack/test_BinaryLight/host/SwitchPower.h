@@ -68,7 +68,12 @@ UpnpCode SwitchPower_OnAction(SwitchPower *thiz, UpnpAction *action);
 
 /**
  * SendEvents
+ *
+ * Set* and SendEvents work on the service's state variables: outside an
+ * action handler, which already holds it, call them between Lock and Unlock.
  */
+void SwitchPower_Lock(SwitchPower *thiz);
+void SwitchPower_Unlock(SwitchPower *thiz);
 TinyRet SwitchPower_SendEvents(SwitchPower *thiz);
 TinyRet SwitchPower_SetStatus(SwitchPower *thiz, bool theStatus);
 TinyRet SwitchPower_SetTarget(SwitchPower *thiz, bool theTarget);
@@ -75,19 +75,33 @@ static void cmd_Stop(void)
 
 static void cmd_SetTarget(void)
 {
+    SwitchPower *switchPower = BinaryLight_GetSwitchPower(gBinaryLight);
+
     gTaget = !gTaget;
-    LOG("SwitchPower_SetTarget", SwitchPower_SetTarget(BinaryLight_GetSwitchPower(gBinaryLight), gTaget));
+
+    SwitchPower_Lock(switchPower);
+    LOG("SwitchPower_SetTarget", SwitchPower_SetTarget(switchPower, gTaget));
+    SwitchPower_Unlock(switchPower);
 }
 
 static void cmd_SetStatus(void)
 {
+    SwitchPower *switchPower = BinaryLight_GetSwitchPower(gBinaryLight);
+
     gStatus = !gStatus;
-    LOG("SwitchPower_SetStatus", SwitchPower_SetStatus(BinaryLight_GetSwitchPower(gBinaryLight), gStatus));
+
+    SwitchPower_Lock(switchPower);
+    LOG("SwitchPower_SetStatus", SwitchPower_SetStatus(switchPower, gStatus));
+    SwitchPower_Unlock(switchPower);
 }
 
 static void cmd_SendEvents(void)
 {
-    LOG("SwitchPower_SendEvents", SwitchPower_SendEvents(BinaryLight_GetSwitchPower(gBinaryLight)));
+    SwitchPower *switchPower = BinaryLight_GetSwitchPower(gBinaryLight);
+
+    SwitchPower_Lock(switchPower);
+    LOG("SwitchPower_SendEvents", SwitchPower_SendEvents(switchPower));
+    SwitchPower_Unlock(switchPower);
 }
 
 static void cmd_exit(void)
@@ -15,7 +15,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include "UpnpDevice.h"
-#include "UpnpDeviceFactory.h"
 
 #define LOG(func, ret)  printf("%s: %s\n", func, tiny_ret_to_str(ret))
 
@@ -215,7 +214,7 @@ static void device_listener(UpnpDeviceSummary *deviceSummary, bool alive, void *
 
     if (alive)
     {
-        UpnpDevice *device = UpnpDeviceFactory_Create(deviceSummary);
+        UpnpDevice *device = UpnpRuntime_CreateDevice(gRuntime, deviceSummary);
         if (device != NULL)
         {
             print_device(device);
@@ -236,8 +235,8 @@ static void cmd_stop(void)
 
 static void cmd_discover(void)
 {
-    LOG("UpnpRuntime_StartScan", UpnpRuntime_StartScan(gRuntime, device_listener, device_filter, NULL));
-    UpnpRuntime_StartScan(gRuntime, device_listener, device_filter, NULL);
+    LOG("UpnpRuntime_StartScan", UpnpRuntime_StartScan(gRuntime, NULL, 0, 0, device_listener, device_filter, NULL));
+    UpnpRuntime_StartScan(gRuntime, NULL, 0, 0, device_listener, device_filter, NULL);
 }
 
 static void cmd_stopDiscovery(void)